@@ -0,0 +1,153 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "backends/graphics/headless/headless-graphics.h"
+#include "common/rect.h"
+#include "common/textconsole.h"
+#include "graphics/pixelbuffer.h"
+
+static const OSystem::GraphicsMode s_supportedGraphicsModes[] = {
+	{"1x", "Normal", 0},
+	{0, 0, 0}
+};
+
+HeadlessGraphicsManager::HeadlessGraphicsManager()
+	:
+	_overlayVisible(false),
+	_mouseVisible(false),
+	_screenChangeCount(0) {
+	memset(_palette, 0, sizeof(_palette));
+}
+
+HeadlessGraphicsManager::~HeadlessGraphicsManager() {
+	_screen.free();
+	_overlay.free();
+}
+
+const OSystem::GraphicsMode *HeadlessGraphicsManager::getSupportedGraphicsModes() const {
+	return s_supportedGraphicsModes;
+}
+
+#ifdef USE_RGB_COLOR
+Common::List<Graphics::PixelFormat> HeadlessGraphicsManager::getSupportedFormats() const {
+	Common::List<Graphics::PixelFormat> list;
+	list.push_back(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+	list.push_back(Graphics::PixelFormat::createFormatCLUT8());
+	return list;
+}
+#endif
+
+void HeadlessGraphicsManager::allocate(uint width, uint height, const Graphics::PixelFormat &format) {
+	_screen.free();
+	_screen.create(width, height, format);
+
+	// The overlay always has the size of the screen, as in the SDL backend
+	_overlay.free();
+	_overlay.create(width, height, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+
+	_screenChangeCount++;
+}
+
+void HeadlessGraphicsManager::initSize(uint width, uint height, const Graphics::PixelFormat *format) {
+	allocate(width, height, format ? *format : Graphics::PixelFormat::createFormatCLUT8());
+}
+
+void HeadlessGraphicsManager::launcherInitSize(uint w, uint h) {
+	setupScreen(w, h, false, false);
+}
+
+Graphics::PixelBuffer HeadlessGraphicsManager::setupScreen(int screenW, int screenH, bool fullscreen, bool accel3d) {
+	if (accel3d)
+		error("The headless backend has no OpenGL support, use the software renderer");
+
+	allocate(screenW, screenH, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+	return Graphics::PixelBuffer(_screen.format, (byte *)_screen.pixels);
+}
+
+void HeadlessGraphicsManager::setPalette(const byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(_palette + 3 * start, colors, 3 * num);
+}
+
+void HeadlessGraphicsManager::grabPalette(byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(colors, _palette + 3 * start, 3 * num);
+}
+
+static void copyRect(Graphics::Surface &dst, const void *buf, int pitch, int x, int y, int w, int h) {
+	const byte *src = (const byte *)buf;
+
+	// Clip the rectangle to the surface, like the SDL backend does
+	if (x < 0) {
+		w += x;
+		src -= x * dst.format.bytesPerPixel;
+		x = 0;
+	}
+	if (y < 0) {
+		h += y;
+		src -= y * pitch;
+		y = 0;
+	}
+	if (w > dst.w - x)
+		w = dst.w - x;
+	if (h > dst.h - y)
+		h = dst.h - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	const int lineSize = w * dst.format.bytesPerPixel;
+	for (int i = 0; i < h; i++) {
+		memcpy(dst.getBasePtr(x, y + i), src, lineSize);
+		src += pitch;
+	}
+}
+
+void HeadlessGraphicsManager::copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {
+	copyRect(_screen, buf, pitch, x, y, w, h);
+}
+
+void HeadlessGraphicsManager::fillScreen(uint32 col) {
+	_screen.fillRect(Common::Rect(_screen.w, _screen.h), col);
+}
+
+void HeadlessGraphicsManager::clearOverlay() {
+	memset(_overlay.pixels, 0, _overlay.h * _overlay.pitch);
+}
+
+void HeadlessGraphicsManager::grabOverlay(void *buf, int pitch) {
+	byte *dst = (byte *)buf;
+	const int lineSize = _overlay.w * _overlay.format.bytesPerPixel;
+	for (int i = 0; i < _overlay.h; i++) {
+		memcpy(dst, _overlay.getBasePtr(0, i), lineSize);
+		dst += pitch;
+	}
+}
+
+void HeadlessGraphicsManager::copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {
+	copyRect(_overlay, buf, pitch, x, y, w, h);
+}
+
+bool HeadlessGraphicsManager::showMouse(bool visible) {
+	bool last = _mouseVisible;
+	_mouseVisible = visible;
+	return last;
+}
@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_HEADLESS_H
+#define BACKENDS_GRAPHICS_HEADLESS_H
+
+#include "backends/graphics/graphics.h"
+#include "graphics/surface.h"
+
+/**
+ * Headless graphics manager. The screen and the overlay are surfaces in
+ * memory which are never displayed; the owner of the manager may inspect
+ * the screen after each update. Only the software renderers are supported.
+ */
+class HeadlessGraphicsManager : public GraphicsManager {
+public:
+	HeadlessGraphicsManager();
+	virtual ~HeadlessGraphicsManager();
+
+	virtual bool hasFeature(OSystem::Feature f) { return false; }
+	virtual void setFeatureState(OSystem::Feature f, bool enable) {}
+	virtual bool getFeatureState(OSystem::Feature f) { return false; }
+
+	virtual const OSystem::GraphicsMode *getSupportedGraphicsModes() const;
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return true; }
+	virtual void resetGraphicsScale() {}
+	virtual int getGraphicsMode() const { return 0; }
+#ifdef USE_RGB_COLOR
+	virtual Graphics::PixelFormat getScreenFormat() const { return _screen.format; }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const;
+#endif
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL);
+	virtual int getScreenChangeID() const { return _screenChangeCount; }
+
+	virtual void beginGFXTransaction() {}
+	virtual OSystem::TransactionError endGFXTransaction() { return OSystem::kTransactionSuccess; }
+
+	virtual void launcherInitSize(uint w, uint h);
+	virtual Graphics::PixelBuffer setupScreen(int screenW, int screenH, bool fullscreen, bool accel3d);
+
+	virtual int16 getHeight() { return _screen.h; }
+	virtual int16 getWidth() { return _screen.w; }
+	virtual void setPalette(const byte *colors, uint start, uint num);
+	virtual void grabPalette(byte *colors, uint start, uint num);
+	virtual void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h);
+	virtual Graphics::Surface *lockScreen() { return &_screen; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col);
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void setFocusRectangle(const Common::Rect& rect) {}
+	virtual void clearFocusRectangle() {}
+
+	virtual void showOverlay() { _overlayVisible = true; }
+	virtual void hideOverlay() { _overlayVisible = false; }
+	virtual Graphics::PixelFormat getOverlayFormat() const { return _overlay.format; }
+	virtual void clearOverlay();
+	virtual void grabOverlay(void *buf, int pitch);
+	virtual void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h);
+	virtual int16 getOverlayHeight() { return _overlay.h; }
+	virtual int16 getOverlayWidth() { return _overlay.w; }
+
+	virtual bool showMouse(bool visible);
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale = false, const Graphics::PixelFormat *format = NULL) {}
+	virtual void setCursorPalette(const byte *colors, uint start, uint num) {}
+
+	virtual bool lockMouse(bool lock) { return false; }
+
+	/** The surface which would be displayed: the overlay if shown, otherwise the screen */
+	const Graphics::Surface &getDisplayedSurface() const { return _overlayVisible ? _overlay : _screen; }
+
+protected:
+	Graphics::Surface _screen;
+	Graphics::Surface _overlay;
+	bool _overlayVisible;
+	bool _mouseVisible;
+	int _screenChangeCount;
+	byte _palette[3 * 256];
+
+	void allocate(uint width, uint height, const Graphics::PixelFormat &format);
+};
+
+#endif
@@ -0,0 +1,61 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "backends/mixer/null/null-mixer.h"
+#include "common/system.h"
+
+NullMixerManager::NullMixerManager(uint32 rate, uint32 samples)
+	:
+	_mixer(0),
+	_rate(rate),
+	_samples(samples),
+	_samplesMixed(0),
+	_buffer(0) {
+
+}
+
+NullMixerManager::~NullMixerManager() {
+	delete _mixer;
+	delete[] _buffer;
+}
+
+void NullMixerManager::init() {
+	// Stereo, 16 bits per sample
+	_buffer = new byte[_samples * 4];
+
+	_mixer = new Audio::MixerImpl(g_system, _rate);
+	assert(_mixer);
+	_mixer->setReady(true);
+}
+
+void NullMixerManager::update(uint32 millis) {
+	if (!_mixer)
+		return;
+
+	// Split the product, so that it does not overflow
+	uint32 due = (millis / 1000) * _rate + (millis % 1000) * _rate / 1000;
+
+	while (due - _samplesMixed >= _samples) {
+		_mixer->mixCallback(_buffer, _samples * 4);
+		_samplesMixed += _samples;
+	}
+}
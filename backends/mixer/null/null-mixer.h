@@ -0,0 +1,69 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_MIXER_NULL_H
+#define BACKENDS_MIXER_NULL_H
+
+#include "audio/mixer_intern.h"
+
+/**
+ * Null mixer manager. There is no audio device: the backend asks it to
+ * mix the samples an output at the given rate would have consumed, so that
+ * the audio costs as much time as it would with a real device, but at
+ * deterministic points of the main loop.
+ */
+class NullMixerManager {
+public:
+	NullMixerManager(uint32 rate, uint32 samples);
+	virtual ~NullMixerManager();
+
+	/**
+	 * Initialize and setups the mixer
+	 */
+	virtual void init();
+
+	/**
+	 * Get the audio mixer implementation
+	 */
+	Audio::Mixer *getMixer() { return (Audio::Mixer *)_mixer; }
+
+	/**
+	 * Mix all the samples due up to the given time, in whole buffers.
+	 *
+	 * @param millis	the time since the output was started
+	 */
+	void update(uint32 millis);
+
+	/** The number of sample frames mixed so far */
+	uint32 getSamplesMixed() const { return _samplesMixed; }
+
+protected:
+	/** The mixer implementation */
+	Audio::MixerImpl *_mixer;
+
+	uint32 _rate;
+	uint32 _samples; ///< Size of a buffer, in sample frames
+	uint32 _samplesMixed;
+	byte *_buffer;
+};
+
+#endif
@@ -136,6 +136,13 @@ MODULE_OBJS += \
 	graphics/gph/gph-graphics.o
 endif
 
+ifeq ($(BACKEND),headless)
+MODULE_OBJS += \
+	graphics/headless/headless-graphics.o \
+	mixer/null/null-mixer.o \
+	mutex/null/null-mutex.o
+endif
+
 ifeq ($(BACKEND),linuxmoto)
 MODULE_OBJS += \
 	events/linuxmotosdl/linuxmotosdl-events.o \
@@ -0,0 +1,47 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "backends/mutex/null/null-mutex.h"
+
+struct NullMutex {
+	int lockCount;
+};
+
+OSystem::MutexRef NullMutexManager::createMutex() {
+	NullMutex *mutex = new NullMutex();
+	mutex->lockCount = 0;
+	return (OSystem::MutexRef)mutex;
+}
+
+void NullMutexManager::lockMutex(OSystem::MutexRef mutex) {
+	((NullMutex *)mutex)->lockCount++;
+}
+
+void NullMutexManager::unlockMutex(OSystem::MutexRef mutex) {
+	NullMutex *m = (NullMutex *)mutex;
+	assert(m->lockCount > 0);
+	m->lockCount--;
+}
+
+void NullMutexManager::deleteMutex(OSystem::MutexRef mutex) {
+	delete (NullMutex *)mutex;
+}
@@ -0,0 +1,315 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_stdout
+#define FORBIDDEN_SYMBOL_EXCEPTION_stderr
+#define FORBIDDEN_SYMBOL_EXCEPTION_fputs
+#define FORBIDDEN_SYMBOL_EXCEPTION_exit
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+
+#include "backends/platform/headless/headless.h"
+#include "backends/graphics/headless/headless-graphics.h"
+#include "backends/audiocd/audiocd.h"
+#include "backends/mutex/null/null-mutex.h"
+#include "backends/timer/default/default-timer.h"
+
+#ifdef POSIX
+#include "backends/fs/posix/posix-fs-factory.h"
+#include "backends/saves/posix/posix-saves.h"
+#endif
+
+#include "common/config-manager.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/tokenizer.h"
+
+#include <time.h>
+
+/** Interval of the timer manager, as with the other backends */
+static const uint32 kTimerInterval = 10;
+
+/** Size of the buffers the audio is mixed in, in sample frames */
+static const uint32 kAudioSamples = 1024;
+
+OSystem_Headless::OSystem_Headless()
+	:
+	_mixerManager(0),
+	_millis(0),
+	_nextTimerTick(kTimerInterval),
+	_nextInput(0),
+	_frame(0),
+	_maxFrames(0),
+	_quitSent(false),
+	_hashFrames(false),
+	_frameStart(0),
+	_minFrameTime(0xFFFFFFFF),
+	_maxFrameTime(0),
+	_totalFrameTime(0) {
+
+}
+
+OSystem_Headless::~OSystem_Headless() {
+	if (_frame > 0) {
+		Common::String summary = Common::String::format("%u frames in %u ms of simulated time: "
+		                                                "%.1f us per frame on average, %u us min, %u us max\n",
+		                                                _frame, _millis, _totalFrameTime / _frame,
+		                                                _minFrameTime, _maxFrameTime);
+		logMessage(LogMessageType::kInfo, summary.c_str());
+	}
+
+	_report.close();
+
+	// The managers may still use the mutexes, which the ModularBackend
+	// destructor deletes.
+	delete _savefileManager;
+	_savefileManager = 0;
+	delete _eventManager;
+	_eventManager = 0;
+	delete _audiocdManager;
+	_audiocdManager = 0;
+	delete _mixerManager;
+	_mixerManager = 0;
+	delete _timerManager;
+	_timerManager = 0;
+}
+
+void OSystem_Headless::init() {
+	if (_mutexManager == 0)
+		_mutexManager = new NullMutexManager();
+
+#ifdef POSIX
+	if (_fsFactory == 0)
+		_fsFactory = new POSIXFilesystemFactory();
+#endif
+}
+
+void OSystem_Headless::initBackend() {
+	if (_graphicsManager == 0)
+		_graphicsManager = new HeadlessGraphicsManager();
+
+#ifdef POSIX
+	if (_savefileManager == 0)
+		_savefileManager = new POSIXSaveFileManager();
+#endif
+
+	if (_timerManager == 0)
+		_timerManager = new DefaultTimerManager();
+
+	if (_mixerManager == 0) {
+		uint32 rate = 22050;
+		if (ConfMan.hasKey("headless_audio_rate"))
+			rate = ConfMan.getInt("headless_audio_rate");
+		_mixerManager = new NullMixerManager(rate, kAudioSamples);
+		_mixerManager->init();
+	}
+
+	if (ConfMan.hasKey("headless_input"))
+		loadInput(ConfMan.get("headless_input"));
+	if (ConfMan.hasKey("headless_frames"))
+		_maxFrames = ConfMan.getInt("headless_frames");
+	if (ConfMan.hasKey("headless_hash"))
+		_hashFrames = ConfMan.getBool("headless_hash");
+
+	if (ConfMan.hasKey("headless_report")) {
+		const Common::String &filename = ConfMan.get("headless_report");
+		if (!_report.open(filename))
+			error("Could not open the report file '%s'", filename.c_str());
+
+		_report.writeString(_hashFrames ? "frame,time_ms,frame_us,md5\n" : "frame,time_ms,frame_us\n");
+	}
+
+	ModularBackend::initBackend();
+
+	_frameStart = getMicros();
+}
+
+void OSystem_Headless::loadInput(const Common::String &filename) {
+	Common::File file;
+	if (!file.open(Common::FSNode(filename)))
+		error("Could not open the input file '%s'", filename.c_str());
+
+	while (!file.eos() && !file.err()) {
+		Common::String line = file.readLine();
+		line.trim();
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		Common::StringTokenizer tokenizer(line);
+		ScriptedEvent scripted;
+		scripted.frame = atoi(tokenizer.nextToken().c_str());
+
+		Common::Event &event = scripted.event;
+		const Common::String type = tokenizer.nextToken();
+		if (type == "keydown" || type == "keyup") {
+			event.type = type == "keydown" ? Common::EVENT_KEYDOWN : Common::EVENT_KEYUP;
+			event.kbd.keycode = (Common::KeyCode)atoi(tokenizer.nextToken().c_str());
+			const Common::String ascii = tokenizer.nextToken();
+			event.kbd.ascii = ascii.empty() ? (event.kbd.keycode < 256 ? event.kbd.keycode : 0) : atoi(ascii.c_str());
+		} else if (type == "mousemove") {
+			event.type = Common::EVENT_MOUSEMOVE;
+		} else if (type == "lbuttondown") {
+			event.type = Common::EVENT_LBUTTONDOWN;
+		} else if (type == "lbuttonup") {
+			event.type = Common::EVENT_LBUTTONUP;
+		} else if (type == "rbuttondown") {
+			event.type = Common::EVENT_RBUTTONDOWN;
+		} else if (type == "rbuttonup") {
+			event.type = Common::EVENT_RBUTTONUP;
+		} else if (type == "quit") {
+			event.type = Common::EVENT_QUIT;
+		} else {
+			error("Unknown event '%s' in the input file '%s'", type.c_str(), filename.c_str());
+		}
+
+		// The mouse events keep the last position unless one is given
+		if (event.type >= Common::EVENT_MOUSEMOVE && event.type <= Common::EVENT_RBUTTONUP) {
+			const Common::String x = tokenizer.nextToken();
+			const Common::String y = tokenizer.nextToken();
+			event.mouse.x = x.empty() ? -1 : atoi(x.c_str());
+			event.mouse.y = y.empty() ? -1 : atoi(y.c_str());
+		}
+
+		if (!_input.empty() && _input.back().frame > scripted.frame)
+			error("The events of the input file '%s' are not sorted by frame", filename.c_str());
+		_input.push_back(scripted);
+	}
+}
+
+bool OSystem_Headless::pollEvent(Common::Event &event) {
+	if (_maxFrames > 0 && _frame >= _maxFrames && !_quitSent) {
+		_quitSent = true;
+		event.type = Common::EVENT_QUIT;
+		return true;
+	}
+
+	if (_nextInput >= _input.size() || _input[_nextInput].frame > _frame)
+		return false;
+
+	event = _input[_nextInput++].event;
+	if (event.type >= Common::EVENT_MOUSEMOVE && event.type <= Common::EVENT_RBUTTONUP) {
+		if (event.mouse.x < 0)
+			event.mouse = _mouse;
+		_mouse = event.mouse;
+	}
+	return true;
+}
+
+void OSystem_Headless::updateScreen() {
+	ModularBackend::updateScreen();
+	endFrame();
+}
+
+void OSystem_Headless::endFrame() {
+	const uint32 frameTime = getMicros() - _frameStart;
+
+	if (frameTime < _minFrameTime)
+		_minFrameTime = frameTime;
+	if (frameTime > _maxFrameTime)
+		_maxFrameTime = frameTime;
+	_totalFrameTime += frameTime;
+
+	if (_report.isOpen()) {
+		Common::String line = Common::String::format("%u,%u,%u", _frame, _millis, frameTime);
+
+		if (_hashFrames) {
+			const Graphics::Surface &screen = ((HeadlessGraphicsManager *)_graphicsManager)->getDisplayedSurface();
+			Common::MemoryReadStream stream((const byte *)screen.pixels, screen.h * screen.pitch);
+			line += ",";
+			line += Common::computeStreamMD5AsString(stream);
+		}
+
+		line += "\n";
+		_report.writeString(line);
+	}
+
+	_frame++;
+
+	// Neither the hash nor the report count in the next frame
+	_frameStart = getMicros();
+}
+
+uint32 OSystem_Headless::getMillis(bool skipRecord) {
+	return _millis;
+}
+
+void OSystem_Headless::delayMillis(uint msecs) {
+	const uint32 end = _millis + msecs;
+
+	// Advance the clock up to each invocation of the timers, so that they
+	// run as often as they would in real time, and the audio in between
+	while (_millis != end) {
+		if (end - _nextTimerTick < 0x80000000) {
+			_millis = _nextTimerTick;
+			_nextTimerTick += kTimerInterval;
+
+			_mixerManager->update(_millis);
+			((DefaultTimerManager *)_timerManager)->handler();
+		} else {
+			_millis = end;
+			_mixerManager->update(_millis);
+		}
+	}
+}
+
+void OSystem_Headless::getTimeAndDate(TimeDate &td) const {
+	// The clock is started on January 1st, 2000, a Saturday
+	const uint32 seconds = _millis / 1000;
+	const uint32 days = seconds / (24 * 60 * 60);
+
+	td.tm_sec = seconds % 60;
+	td.tm_min = (seconds / 60) % 60;
+	td.tm_hour = (seconds / (60 * 60)) % 24;
+	td.tm_mday = 1 + days % 31;
+	td.tm_mon = 0;
+	td.tm_year = 100;
+	td.tm_wday = (6 + days) % 7;
+}
+
+Audio::Mixer *OSystem_Headless::getMixer() {
+	assert(_mixerManager);
+	return _mixerManager->getMixer();
+}
+
+void OSystem_Headless::quit() {
+	delete this;
+	exit(0);
+}
+
+void OSystem_Headless::logMessage(LogMessageType::Type type, const char *message) {
+	FILE *output = 0;
+
+	if (type == LogMessageType::kInfo || type == LogMessageType::kDebug)
+		output = stdout;
+	else
+		output = stderr;
+
+	fputs(message, output);
+	fflush(output);
+}
+
+uint32 OSystem_Headless::getMicros() {
+	// The real time, since this measures the engine
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,124 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef PLATFORM_HEADLESS_H
+#define PLATFORM_HEADLESS_H
+
+#include "backends/modular-backend.h"
+#include "backends/mixer/null/null-mixer.h"
+#include "common/array.h"
+#include "common/events.h"
+#include "common/file.h"
+
+/**
+ * Headless backend, meant for benchmarking the engines. Nothing is shown
+ * and nothing is played: the screen is a surface in memory, rendered by the
+ * software renderers, and the audio is mixed at the pace of a simulated
+ * output.
+ *
+ * The backend runs on a single thread and has a simulated clock, which
+ * only advances when the engine waits in delayMillis(). The timers and the
+ * audio run at that point, so that each run of the same game with the same
+ * input does the same work at the same time, and the duration of each
+ * frame only measures the engine.
+ *
+ * It is configured with the following keys of the application domain:
+ *   headless_input       file of the scripted input events, see loadInput()
+ *   headless_report      file to write the frame timings to, as CSV
+ *   headless_hash        write the MD5 of the screen of each frame
+ *   headless_frames      quit after this number of frames
+ *   headless_audio_rate  rate of the simulated audio output, 22050 by default
+ */
+class OSystem_Headless : public ModularBackend, Common::EventSource {
+public:
+	OSystem_Headless();
+	virtual ~OSystem_Headless();
+
+	/**
+	 * Pre-initialize backend. It should be called after
+	 * instantiating the backend. Early needed managers are
+	 * created here.
+	 */
+	virtual void init();
+
+	virtual void initBackend();
+
+	virtual void updateScreen();
+
+	virtual bool pollEvent(Common::Event &event);
+	virtual uint32 getMillis(bool skipRecord = false);
+	virtual void delayMillis(uint msecs);
+	virtual uint32 getMicros();
+	virtual void getTimeAndDate(TimeDate &td) const;
+
+	virtual Audio::Mixer *getMixer();
+
+	virtual void quit();
+
+	virtual void logMessage(LogMessageType::Type type, const char *message);
+
+protected:
+	virtual Common::EventSource *getDefaultEventSource() { return this; }
+
+	/** An input event, sent when the engine is done with the given frame */
+	struct ScriptedEvent {
+		uint32 frame;
+		Common::Event event;
+	};
+
+	/**
+	 * Load the scripted input. Each line of the file holds an event, as
+	 * "<frame> <type> [arguments]", sorted by frame. The types are
+	 *   keydown <keycode> [ascii], keyup <keycode> [ascii]
+	 *   mousemove <x> <y>
+	 *   lbuttondown, lbuttonup, rbuttondown, rbuttonup [<x> <y>]
+	 *   quit
+	 * Empty lines and the lines starting with '#' are ignored.
+	 */
+	void loadInput(const Common::String &filename);
+
+	/** Write the timing of the frame which just ended to the report */
+	void endFrame();
+
+	NullMixerManager *_mixerManager;
+
+	uint32 _millis;        ///< The simulated clock
+	uint32 _nextTimerTick; ///< Time of the next invocation of the timers
+
+	Common::Array<ScriptedEvent> _input;
+	uint _nextInput;
+	Common::Point _mouse;
+
+	uint32 _frame;
+	uint32 _maxFrames;
+	bool _quitSent;
+
+	bool _hashFrames;
+	Common::DumpFile _report;
+
+	uint32 _frameStart;
+	uint32 _minFrameTime;
+	uint32 _maxFrameTime;
+	double _totalFrameTime; ///< In microseconds
+};
+
+#endif
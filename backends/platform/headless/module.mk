@@ -0,0 +1,10 @@
+MODULE := backends/platform/headless
+
+MODULE_OBJS := \
+	headless.o \
+	headless-main.o
+
+# We don't use rules.mk but rather manually update OBJS and MODULE_DIRS.
+MODULE_OBJS := $(addprefix $(MODULE)/, $(MODULE_OBJS))
+OBJS := $(MODULE_OBJS) $(OBJS)
+MODULE_DIRS += $(sort $(dir $(MODULE_OBJS)))
@@ -50,7 +50,7 @@
 
 #include "icons/residualvm.xpm"
 
-#include <time.h>	// for getTimeAndDate()
+#include <time.h>	// for getTimeAndDate() and getMicros()
 
 #ifdef USE_DETECTLANG
 #ifndef WIN32
@@ -432,6 +432,25 @@ void OSystem_SDL::delayMillis(uint msecs) {
 		SDL_Delay(msecs);
 }
 
+uint32 OSystem_SDL::getMicros() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// Split the conversion, so that it does not overflow
+	Uint64 counter = SDL_GetPerformanceCounter();
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	return (uint32)((counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency);
+#elif defined(POSIX)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+	return SDL_GetTicks() * 1000;
+#endif
+}
+
+uint32 OSystem_SDL::getThreadId() {
+	return (uint32)SDL_ThreadID();
+}
+
 void OSystem_SDL::getTimeAndDate(TimeDate &td) const {
 	time_t curTime = time(0);
 	struct tm t = *localtime(&curTime);
@@ -23,24 +23,24 @@
 #include "backends/timer/default/default-timer.h"
 #include "common/util.h"
 #include "common/system.h"
+#include "common/debug.h"
 
 struct TimerSlot {
 	Common::TimerManager::TimerProc callback;
 	void *refCon;
 	Common::String id;
-	uint32 interval;	// in microseconds
-
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// microseconds part of nextFire
+	Common::TimerSchedule schedule;
 
 	TimerSlot *next;
+
+	TimerSlot() : callback(0), refCon(0), schedule(0, 0), next(0) {}
 };
 
 void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
 	// The head points to a fake anchor TimerSlot; this common
 	// trick allows us to get rid of many special cases.
 
-	const uint32 nextFireTime = newSlot->nextFireTime;
+	const uint32 nextFireTime = newSlot->schedule.getNextFireTime();
 	TimerSlot *slot = head;
 	newSlot->next = 0;
 
@@ -48,7 +48,7 @@ void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
 	// timers in such a way that the list stays sorted...
 	while (true) {
 		assert(slot);
-		if (slot->next == 0 || nextFireTime < slot->next->nextFireTime) {
+		if (slot->next == 0 || nextFireTime < slot->next->schedule.getNextFireTime()) {
 			newSlot->next = slot->next;
 			slot->next = newSlot;
 			return;
@@ -57,24 +57,30 @@ void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
 	}
 }
 
+static void deleteSlots(TimerSlot *slot) {
+	while (slot) {
+		TimerSlot *next = slot->next;
+		delete slot;
+		slot = next;
+	}
+}
+
 
 DefaultTimerManager::DefaultTimerManager() :
-	_head(0) {
+	_head(0), _isolated(0) {
 
 	_head = new TimerSlot();
-	memset(_head, 0, sizeof(TimerSlot));
+	_isolated = new TimerSlot();
 }
 
 DefaultTimerManager::~DefaultTimerManager() {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
-	}
+	// The backend must have stopped the isolated workers by now
+	deleteSlots(_head);
+	deleteSlots(_isolated);
 	_head = 0;
+	_isolated = 0;
 }
 
 void DefaultTimerManager::handler() {
@@ -84,19 +90,13 @@ void DefaultTimerManager::handler() {
 
 	// Repeat as long as there is a TimerSlot that is scheduled to fire.
 	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
+	while (slot && slot->schedule.isDue(curTime)) {
 		// Remove the slot from the priority queue
 		_head->next = slot->next;
 
 		// Update the fire time and reinsert the TimerSlot into the priority
 		// queue.
-		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
-		}
+		slot->schedule.fire(curTime);
 		insertPrioQueue(_head, slot);
 
 		// Invoke the timer callback
@@ -108,7 +108,33 @@ void DefaultTimerManager::handler() {
 	}
 }
 
+uint32 DefaultTimerManager::runIsolatedTimer(TimerSlot *slot) {
+	uint32 curTime = g_system->getMillis(true);
+
+	{
+		Common::StackLock lock(_statsMutex);
+		if (!slot->schedule.isDue(curTime))
+			return slot->schedule.getDelay(curTime);
+
+		slot->schedule.fire(curTime);
+	}
+
+	assert(slot->callback);
+	slot->callback(slot->refCon);
+
+	Common::StackLock lock(_statsMutex);
+	return slot->schedule.getDelay(g_system->getMillis(true));
+}
+
 bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, void *refCon, const Common::String &id) {
+	return installSlot(callback, interval, refCon, id, false);
+}
+
+bool DefaultTimerManager::installIsolatedTimerProc(TimerProc callback, int32 interval, void *refCon, const Common::String &id) {
+	return installSlot(callback, interval, refCon, id, true);
+}
+
+bool DefaultTimerManager::installSlot(TimerProc callback, int32 interval, void *refCon, const Common::String &id, bool isolated) {
 	assert(interval > 0);
 	Common::StackLock lock(_mutex);
 
@@ -130,45 +156,106 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	slot->callback = callback;
 	slot->refCon = refCon;
 	slot->id = id;
-	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
+	slot->schedule = Common::TimerSchedule(interval, g_system->getMillis());
 	slot->next = 0;
 
-	insertPrioQueue(_head, slot);
+	if (isolated && startIsolatedWorker(slot)) {
+		slot->next = _isolated->next;
+		_isolated->next = slot;
+	} else {
+		insertPrioQueue(_head, slot);
+	}
 
 	return true;
 }
 
+static void printStats(const TimerSlot *slot) {
+	const Common::TimerStats &stats = slot->schedule.getStats();
+	debug(1, "Timer %s: fired %u times, %u late, %u us average and %u us maximum delay",
+		  slot->id.c_str(), stats.fired, stats.late,
+		  stats.fired ? (uint32)(stats.totalLateness / stats.fired) : 0, stats.maxLateness);
+}
+
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
-	Common::StackLock lock(_mutex);
+	TimerSlot *removed = 0;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		TimerSlot *slot = _head;
+
+		while (slot->next) {
+			if (slot->next->callback == callback) {
+				TimerSlot *next = slot->next->next;
+				printStats(slot->next);
+				delete slot->next;
+				slot->next = next;
+			} else {
+				slot = slot->next;
+			}
+		}
+
+		// Unlink the isolated timers. They may still be running, and may be
+		// removing other timers themselves, so their workers are stopped
+		// once the lock is released.
+		slot = _isolated;
 
-	TimerSlot *slot = _head;
+		while (slot->next) {
+			if (slot->next->callback == callback) {
+				TimerSlot *next = slot->next->next;
+				slot->next->next = removed;
+				removed = slot->next;
+				slot->next = next;
+			} else {
+				slot = slot->next;
+			}
+		}
+
+		// We need to remove all names referencing the timer proc here.
+		//
+		// Else we run into troubles, when the client code removes and readds timer
+		// callbacks.
+		//
+		// Another issues occurs when one plays a game with ALSA as music driver,
+		// does RTL and starts a different engine game with ALSA as music driver.
+		// In this case the MPU401 code will add different timer procs with the
+		// same name, resulting in two different callbacks added with the same
+		// name and causing installTimerProc to error out.
+		// A good test case is running a SCUMM with ALSA output and then a KYRA
+		// game for example.
+		for (TimerSlotMap::iterator i = _callbacks.begin(), end = _callbacks.end(); i != end; ++i) {
+			if (i->_value == callback)
+				_callbacks.erase(i);
+		}
+	}
+
+	while (removed) {
+		TimerSlot *next = removed->next;
+		stopIsolatedWorker(removed);
+		printStats(removed);
+		delete removed;
+		removed = next;
+	}
+}
+
+bool DefaultTimerManager::getTimerStats(TimerProc callback, Common::TimerStats &stats) {
+	Common::StackLock lock(_mutex);
 
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
-		} else {
-			slot = slot->next;
+	for (TimerSlot *slot = _head->next; slot; slot = slot->next) {
+		if (slot->callback == callback) {
+			stats = slot->schedule.getStats();
+			return true;
 		}
 	}
 
-	// We need to remove all names referencing the timer proc here.
-	//
-	// Else we run into troubles, when the client code removes and readds timer
-	// callbacks.
-	//
-	// Another issues occurs when one plays a game with ALSA as music driver,
-	// does RTL and starts a different engine game with ALSA as music driver.
-	// In this case the MPU401 code will add different timer procs with the
-	// same name, resulting in two different callbacks added with the same
-	// name and causing installTimerProc to error out.
-	// A good test case is running a SCUMM with ALSA output and then a KYRA
-	// game for example.
-	for (TimerSlotMap::iterator i = _callbacks.begin(), end = _callbacks.end(); i != end; ++i) {
-		if (i->_value == callback)
-			_callbacks.erase(i);
+	Common::StackLock statsLock(_statsMutex);
+
+	for (TimerSlot *slot = _isolated->next; slot; slot = slot->next) {
+		if (slot->callback == callback) {
+			stats = slot->schedule.getStats();
+			return true;
+		}
 	}
+
+	return false;
 }
@@ -35,13 +35,41 @@ private:
 
 	Common::Mutex _mutex;
 	TimerSlot *_head;
+	TimerSlot *_isolated; ///< List of the timers running on their own workers
 	TimerSlotMap _callbacks;
 
+	/** Protects the statistics of the isolated timers, which are updated outside of _mutex. */
+	Common::Mutex _statsMutex;
+
+	bool installSlot(TimerProc proc, int32 interval, void *refCon, const Common::String &id, bool isolated);
+
+protected:
+	/**
+	 * Start a worker running the given isolated timer, by calling
+	 * runIsolatedTimer() until stopIsolatedWorker() is called.
+	 *
+	 * @return	false if the backend has no workers. The timer is then run by
+	 *          handler() like the other ones.
+	 */
+	virtual bool startIsolatedWorker(TimerSlot *slot) { return false; }
+
+	/** Stop the worker of the given isolated timer, and wait for it to finish. */
+	virtual void stopIsolatedWorker(TimerSlot *slot) {}
+
+	/**
+	 * Invoke the given isolated timer if it is due, from its worker.
+	 *
+	 * @return	the number of milliseconds the worker may sleep until the timer is due
+	 */
+	uint32 runIsolatedTimer(TimerSlot *slot);
+
 public:
 	DefaultTimerManager();
 	virtual ~DefaultTimerManager();
 	virtual bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id);
+	virtual bool installIsolatedTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id);
 	virtual void removeTimerProc(TimerProc proc);
+	virtual bool getTimerStats(TimerProc proc, Common::TimerStats &stats);
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
@@ -35,6 +35,8 @@ static Uint32 timer_handler(Uint32 interval, void *param) {
 }
 
 SdlTimerManager::SdlTimerManager() {
+	_workersMutex = SDL_CreateMutex();
+
 	// Initializes the SDL timer subsystem
 	if (SDL_InitSubSystem(SDL_INIT_TIMER) == -1) {
 		error("Could not initialize SDL: %s", SDL_GetError());
@@ -47,6 +49,90 @@ SdlTimerManager::SdlTimerManager() {
 SdlTimerManager::~SdlTimerManager() {
 	// Removes the timer callback
 	SDL_RemoveTimer(_timerID);
+
+	for (uint i = 0; i < _workers.size(); i++)
+		stopWorker(_workers[i]);
+	_workers.clear();
+
+	SDL_DestroyMutex(_workersMutex);
+}
+
+int SDLCALL SdlTimerManager::workerEntry(void *arg) {
+	Worker *worker = (Worker *)arg;
+
+	SDL_LockMutex(worker->mutex);
+	while (!worker->quit) {
+		SDL_UnlockMutex(worker->mutex);
+		uint32 delay = worker->manager->runIsolatedTimer(worker->slot);
+		SDL_LockMutex(worker->mutex);
+
+		// Sleep until the timer is due, to the millisecond rather than
+		// the 10ms of the shared timer
+		if (!worker->quit && delay > 0)
+			SDL_CondWaitTimeout(worker->wake, worker->mutex, delay);
+	}
+	SDL_UnlockMutex(worker->mutex);
+
+	return 0;
+}
+
+bool SdlTimerManager::startIsolatedWorker(TimerSlot *slot) {
+	Worker *worker = new Worker();
+	worker->manager = this;
+	worker->slot = slot;
+	worker->mutex = SDL_CreateMutex();
+	worker->wake = SDL_CreateCond();
+	worker->quit = false;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	worker->thread = SDL_CreateThread(workerEntry, "timer", worker);
+#else
+	worker->thread = SDL_CreateThread(workerEntry, worker);
+#endif
+
+	if (!worker->thread) {
+		warning("Could not create timer thread: %s", SDL_GetError());
+		SDL_DestroyCond(worker->wake);
+		SDL_DestroyMutex(worker->mutex);
+		delete worker;
+		return false;
+	}
+
+	SDL_LockMutex(_workersMutex);
+	_workers.push_back(worker);
+	SDL_UnlockMutex(_workersMutex);
+	return true;
+}
+
+void SdlTimerManager::stopIsolatedWorker(TimerSlot *slot) {
+	Worker *worker = 0;
+
+	SDL_LockMutex(_workersMutex);
+	for (uint i = 0; i < _workers.size(); i++) {
+		if (_workers[i]->slot == slot) {
+			worker = _workers[i];
+			_workers.remove_at(i);
+			break;
+		}
+	}
+	SDL_UnlockMutex(_workersMutex);
+
+	if (worker)
+		stopWorker(worker);
+}
+
+void SdlTimerManager::stopWorker(Worker *worker) {
+	SDL_LockMutex(worker->mutex);
+	worker->quit = true;
+	SDL_CondSignal(worker->wake);
+	SDL_UnlockMutex(worker->mutex);
+
+	// Once the thread has finished, the callback is not running anymore
+	SDL_WaitThread(worker->thread, NULL);
+
+	SDL_DestroyCond(worker->wake);
+	SDL_DestroyMutex(worker->mutex);
+	delete worker;
 }
 
 #endif
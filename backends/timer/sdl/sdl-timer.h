@@ -27,9 +27,11 @@
 
 #include "backends/platform/sdl/sdl-sys.h"
 
+#include "common/array.h"
+
 /**
  * SDL timer manager. Setups the timer callback for
- * DefaultTimerManager.
+ * DefaultTimerManager, and runs each isolated timer on its own thread.
  */
 class SdlTimerManager : public DefaultTimerManager {
 public:
@@ -38,6 +40,25 @@ public:
 
 protected:
 	SDL_TimerID _timerID;
+
+	/** A thread running an isolated timer. */
+	struct Worker {
+		SdlTimerManager *manager;
+		TimerSlot *slot;
+		SDL_Thread *thread;
+		SDL_mutex *mutex;
+		SDL_cond *wake; ///< Signalled to stop the worker while it sleeps
+		bool quit;
+	};
+
+	Common::Array<Worker *> _workers;
+	SDL_mutex *_workersMutex; ///< Workers may be stopped from other workers
+
+	virtual bool startIsolatedWorker(TimerSlot *slot);
+	virtual void stopIsolatedWorker(TimerSlot *slot);
+
+	void stopWorker(Worker *worker);
+	static int SDLCALL workerEntry(void *arg);
 };
 
 
@@ -47,6 +47,7 @@
 #ifdef ENABLE_EVENTRECORDER
 #include "common/recorderfile.h"
 #endif
+#include "common/profiler.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/tokenizer.h"
@@ -395,6 +396,11 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	// the command line params) was read.
 	system.initBackend();
 
+	// Create the profiler now, as its creation is not thread-safe: the
+	// first PROFILE_SCOPE() of a zone may run on a timer or decoder thread.
+	// It needs the backend for its mutex.
+	Common::Profiler::instance();
+
 	// If we received an invalid graphics mode parameter via command line
 	// we check this here. We can't do it until after the backend is inited,
 	// or there won't be a graphics manager to ask for the supported modes.
@@ -26,7 +26,9 @@
 #define COMMON_BITSTREAM_H
 
 #include "common/scummsys.h"
+#include "common/endian.h"
 #include "common/textconsole.h"
+#include "common/util.h"
 #include "common/stream.h"
 
 namespace Common {
@@ -262,6 +264,69 @@ public:
 			x = (x & ~(1 << n)) | (getBit() << n);
 	}
 
+	/** Is this stream handing out its bits MSB first? */
+	static bool msb2lsb() {
+		return isMSB2LSB;
+	}
+
+	/**
+	 * Read up to 32 bits without changing the stream's position.
+	 *
+	 * The non-virtual counterpart of peekBits(), for decoders that are
+	 * templated on the concrete stream type. Bits still held in the
+	 * current value are returned without touching the stream, and bits
+	 * past the end of the stream read as 0.
+	 */
+	inline uint32 peekBitsInline(uint8 n) {
+		assert(n > 0 && n <= 32);
+
+		uint32 avail = (_inValue == 0) ? 0 : valueBits - _inValue;
+		uint32 v     = _value;
+
+		if (avail < n) {
+			uint32 curPos = _stream->pos();
+			uint32 end    = _stream->size();
+
+			for (uint32 p = curPos; (avail < n) && (p + (valueBits >> 3) <= end); p += valueBits >> 3) {
+				uint32 next = readData();
+
+				if (isMSB2LSB)
+					v |= (next << (32 - valueBits)) >> avail;
+				else
+					v |= next << avail;
+
+				avail += valueBits;
+			}
+
+			_stream->seek(curPos);
+		}
+
+		if (isMSB2LSB)
+			return v >> (32 - n);
+
+		return (n == 32) ? v : (v & ((1u << n) - 1));
+	}
+
+	/** Skip the specified amount of bits. The non-virtual counterpart of skip(). */
+	inline void skipInline(uint32 n) {
+		while (n > 0) {
+			if (_inValue == 0)
+				readValue();
+
+			uint32 step = MIN<uint32>(n, valueBits - _inValue);
+
+			if (step == 32)
+				_value = 0;
+			else if (isMSB2LSB)
+				_value <<= step;
+			else
+				_value >>= step;
+
+			_inValue = (_inValue + step) % valueBits;
+			n -= step;
+		}
+	}
+
 	/** Rewind the bit stream back to the start. */
 	void rewind() {
 		_stream->seek(0);
@@ -320,6 +385,201 @@ typedef BitStreamImpl<32, false, true > BitStream32BEMSB;
 /** 32-bit big-endian data, LSB to MSB. */
 typedef BitStreamImpl<32, false, false> BitStream32BELSB;
 
+/**
+ * A bit stream reading directly from a memory buffer.
+ *
+ * Unlike BitStreamImpl, this is not a BitStream: it offers the same
+ * methods, but they are not virtual and can be inlined into decoders that
+ * use the concrete type. The bits are buffered in a 64-bit value, which
+ * is refilled with a single unaligned read of the next 8 bytes.
+ *
+ * Only memory layouts where the bits follow each other byte by byte can
+ * be read this way, i.e. little-endian LSB to MSB and big-endian MSB to
+ * LSB. valueBits only rounds down the size, as BitStreamImpl does.
+ */
+template<int valueBits, bool isMSB2LSB>
+class BitStreamMemoryImpl {
+private:
+	const byte *_data;     ///< The input data.
+	uint32 _size;          ///< Size of the input data in bytes.
+	bool _disposeAfterUse; ///< Should we delete[] the data on destruction?
+
+	uint32 _bytePos;   ///< Position of the next byte to buffer.
+	uint64 _cache;     ///< The buffered bits.
+	uint32 _cacheBits; ///< Number of valid bits in the buffer.
+
+	/** Read 8 bytes from the data. Bytes past the end read as 0. */
+	inline uint64 readCache() const {
+		const byte *src = _data + _bytePos;
+		byte tail[8];
+
+		if (_bytePos + 8 > _size) {
+			memset(tail, 0, 8);
+			if (_bytePos < _size)
+				memcpy(tail, src, _size - _bytePos);
+			src = tail;
+		}
+
+		if (isMSB2LSB)
+			return ((uint64)READ_BE_UINT32(src) << 32) | READ_BE_UINT32(src + 4);
+		else
+			return ((uint64)READ_LE_UINT32(src + 4) << 32) | READ_LE_UINT32(src);
+	}
+
+	/** Fill the buffer up to at least 56 bits. */
+	inline void refill() {
+		if (isMSB2LSB)
+			_cache |= readCache() >> _cacheBits;
+		else
+			_cache |= readCache() << _cacheBits;
+
+		// Only whole bytes are taken, the rest of the read is done again next time
+		_bytePos   += (63 - _cacheBits) >> 3;
+		_cacheBits |= 56;
+	}
+
+public:
+	/** Create a bit stream reading size bytes of data, and optionally delete[] the data on destruction. */
+	BitStreamMemoryImpl(const byte *data, uint32 size, bool disposeAfterUse = false) :
+		_data(data), _size(size & ~((uint32) ((valueBits >> 3) - 1))), _disposeAfterUse(disposeAfterUse),
+		_bytePos(0), _cache(0), _cacheBits(0) {
+
+		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
+			error("BitStreamMemoryImpl: Invalid memory layout %d, %d", valueBits, isMSB2LSB);
+	}
+
+	~BitStreamMemoryImpl() {
+		if (_disposeAfterUse)
+			delete[] _data;
+	}
+
+	/** Is this stream handing out its bits MSB first? */
+	static bool msb2lsb() {
+		return isMSB2LSB;
+	}
+
+	/** Read up to 32 bits without changing the stream's position. Bits past the end read as 0. */
+	inline uint32 peekBitsInline(uint8 n) {
+		assert(n > 0 && n <= 32);
+
+		if (_cacheBits < n)
+			refill();
+
+		if (isMSB2LSB)
+			return (uint32)(_cache >> (64 - n));
+
+		return (uint32)(_cache & ((((uint64)1) << n) - 1));
+	}
+
+	/** Skip the specified amount of bits. */
+	inline void skipInline(uint32 n) {
+		if (pos() + n > size())
+			error("BitStreamMemoryImpl::skip(): End of bit stream reached");
+
+		if (n > _cacheBits) {
+			// Drop the buffer and continue from the byte the skip ends in
+			n -= _cacheBits;
+			_bytePos  += n >> 3;
+			n &= 7;
+			_cache     = 0;
+			_cacheBits = 0;
+
+			if (n == 0)
+				return;
+
+			refill();
+		}
+
+		if (isMSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheBits -= n;
+	}
+
+	/** Read a multi-bit value from the bit stream, in the same bit order as BitStreamImpl::getBits(). */
+	inline uint32 getBits(uint8 n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			error("BitStreamMemoryImpl::getBits(): Too many bits requested to be read");
+
+		uint32 v = peekBitsInline(n);
+		skipInline(n);
+
+		return v;
+	}
+
+	/** Read a bit from the bit stream. */
+	inline uint32 getBit() {
+		return getBits(1);
+	}
+
+	/** Read a bit from the bit stream, without changing the stream's position. */
+	inline uint32 peekBit() {
+		return peekBitsInline(1);
+	}
+
+	/** Read a multi-bit value from the bit stream, without changing the stream's position. */
+	inline uint32 peekBits(uint8 n) {
+		return (n == 0) ? 0 : peekBitsInline(n);
+	}
+
+	/** Skip the specified amount of bits. */
+	inline void skip(uint32 n) {
+		skipInline(n);
+	}
+
+	/** Add a bit to the value x, making it an n+1-bit value. See BitStreamImpl::addBit(). */
+	inline void addBit(uint32 &x, uint32 n) {
+		if (n >= 32)
+			error("BitStreamMemoryImpl::addBit(): Too many bits requested to be read");
+
+		if (isMSB2LSB)
+			x = (x << 1) | getBit();
+		else
+			x = (x & ~(1 << n)) | (getBit() << n);
+	}
+
+	/** Rewind the bit stream back to the start. */
+	void rewind() {
+		_bytePos   = 0;
+		_cache     = 0;
+		_cacheBits = 0;
+	}
+
+	/** Return the stream position in bits. */
+	inline uint32 pos() const {
+		return _bytePos * 8 - _cacheBits;
+	}
+
+	/** Return the stream size in bits. */
+	inline uint32 size() const {
+		return _size * 8;
+	}
+
+	inline bool eos() const {
+		return pos() >= size();
+	}
+};
+
+/** 8-bit data in memory, MSB to LSB. */
+typedef BitStreamMemoryImpl<8, true > BitStreamMemory8MSB;
+/** 8-bit data in memory, LSB to MSB. */
+typedef BitStreamMemoryImpl<8, false> BitStreamMemory8LSB;
+
+/** 16-bit little-endian data in memory, LSB to MSB. */
+typedef BitStreamMemoryImpl<16, false> BitStreamMemory16LELSB;
+/** 16-bit big-endian data in memory, MSB to LSB. */
+typedef BitStreamMemoryImpl<16, true > BitStreamMemory16BEMSB;
+
+/** 32-bit little-endian data in memory, LSB to MSB. */
+typedef BitStreamMemoryImpl<32, false> BitStreamMemory32LELSB;
+/** 32-bit big-endian data in memory, MSB to LSB. */
+typedef BitStreamMemoryImpl<32, true > BitStreamMemory32BEMSB;
+
 } // End of namespace Common
 
 #endif // COMMON_BITSTREAM_H
@@ -48,6 +48,9 @@ Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const u
 	_codes.resize(maxLength);
 	_symbols.resize(codeCount);
 
+	_tableBits  = MIN<uint8>(maxLength, kTableBits);
+	_tableOrder = -1;
+
 	for (uint32 i = 0; i < codeCount; i++) {
 		// The symbol. If none were specified, just assume it's identical to the code index
 		uint32 symbol = symbols ? symbols[i] : i;
@@ -66,21 +69,89 @@ Huffman::~Huffman() {
 void Huffman::setSymbols(const uint32 *symbols) {
 	for (uint32 i = 0; i < _symbols.size(); i++)
 		_symbols[i]->symbol = symbols ? *symbols++ : i;
+
+	// The tables hold copies of the symbols
+	_tableOrder = -1;
 }
 
-uint32 Huffman::getSymbol(BitStream &bits) const {
-	uint32 code = 0;
+void Huffman::buildTable(bool msb2lsb) const {
+	const uint32 primarySize = 1 << _tableBits;
+
+	_table.clear();
+	_table.resize(primarySize);
+
+	// Size the secondary tables after the longest code sharing their prefix
+	Array<uint8> subBits;
+	subBits.resize(primarySize);
+
+	for (uint32 length = _tableBits + 1; length <= _codes.size(); length++) {
+		const uint32 rest = length - _tableBits;
 
-	for (uint32 i = 0; i < _codes.size(); i++) {
-		bits.addBit(code, i);
+		for (CodeList::const_iterator cCode = _codes[length - 1].begin(); cCode != _codes[length - 1].end(); ++cCode) {
+			if (length < 32 && (cCode->code >> length) != 0)
+				continue;
 
-		for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-			if (code == cCode->code)
-				return cCode->symbol;
+			uint32 prefix = msb2lsb ? (cCode->code >> rest) : (cCode->code & (primarySize - 1));
+			subBits[prefix] = MAX<uint8>(subBits[prefix], rest);
+		}
 	}
 
-	error("Unknown Huffman code");
-	return 0;
+	// Shorter codes are placed first and never overwritten, so that the
+	// tables find the same code as the list search in getSymbol()
+	for (uint32 length = 1; length <= _codes.size(); length++) {
+		for (CodeList::const_iterator cCode = _codes[length - 1].begin(); cCode != _codes[length - 1].end(); ++cCode) {
+			// Codes with bits set above their length can never be read
+			if (length < 32 && (cCode->code >> length) != 0)
+				continue;
+
+			if (length <= _tableBits) {
+				const uint32 fill = _tableBits - length;
+
+				for (uint32 j = 0; j < (1u << fill); j++) {
+					uint32 index = msb2lsb ? ((cCode->code << fill) | j) : (cCode->code | (j << length));
+
+					if (_table[index].length == 0) {
+						_table[index].symbol = cCode->symbol;
+						_table[index].length = length;
+					}
+				}
+
+				continue;
+			}
+
+			const uint32 rest   = length - _tableBits;
+			const uint32 prefix = msb2lsb ? (cCode->code >> rest) : (cCode->code & (primarySize - 1));
+
+			// Codes with too long secondary tables are left to the list search
+			if (_table[prefix].length != 0 || subBits[prefix] > kMaxSubTableBits)
+				continue;
+
+			if (_table[prefix].subBits == 0) {
+				_table[prefix].symbol  = _table.size();
+				_table[prefix].subBits = subBits[prefix];
+				_table.resize(_table.size() + (1 << subBits[prefix]));
+			}
+
+			const uint32 bits  = _table[prefix].subBits;
+			const uint32 fill  = bits - rest;
+			const uint32 value = msb2lsb ? (cCode->code & ((1 << rest) - 1)) : (cCode->code >> _tableBits);
+
+			for (uint32 j = 0; j < (1u << fill); j++) {
+				TableEntry &entry = _table[_table[prefix].symbol + (msb2lsb ? ((value << fill) | j) : (value | (j << rest)))];
+
+				if (entry.length == 0) {
+					entry.symbol = cCode->symbol;
+					entry.length = rest;
+				}
+			}
+		}
+	}
+
+	_tableOrder = msb2lsb ? 1 : 0;
+}
+
+uint32 Huffman::getSymbol(BitStream &bits) const {
+	return searchCodes(bits);
 }
 
 } // End of namespace Common
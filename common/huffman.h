@@ -27,6 +27,7 @@
 
 #include "common/array.h"
 #include "common/list.h"
+#include "common/textconsole.h"
 #include "common/types.h"
 
 namespace Common {
@@ -58,7 +59,39 @@ public:
 	/** Return the next symbol in the bitstream. */
 	uint32 getSymbol(BitStream &bits) const;
 
+	/**
+	 * Return the next symbol in the bitstream.
+	 *
+	 * Used when the concrete bit stream type is known. The code is looked
+	 * up in a table indexed by the next bits in the stream, which are read
+	 * through the stream's non-virtual peekBitsInline()/skipInline(). Both
+	 * BitStreamImpl and BitStreamMemoryImpl provide these.
+	 */
+	template<class BITSTREAM>
+	uint32 getSymbol(BITSTREAM &bits) const;
+
 private:
+	/** Number of bits the primary lookup table is indexed with. */
+	static const uint8 kTableBits = 9;
+	/** Longest secondary table a code prefix may get, in bits. */
+	static const uint8 kMaxSubTableBits = 12;
+
+	/**
+	 * An entry in the lookup tables.
+	 *
+	 * An entry with a length holds a decoded symbol. An entry with subBits
+	 * points to the secondary table at index symbol, which is indexed by
+	 * the subBits bits after the primary ones. An entry with neither is not
+	 * in the tables, and is handled by the code lists.
+	 */
+	struct TableEntry {
+		uint32 symbol;
+		uint8  length;
+		uint8  subBits;
+
+		TableEntry() : symbol(0), length(0), subBits(0) { }
+	};
+
 	struct Symbol {
 		uint32 code;
 		uint32 symbol;
@@ -75,8 +108,62 @@ private:
 
 	/** Sorted list of pointers to the symbols. */
 	SymbolList _symbols;
+
+	/** Number of bits the primary table is indexed with. */
+	uint8 _tableBits;
+	/** The primary table, followed by the secondary tables. */
+	mutable Array<TableEntry> _table;
+	/** Bit order the tables were built for: -1 if none, else 0 for LSB first and 1 for MSB first. */
+	mutable int8 _tableOrder;
+
+	/** Return the lookup tables for the given bit order, building them if needed. */
+	const TableEntry *getTable(bool msb2lsb) const {
+		if (_tableOrder != (msb2lsb ? 1 : 0))
+			buildTable(msb2lsb);
+
+		return _table.begin();
+	}
+
+	void buildTable(bool msb2lsb) const;
+
+	/** Find the next code by reading it bit by bit and searching the code lists. */
+	template<class BITSTREAM>
+	uint32 searchCodes(BITSTREAM &bits) const {
+		uint32 code = 0;
+
+		for (uint32 i = 0; i < _codes.size(); i++) {
+			bits.addBit(code, i);
+
+			for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
+				if (code == cCode->code)
+					return cCode->symbol;
+		}
+
+		error("Unknown Huffman code");
+		return 0;
+	}
 };
 
+template<class BITSTREAM>
+uint32 Huffman::getSymbol(BITSTREAM &bits) const {
+	const TableEntry *table = getTable(BITSTREAM::msb2lsb());
+	const TableEntry *entry = &table[bits.peekBitsInline(_tableBits)];
+
+	if (entry->subBits) {
+		bits.skipInline(_tableBits);
+		entry = &table[entry->symbol + bits.peekBitsInline(entry->subBits)];
+
+		if (entry->length == 0)
+			error("Unknown Huffman code");
+	} else if (entry->length == 0) {
+		// Not covered by the tables
+		return searchCodes(bits);
+	}
+
+	bits.skipInline(entry->length);
+	return entry->symbol;
+}
+
 } // End of namespace Common
 
 #endif // COMMON_HUFFMAN_H
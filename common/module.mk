@@ -19,6 +19,7 @@ MODULE_OBJS := \
 	md5.o \
 	mutex.o \
 	platform.o \
+	profiler.o \
 	random.o \
 	rational.o \
 	rendermode.o \
@@ -26,6 +27,7 @@ MODULE_OBJS := \
 	stream.o \
 	system.o \
 	textconsole.o \
+	timer.o \
 	tokenizer.o \
 	translation.o \
 	unzip.o \
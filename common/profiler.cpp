@@ -0,0 +1,166 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "common/profiler.h"
+#include "common/stream.h"
+#include "common/system.h"
+
+namespace Common {
+
+ProfileLog::ProfileLog(uint32 capacity)
+	: _events(0), _capacity(capacity), _next(0), _count(0) {
+	assert(capacity > 0);
+}
+
+ProfileLog::~ProfileLog() {
+	delete[] _events;
+}
+
+uint32 ProfileLog::addZone(const String &name) {
+	for (uint32 i = 0; i < _zones.size(); i++) {
+		if (_zones[i].name == name)
+			return i;
+	}
+
+	ProfileZoneStats stats;
+	stats.name = name;
+	_zones.push_back(stats);
+	resetZone(_zones.size() - 1);
+	return _zones.size() - 1;
+}
+
+void ProfileLog::resetZone(uint32 zone) {
+	ProfileZoneStats &stats = _zones[zone];
+	stats.count = 0;
+	stats.min = 0xFFFFFFFF;
+	stats.max = 0;
+	stats.total = 0;
+}
+
+void ProfileLog::record(uint32 zone, uint32 thread, uint32 start, uint32 duration) {
+	ProfileZoneStats &stats = _zones[zone];
+	stats.count++;
+	if (duration < stats.min)
+		stats.min = duration;
+	if (duration > stats.max)
+		stats.max = duration;
+	stats.total += duration;
+
+	if (!_events)
+		_events = new ProfileEvent[_capacity];
+
+	ProfileEvent &event = _events[_next];
+	event.zone = zone;
+	event.thread = thread;
+	event.start = start;
+	event.duration = duration;
+
+	_next = (_next + 1) % _capacity;
+	if (_count < _capacity)
+		_count++;
+}
+
+void ProfileLog::reset() {
+	for (uint32 i = 0; i < _zones.size(); i++)
+		resetZone(i);
+
+	_next = 0;
+	_count = 0;
+}
+
+const ProfileEvent &ProfileLog::getEvent(uint32 i) const {
+	assert(i < _count);
+	return _events[(_next + _capacity - _count + i) % _capacity];
+}
+
+void ProfileLog::writeChromeTrace(WriteStream &stream) const {
+	stream.writeString("{\"traceEvents\":[");
+
+	for (uint32 i = 0; i < _count; i++) {
+		const ProfileEvent &event = getEvent(i);
+
+		// The names are identifiers from the code, but keep the JSON valid anyway
+		String name;
+		const String &zoneName = _zones[event.zone].name;
+		for (uint32 j = 0; j < zoneName.size(); j++) {
+			if (zoneName[j] == '"' || zoneName[j] == '\\')
+				name += '\\';
+			name += zoneName[j];
+		}
+
+		stream.writeString(String::format("%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%u,\"dur\":%u}",
+		                                  i > 0 ? "," : "", name.c_str(), event.thread, event.start, event.duration));
+	}
+
+	stream.writeString("\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+DECLARE_SINGLETON(Profiler);
+
+Profiler::Profiler()
+	: _log(kEventCapacity), _enabled(false) {
+}
+
+uint32 Profiler::registerZone(const char *name) {
+	StackLock lock(_mutex);
+	return _log.addZone(name);
+}
+
+void Profiler::endZone(uint32 zone, uint32 start) {
+	const uint32 end = g_system->getMicros();
+	const uint32 thread = g_system->getThreadId();
+
+	StackLock lock(_mutex);
+	_log.record(zone, thread, start, end - start);
+}
+
+void Profiler::reset() {
+	StackLock lock(_mutex);
+	_log.reset();
+}
+
+Array<ProfileZoneStats> Profiler::getZoneStats() {
+	StackLock lock(_mutex);
+
+	Array<ProfileZoneStats> stats;
+	for (uint32 i = 0; i < _log.getZoneCount(); i++)
+		stats.push_back(_log.getZoneStats(i));
+	return stats;
+}
+
+void Profiler::writeChromeTrace(WriteStream &stream) {
+	StackLock lock(_mutex);
+	_log.writeChromeTrace(stream);
+}
+
+ProfileScope::ProfileScope(uint32 zone)
+	: _zone(zone), _start(0), _active(ProfileMan.isEnabled()) {
+	if (_active)
+		_start = g_system->getMicros();
+}
+
+ProfileScope::~ProfileScope() {
+	if (_active)
+		ProfileMan.endZone(_zone, _start);
+}
+
+} // End of namespace Common
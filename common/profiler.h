@@ -0,0 +1,175 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef COMMON_PROFILER_H
+#define COMMON_PROFILER_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+
+class WriteStream;
+
+/** Statistics of a profiled zone, in microseconds. */
+struct ProfileZoneStats {
+	String name;
+	uint32 count;
+	uint32 min;
+	uint32 max;
+	double total;
+
+	uint32 getAverage() const { return count ? (uint32)(total / count) : 0; }
+};
+
+/** An invocation of a profiled zone. */
+struct ProfileEvent {
+	uint32 zone;
+	uint32 thread;
+	uint32 start;    ///< Timestamp of the start, in microseconds
+	uint32 duration; ///< In microseconds
+};
+
+/**
+ * Storage of the profiler: the statistics of each zone, and the last events
+ * in a ring buffer, overwriting the oldest ones once it is full. It neither
+ * locks nor measures anything, see Profiler for that.
+ */
+class ProfileLog {
+public:
+	ProfileLog(uint32 capacity);
+	~ProfileLog();
+
+	/**
+	 * Add a zone.
+	 *
+	 * @return	the index of the zone, which is the one of the existing zone
+	 *          if there is one with the same name
+	 */
+	uint32 addZone(const String &name);
+
+	uint32 getZoneCount() const { return _zones.size(); }
+	const ProfileZoneStats &getZoneStats(uint32 zone) const { return _zones[zone]; }
+
+	/** Record an invocation of the given zone. */
+	void record(uint32 zone, uint32 thread, uint32 start, uint32 duration);
+
+	/** Clear the statistics and the events, but keep the zones. */
+	void reset();
+
+	/** The number of events in the buffer. */
+	uint32 getEventCount() const { return _count; }
+
+	/** Get an event of the buffer, the oldest one first. */
+	const ProfileEvent &getEvent(uint32 i) const;
+
+	/**
+	 * Write the events of the buffer in the Trace Event Format of Chrome,
+	 * which chrome://tracing and other trace viewers load.
+	 */
+	void writeChromeTrace(WriteStream &stream) const;
+
+private:
+	void resetZone(uint32 zone);
+
+	Array<ProfileZoneStats> _zones;
+	ProfileEvent *_events; ///< Allocated on the first record
+	uint32 _capacity;
+	uint32 _next;
+	uint32 _count;
+};
+
+/**
+ * The profiler. The code marks the zones to measure with PROFILE_SCOPE(),
+ * which costs a test of a flag when the profiler is disabled, as it is by
+ * default. Once enabled, for example from the debugger, each invocation of
+ * a zone is timed with OSystem::getMicros() and recorded, along with the
+ * thread it ran on.
+ */
+class Profiler : public Singleton<Profiler> {
+public:
+	bool isEnabled() const { return _enabled; }
+	void setEnabled(bool enabled) { _enabled = enabled; }
+
+	/**
+	 * Register a zone, or find the one with the same name.
+	 *
+	 * @return	the index of the zone, to pass to endZone()
+	 */
+	uint32 registerZone(const char *name);
+
+	/** Record the end of an invocation of a zone, started at the given time. */
+	void endZone(uint32 zone, uint32 start);
+
+	/** Clear the statistics and the recorded events. */
+	void reset();
+
+	/** Get a copy of the statistics of all the zones. */
+	Array<ProfileZoneStats> getZoneStats();
+
+	/** Write the recorded events as a Chrome trace, see ProfileLog::writeChromeTrace(). */
+	void writeChromeTrace(WriteStream &stream);
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	Profiler();
+
+	/** The number of events kept, about a minute of a game at 60 fps */
+	static const uint32 kEventCapacity = 65536;
+
+	Mutex _mutex;
+	ProfileLog _log;
+	bool _enabled;
+};
+
+/** Shortcut for accessing the profiler. */
+#define ProfileMan		Common::Profiler::instance()
+
+/**
+ * Measure the lifetime of the object as an invocation of the given zone,
+ * if the profiler is enabled when it is created.
+ */
+class ProfileScope {
+public:
+	ProfileScope(uint32 zone);
+	~ProfileScope();
+
+private:
+	uint32 _zone;
+	uint32 _start;
+	bool _active;
+};
+
+/**
+ * Profile the rest of the enclosing block as the zone of the given name.
+ * The zone is registered once per call site, the first time it runs.
+ */
+#define PROFILE_SCOPE(name) \
+	static const uint32 profileZone = ProfileMan.registerZone(name); \
+	Common::ProfileScope profileScope(profileZone)
+
+} // End of namespace Common
+
+#endif
@@ -978,6 +978,23 @@ public:
 	/** Delay/sleep for the specified amount of milliseconds. */
 	virtual void delayMillis(uint msecs) = 0;
 
+	/**
+	 * Get a timestamp in microseconds, for profiling. Its origin is
+	 * unspecified and it wraps around, so only the differences between
+	 * timestamps are meaningful. By default it is derived from getMillis().
+	 *
+	 * ResidualVM specific method
+	 */
+	virtual uint32 getMicros() { return getMillis(true) * 1000; }
+
+	/**
+	 * Get an identifier of the calling thread, for profiling. By default
+	 * all the threads have the identifier 0.
+	 *
+	 * ResidualVM specific method
+	 */
+	virtual uint32 getThreadId() { return 0; }
+
 	/**
 	 * Get the current time and date, in the local timezone.
 	 * Corresponds on many systems to the combination of time()
@@ -0,0 +1,55 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+#include "common/timer.h"
+
+namespace Common {
+
+TimerSchedule::TimerSchedule(uint32 interval, uint32 now) :
+	_interval(interval),
+	_nextFireTime(now + interval / 1000),
+	_nextFireTimeMicro(interval % 1000) {
+}
+
+void TimerSchedule::fire(uint32 now) {
+	// How late this invocation is, compared to the exact due time
+	const int64 lateness = (int64)((int32)(now - _nextFireTime)) * 1000 - _nextFireTimeMicro;
+	const uint32 late = lateness > 0 ? (uint32)lateness : 0;
+
+	_stats.fired++;
+	_stats.totalLateness += late;
+	if (late > _stats.maxLateness)
+		_stats.maxLateness = late;
+	if (late >= _interval)
+		_stats.late++;
+
+	// Move on from the due time, not from now, so that late invocations
+	// are caught up with
+	_nextFireTime += _interval / 1000;
+	_nextFireTimeMicro += _interval % 1000;
+	if (_nextFireTimeMicro >= 1000) {
+		_nextFireTime += _nextFireTimeMicro / 1000;
+		_nextFireTimeMicro %= 1000;
+	}
+}
+
+} // End of namespace Common
@@ -28,6 +28,49 @@
 
 namespace Common {
 
+/** Timing statistics of an installed timer. */
+struct TimerStats {
+	uint32 fired;         ///< Number of invocations
+	uint32 late;          ///< Number of invocations that were a whole interval or more late
+	uint32 maxLateness;   ///< Largest delay of an invocation after its due time, in microseconds
+	uint64 totalLateness; ///< Sum of the delays of all invocations, in microseconds
+
+	TimerStats() : fired(0), late(0), maxLateness(0), totalLateness(0) {}
+};
+
+/**
+ * The fire times of a timer, and the statistics of its invocations.
+ *
+ * The interval is given in microseconds, while the clock is in
+ * milliseconds, so the fire time keeps a microsecond remainder to not
+ * drift over time.
+ */
+class TimerSchedule {
+public:
+	TimerSchedule(uint32 interval, uint32 now);
+
+	uint32 getInterval() const { return _interval; }
+	uint32 getNextFireTime() const { return _nextFireTime; }
+
+	/** Is the timer due at the given time? */
+	bool isDue(uint32 now) const { return _nextFireTime < now; }
+
+	/** Return the number of milliseconds from now until the timer is due. */
+	uint32 getDelay(uint32 now) const { return isDue(now) ? 0 : _nextFireTime + 1 - now; }
+
+	/** Record an invocation at the given time, and move on to the next fire time. */
+	void fire(uint32 now);
+
+	const TimerStats &getStats() const { return _stats; }
+
+private:
+	uint32 _interval;          ///< in microseconds
+	uint32 _nextFireTime;      ///< in milliseconds
+	uint32 _nextFireTimeMicro; ///< microseconds part of nextFire
+
+	TimerStats _stats;
+};
+
 class TimerManager : NonCopyable {
 public:
 	typedef void (*TimerProc)(void *refCon);
@@ -49,11 +92,32 @@ public:
 	 */
 	virtual bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) = 0;
 
+	/**
+	 * Install a new timer callback, like installTimerProc(), that runs isolated
+	 * from the other timers where the backend supports it. It is then invoked
+	 * on its own thread: a slow isolated callback does not delay the other
+	 * timers, nor is it delayed by them.
+	 *
+	 * An isolated timer must not remove itself from its own callback.
+	 */
+	virtual bool installIsolatedTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) {
+		return installTimerProc(proc, interval, refCon, id);
+	}
+
 	/**
 	 * Remove the given timer callback. It will not be invoked anymore,
 	 * and no instance of this callback will be running anymore.
 	 */
 	virtual void removeTimerProc(TimerProc proc) = 0;
+
+	/**
+	 * Get the timing statistics of the given timer callback.
+	 *
+	 * @return	true if the timer is installed and the backend keeps statistics
+	 */
+	virtual bool getTimerStats(TimerProc proc, TimerStats &stats) {
+		return false;
+	}
 };
 
 } // End of namespace Common
@@ -20,12 +20,15 @@
  *
  */
 
+#include "common/profiler.h"
+
 #include "math/line3d.h"
 #include "math/rect2d.h"
 
 #include "engines/grim/debug.h"
 #include "engines/grim/actor.h"
 #include "engines/grim/grim.h"
+#include "engines/grim/colormap.h"
 #include "engines/grim/costume.h"
 #include "engines/grim/lipsync.h"
 #include "engines/grim/movie/movie.h"
@@ -109,6 +112,7 @@ Actor::Actor(const Common::String &actorName) :
 	_sortOrder = 0;
 	_cleanBuffer = 0;
 	_drawnToClean = false;
+	_culled = false;
 	_backgroundTalk = false;
 
 	for (int i = 0; i < MAX_SHADOWS; i++) {
@@ -116,6 +120,7 @@ Actor::Actor(const Common::String &actorName) :
 		_shadowArray[i].dontNegate = false;
 		_shadowArray[i].shadowMask = NULL;
 		_shadowArray[i].shadowMaskSize = 0;
+		_shadowArray[i].userData = NULL;
 	}
 }
 
@@ -140,6 +145,7 @@ Actor::Actor() {
 	_shadowActive = false;
 	_cleanBuffer = 0;
 	_drawnToClean = false;
+	_culled = false;
 	_backgroundTalk = false;
 
 	for (int i = 0; i < MAX_SHADOWS; i++) {
@@ -147,6 +153,7 @@ Actor::Actor() {
 		_shadowArray[i].dontNegate = false;
 		_shadowArray[i].shadowMask = NULL;
 		_shadowArray[i].shadowMaskSize = 0;
+		_shadowArray[i].userData = NULL;
 	}
 }
 
@@ -297,9 +304,10 @@ void Actor::saveState(SaveGame *savedState) const {
 }
 
 bool Actor::restoreState(SaveGame *savedState) {
-	for (Common::List<Costume *>::const_iterator i = _costumeStack.begin(); i != _costumeStack.end(); ++i) {
-		delete *i;
-	}
+	// Keep the current costumes around until the saved ones are restored, so
+	// that the ones which are still worn, with the same colormap, are reused
+	// instead of loaded again
+	Common::List<Costume *> oldCostumes = _costumeStack;
 	_costumeStack.clear();
 
 	// load actor name
@@ -363,11 +371,36 @@ bool Actor::restoreState(SaveGame *savedState) {
 			delete[] names;
 		}
 
-		Costume *c = g_resourceloader->loadCostume(fname, pc);
-		c->restoreState(savedState);
+		Costume *c = NULL;
+		if (g_grim->getGameType() == GType_MONKEY4) {
+			// EMICostume does not save its state yet, so a worn costume
+			// would keep its current state instead of the saved one
+			c = g_resourceloader->loadCostume(fname, pc);
+			c->restoreState(savedState);
+		} else {
+			const Common::String colormap = Costume::readColormapName(savedState);
+			if (!pc) {
+				for (Common::List<Costume *>::iterator j = oldCostumes.begin(); j != oldCostumes.end(); ++j) {
+					CMap *cmap = (*j)->getCMap();
+					Common::String cmapName = cmap ? cmap->getFilename() : Common::String();
+					if ((*j)->getFilename() == fname && !(*j)->getPreviousCostume() && cmapName == colormap) {
+						c = *j;
+						oldCostumes.erase(j);
+						break;
+					}
+				}
+			}
+			if (!c)
+				c = g_resourceloader->loadCostume(fname, pc);
+			c->restoreStateWithColormap(savedState, colormap);
+		}
 		_costumeStack.push_back(c);
 	}
 
+	for (Common::List<Costume *>::const_iterator i = oldCostumes.begin(); i != oldCostumes.end(); ++i) {
+		delete *i;
+	}
+
 	_turning = savedState->readBool();
 	_moveYaw = savedState->readFloat();
 	if (savedState->saveMinorVersion() > 6) {
@@ -1548,7 +1581,55 @@ bool Actor::updateTalk(uint frameTime) {
 	return false;
 }
 
+bool Actor::cull() {
+	_culled = false;
+	if (!g_grim->getCulling() || _costumeStack.empty())
+		return false;
+
+	// The shadows are projected onto planes which may be seen when the
+	// actor is not.
+	for (int l = 0; l < MAX_SHADOWS; l++) {
+		if (_shadowArray[l].active)
+			return false;
+	}
+
+	Math::Vector3d min, max;
+	bool found = false;
+	for (Common::List<Costume *>::iterator i = _costumeStack.begin(); i != _costumeStack.end(); ++i) {
+		// Grim only draws the last costume of the stack.
+		if (g_grim->getGameType() == GType_GRIM && *i != _costumeStack.back())
+			continue;
+
+		Math::Vector3d costumeMin, costumeMax;
+		if (!(*i)->getModelBounds(costumeMin, costumeMax))
+			return false;
+		for (int k = 0; k < 3; k++) {
+			if (!found || costumeMin.getValue(k) < min.getValue(k))
+				min.setValue(k, costumeMin.getValue(k));
+			if (!found || costumeMax.getValue(k) > max.getValue(k))
+				max.setValue(k, costumeMax.getValue(k));
+		}
+		found = true;
+	}
+
+	// The bounds are those of the rest pose, and chores can move the nodes
+	// away from it, so test a sphere twice as large as the one around them.
+	Math::Vector3d center = (min + max) / 2.f;
+	float radius = (max - min).getMagnitude();
+
+	_culled = !g_driver->isActorVisible(getWorldPos(), _scale, getRotationQuat(), _inOverworld, center, radius);
+	return _culled;
+}
+
+void Actor::prepareForRender() {
+	for (Common::List<Costume *>::iterator i = _costumeStack.begin(); i != _costumeStack.end(); ++i) {
+		(*i)->prepareForRender();
+	}
+}
+
 void Actor::draw() {
+	PROFILE_SCOPE("Actor::draw");
+
 	for (Common::List<Costume *>::iterator i = _costumeStack.begin(); i != _costumeStack.end(); ++i) {
 		Costume *c = *i;
 		c->setupTextures();
@@ -1567,7 +1648,7 @@ void Actor::draw() {
 	// FIXME: if isAttached(), factor in the joint rotation as well.
 	Math::Vector3d absPos = getWorldPos();
 	const Math::Quaternion rot = getRotationQuat();
-	if (!_costumeStack.empty()) {
+	if (!_costumeStack.empty() && !_culled) {
 		g_grim->getCurrSet()->setupLights(absPos);
 		if (g_grim->getGameType() == GType_GRIM) {
 			Costume *costume = _costumeStack.back();
@@ -1649,6 +1730,7 @@ void Actor::addShadowPlane(const char *n, Set *scene, int shadowId) {
 		// Naranja is dead, because the scene changes back and forth few times and so
 		// the scenes' sectors are deleted while they are still keeped by the actors.
 		Plane p = { scene->getName(), new Sector(*sector) };
+		g_driver->destroyShadow(&_shadowArray[shadowId]);
 		_shadowArray[shadowId].planeList.push_back(p);
 		g_grim->flagRefreshShadowMask(true);
 	}
@@ -1714,6 +1796,7 @@ void Actor::setShadowPoint(const Math::Vector3d &p) {
 void Actor::clearShadowPlanes() {
 	for (int i = 0; i < MAX_SHADOWS; i++) {
 		Shadow *shadow = &_shadowArray[i];
+		g_driver->destroyShadow(shadow);
 		while (!shadow->planeList.empty()) {
 			delete shadow->planeList.back().sector;
 			shadow->planeList.pop_back();
@@ -2075,6 +2158,7 @@ void Actor::drawToCleanBuffer() {
 	}
 
 	_drawnToClean = true;
+	_culled = false;
 	// clean the buffer before drawing to it
 	g_driver->clearBuffer(_cleanBuffer);
 	g_driver->selectBuffer(_cleanBuffer);
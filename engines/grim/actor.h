@@ -57,6 +57,7 @@ struct Shadow {
 	int shadowMaskSize;
 	bool active;
 	bool dontNegate;
+	void *userData;       // owned by the renderer, see GfxBase::destroyShadow()
 };
 
 /**
@@ -471,6 +472,14 @@ public:
 	 * Check if the actor is still talking. If it is returns true, otherwise false.
 	 */
 	bool updateTalk(uint frameTime);
+	/**
+	 * Test the bounds of the costumes against the view of the current setup,
+	 * and remember for prepareForRender() and draw() whether the actor can
+	 * be skipped. Returns true if it can.
+	 */
+	bool cull();
+	bool isCulled() const { return _culled; }
+	void prepareForRender();
 	void draw();
 
 	bool isLookAtVectorZero() {
@@ -678,6 +687,7 @@ private:
 	bool _shadowActive;
 	int _cleanBuffer;
 	bool _drawnToClean;
+	bool _culled;
 };
 
 } // end of namespace Grim
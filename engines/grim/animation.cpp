@@ -40,6 +40,11 @@ Animation::Animation(const Common::String &keyframe, AnimManager *manager, int p
 	_fade(1.f),
 	_fadeMode(None) {
 	_keyframe = g_resourceloader->getKeyframe(keyframe);
+	if (_keyframe) {
+		_keyframeCursors.resize(_keyframe->getNumJoints());
+		for (uint i = 0; i < _keyframeCursors.size(); i++)
+			_keyframeCursors[i] = 0;
+	}
 }
 
 Animation::~Animation() {
@@ -194,6 +199,8 @@ void Animation::restoreState(SaveGame *state) {
 
 	if (active)
 		activate();
+	else
+		deactivate();
 }
 
 /**
@@ -254,54 +261,97 @@ void AnimManager::removeAnimation(Animation *anim) {
 }
 
 void AnimManager::animate(ModelNode *hier, int numNodes) {
-	// Apply animation to each hierarchy node separately.
+	AnimPose &pose = _pose;
+	pose.resize(numNodes);
+
+	// Whatever the nodes already hold counts as blended before every layer.
 	for (int i = 0; i < numNodes; i++) {
-		Math::Vector3d tempPos;
-		Math::Angle tempYaw = 0.0f, tempPitch = 0.0f, tempRoll = 0.0f;
-		float totalWeight = 0.0f;
-		float remainingWeight = 1.0f;
-		int currPriority = -1;
-
-		// The animations are layered so that animations with a higher priority
-		// are played regardless of the blend weights of lower priority animations.
-		// The highest priority layer gets as much weight as it wants, while the
-		// next layer gets the remaining amount and so on.
-		for (Common::List<AnimationEntry>::iterator j = _activeAnims.begin(); j != _activeAnims.end(); ++j) {
-			if (currPriority != j->_priority) {
-				currPriority = j->_priority;
-				remainingWeight *= 1 - totalWeight;
-				if (remainingWeight <= 0.0f)
-					break;
-
-				float weightFactor = 1.0f;
-				if (totalWeight > 1.0f) {
-					weightFactor = 1.0f / totalWeight;
-				}
-				tempPos += hier[i]._animPos * weightFactor;
-				tempYaw += hier[i]._animYaw * weightFactor;
-				tempPitch += hier[i]._animPitch * weightFactor;
-				tempRoll += hier[i]._animRoll * weightFactor;
-				hier[i]._animPos.set(0, 0, 0);
-				hier[i]._animYaw = 0.0f;
-				hier[i]._animPitch = 0.0f;
-				hier[i]._animRoll = 0.0f;
-				totalWeight = 0.0f;
+		pose._blended[AnimPose::PosX][i] = hier[i]._animPos.x();
+		pose._blended[AnimPose::PosY][i] = hier[i]._animPos.y();
+		pose._blended[AnimPose::PosZ][i] = hier[i]._animPos.z();
+		pose._blended[AnimPose::Pitch][i] = hier[i]._animPitch.getDegrees();
+		pose._blended[AnimPose::Yaw][i] = hier[i]._animYaw.getDegrees();
+		pose._blended[AnimPose::Roll][i] = hier[i]._animRoll.getDegrees();
+		pose._totalWeight[i] = 0.0f;
+		pose._remainingWeight[i] = 1.0f;
+	}
+	for (int c = 0; c < AnimPose::NumChannels; c++) {
+		float *layer = pose._layer[c].begin();
+		for (int i = 0; i < numNodes; i++)
+			layer[i] = 0.0f;
+	}
+
+	// The animations are layered so that animations with a higher priority
+	// are played regardless of the blend weights of lower priority animations.
+	// The highest priority layer gets as much weight as it wants, while the
+	// next layer gets the remaining amount and so on.
+	int currPriority = -1;
+	for (Common::List<AnimationEntry>::iterator j = _activeAnims.begin(); j != _activeAnims.end(); ++j) {
+		if (currPriority != j->_priority) {
+			currPriority = j->_priority;
+			foldLayer();
+		}
+
+		Animation *anim = j->_anim;
+		anim->_keyframe->sample(hier, anim->_time / 1000.0f, j->_tagged, anim->_keyframeCursors.begin(), pose);
+
+		const float fade = anim->_fade;
+		const bool *sampled = pose._sampled.begin();
+		const float *remainingWeight = pose._remainingWeight.begin();
+		float *totalWeight = pose._totalWeight.begin();
+		for (int c = 0; c < AnimPose::NumChannels; c++) {
+			const float *sample = pose._sample[c].begin();
+			float *layer = pose._layer[c].begin();
+			for (int i = 0; i < numNodes; i++) {
+				if (sampled[i])
+					layer[i] += sample[i] * (fade * remainingWeight[i]);
 			}
+		}
+		for (int i = 0; i < numNodes; i++) {
+			if (sampled[i])
+				totalWeight[i] += fade;
+		}
+	}
 
-			float time = j->_anim->_time / 1000.0f;
-			float weight = j->_anim->_fade * remainingWeight;
-			if (j->_anim->_keyframe->animate(hier, i, time, weight, j->_tagged))
-				totalWeight += j->_anim->_fade;
+	for (int i = 0; i < numNodes; i++) {
+		float weightFactor = 1.0f;
+		if (pose._totalWeight[i] > 1.0f) {
+			weightFactor = 1.0f / pose._totalWeight[i];
 		}
+		hier[i]._animPos.set(pose._layer[AnimPose::PosX][i] * weightFactor + pose._blended[AnimPose::PosX][i],
+		                     pose._layer[AnimPose::PosY][i] * weightFactor + pose._blended[AnimPose::PosY][i],
+		                     pose._layer[AnimPose::PosZ][i] * weightFactor + pose._blended[AnimPose::PosZ][i]);
+		hier[i]._animPitch = pose._layer[AnimPose::Pitch][i] * weightFactor + pose._blended[AnimPose::Pitch][i];
+		hier[i]._animYaw = pose._layer[AnimPose::Yaw][i] * weightFactor + pose._blended[AnimPose::Yaw][i];
+		hier[i]._animRoll = pose._layer[AnimPose::Roll][i] * weightFactor + pose._blended[AnimPose::Roll][i];
+	}
+}
+
+// Close the current priority layer: scale it by its total weight, add it to
+// the blended pose and give the next layer what is left of the weight. Nodes
+// with no weight left are not touched anymore.
+void AnimManager::foldLayer() {
+	AnimPose &pose = _pose;
+	const int numNodes = pose._numNodes;
+	float *totalWeight = pose._totalWeight.begin();
+	float *remainingWeight = pose._remainingWeight.begin();
+
+	for (int i = 0; i < numNodes; i++) {
+		if (remainingWeight[i] <= 0.0f)
+			continue;
+		remainingWeight[i] *= 1 - totalWeight[i];
+		if (remainingWeight[i] <= 0.0f)
+			continue;
 
 		float weightFactor = 1.0f;
-		if (totalWeight > 1.0f) {
-			weightFactor = 1.0f / totalWeight;
+		if (totalWeight[i] > 1.0f) {
+			weightFactor = 1.0f / totalWeight[i];
+		}
+		for (int c = 0; c < AnimPose::NumChannels; c++) {
+			pose._blended[c][i] += pose._layer[c][i] * weightFactor;
+			pose._layer[c][i] = 0.0f;
 		}
-		hier[i]._animPos = hier[i]._animPos * weightFactor + tempPos;
-		hier[i]._animYaw = hier[i]._animYaw * weightFactor + tempYaw;
-		hier[i]._animPitch = hier[i]._animPitch * weightFactor + tempPitch;
-		hier[i]._animRoll = hier[i]._animRoll * weightFactor + tempRoll;
+		totalWeight[i] = 0.0f;
 	}
 }
 
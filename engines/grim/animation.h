@@ -23,6 +23,8 @@
 #ifndef GRIM_ANIMATION_H
 #define GRIM_ANIMATION_H
 
+#include "common/array.h"
+
 #include "engines/grim/keyframe.h"
 
 namespace Grim {
@@ -63,6 +65,7 @@ public:
 private:
 	AnimManager *_manager;
 	ObjectPtr<KeyframeAnim> _keyframe;
+	Common::Array<int> _keyframeCursors;
 	int _priority1;
 	int _priority2;
 	bool _paused;
@@ -92,7 +95,10 @@ private:
 		bool _tagged;
 	};
 
+	void foldLayer();
+
 	Common::List<AnimationEntry> _activeAnims;
+	AnimPose _pose;
 };
 
 }
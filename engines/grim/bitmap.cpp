@@ -381,10 +381,12 @@ void Bitmap::saveState(SaveGame *state) const {
 }
 
 void Bitmap::restoreState(SaveGame *state) {
-	freeData();
-
+	// Get the new data before releasing the old one, which is kept if it
+	// is the same
 	Common::String fname = state->readString();
-	_data = BitmapData::getBitmapData(fname);
+	BitmapData *data = BitmapData::getBitmapData(fname);
+	freeData();
+	_data = data;
 
 	_currImage = state->readLESint32();
 }
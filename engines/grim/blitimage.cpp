@@ -0,0 +1,158 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/util.h"
+
+#include "engines/grim/blitimage.h"
+
+namespace Grim {
+
+BlitImage::BlitImage() {
+	_lines = NULL;
+	_last = NULL;
+	_width = 0;
+	_height = 0;
+}
+
+BlitImage::~BlitImage() {
+	Line *temp = _lines;
+	while (temp != NULL) {
+		_lines = temp->next;
+		delete temp;
+		temp = _lines;
+	}
+}
+
+void BlitImage::create(const Graphics::PixelBuffer &buf, uint32 transparency, int x, int y, int width, int height) {
+	Graphics::PixelBuffer srcBuf = buf;
+	_width = width;
+	_height = height;
+	// A line of pixels can not wrap more that one line of the image, since it would break
+	// blitting of bitmaps with a non-zero x position.
+	for (int l = 0; l < height; l++) {
+		int start = -1;
+
+		for (int r = 0; r < width; ++r) {
+			// We found a transparent pixel, so save a line from 'start' to the pixel before this.
+			if (srcBuf.getValueAt(r) == transparency && start >= 0) {
+				newLine(start, l, r - start, srcBuf.getRawBuffer(start));
+
+				start = -1;
+			} else if (srcBuf.getValueAt(r) != transparency && start == -1) {
+				start = r;
+			}
+		}
+		// end of the bitmap line. if start is an actual pixel save the line.
+		if (start >= 0) {
+			newLine(start, l, width - start, srcBuf.getRawBuffer(start));
+		}
+
+		srcBuf.shiftBy(width);
+	}
+}
+
+void BlitImage::newLine(int x, int y, int length, byte *pixels) {
+	if (length < 1) {
+		return;
+	}
+
+	Line *line = new Line;
+
+	line->x = x;
+	line->y = y;
+	line->length = length;
+	line->pixels = pixels;
+	line->next = NULL;
+
+	if (_last) {
+		_last->next = line;
+	}
+	if (!_lines) {
+		_lines = line;
+	}
+	_last = line;
+}
+
+void blitImage(const Graphics::PixelFormat &format, BlitImage *image, byte *dst, int dstWidth, int dstHeight, byte *src,
+               int dstX, int dstY, int srcX, int srcY, int width, int height, int srcWidth, int srcHeight, bool trans) {
+	if (dstX >= dstWidth || dstY >= dstHeight)
+		return;
+
+	int clampWidth, clampHeight;
+
+	if (dstX + width > dstWidth)
+		clampWidth = dstWidth - dstX;
+	else
+		clampWidth = width;
+
+	if (dstY + height > dstHeight)
+		clampHeight = dstHeight - dstY;
+	else
+		clampHeight = height;
+
+	dst += (dstX + (dstY * dstWidth)) * format.bytesPerPixel;
+	src += (srcX + (srcY * srcWidth)) * format.bytesPerPixel;
+
+	Graphics::PixelBuffer srcBuf(format, src);
+	Graphics::PixelBuffer dstBuf(format, dst);
+
+	if (!trans) {
+		for (int l = 0; l < clampHeight; l++) {
+			dstBuf.copyBuffer(0, clampWidth, srcBuf);
+			dstBuf.shiftBy(dstWidth);
+			srcBuf.shiftBy(srcWidth);
+		}
+	} else {
+		if (image) {
+			BlitImage::Line *l = image->_lines;
+			int maxY = srcY + clampHeight;
+			int maxX = srcX + clampWidth;
+			while (l && l->y < srcY)
+				l = l->next;
+
+			while (l && l->y <= maxY) {
+				if (l->x < maxX && l->x + l->length > srcX) {
+					int length = l->length;
+					int skipStart = l->x < srcX ? srcX - l->x : 0;
+					length -= skipStart;
+					int skipEnd   = l->x + l->length > maxX ? l->x + l->length - maxX : 0;
+					length -= skipEnd;
+					memcpy(dstBuf.getRawBuffer((l->y - srcY) * dstWidth + MAX(l->x - srcX, 0)),
+						   l->pixels + skipStart * format.bytesPerPixel, length * format.bytesPerPixel);
+				}
+				l = l->next;
+			}
+		} else {
+			for (int l = 0; l < clampHeight; l++) {
+				for (int r = 0; r < clampWidth; ++r) {
+					if (srcBuf.getValueAt(r) != 0xf81f) {
+						dstBuf.setPixelAt(r, srcBuf);
+					}
+				}
+				dstBuf.shiftBy(dstWidth);
+				srcBuf.shiftBy(srcWidth);
+			}
+		}
+	}
+}
+
+} // end of namespace Grim
@@ -0,0 +1,68 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_BLITIMAGE_H
+#define GRIM_BLITIMAGE_H
+
+#include "graphics/pixelbuffer.h"
+
+namespace Grim {
+
+/**
+ * This class is used for blitting bitmaps with transparent pixels.
+ * Instead of checking every pixel for transparency, it creates a list of 'lines'.
+ * A line is, well, a line of non trasparent pixels, and itstores a pointer to the
+ * first pixel, and the position of it, which can be used to memcpy the entire line
+ * to the destination buffer.
+ */
+class BlitImage {
+public:
+	BlitImage();
+	~BlitImage();
+
+	void create(const Graphics::PixelBuffer &buf, uint32 transparency, int x, int y, int width, int height);
+	void newLine(int x, int y, int length, byte *pixels);
+
+	struct Line {
+		int x;
+		int y;
+		int length;
+		byte *pixels;
+
+		Line *next;
+	};
+	Line *_lines;
+	Line *_last;
+	int _width, _height;
+};
+
+/**
+ * Copy a width x height rectangle at (srcX, srcY) of the srcWidth pixels
+ * wide src to (dstX, dstY) in dst, clipped to dstWidth x dstHeight. With
+ * trans, the 0xf81f pixels are skipped, using the lines of image if given.
+ */
+void blitImage(const Graphics::PixelFormat &format, BlitImage *image, byte *dst, int dstWidth, int dstHeight, byte *src,
+               int dstX, int dstY, int srcX, int srcY, int width, int height, int srcWidth, int srcHeight, bool trans);
+
+} // end of namespace Grim
+
+#endif
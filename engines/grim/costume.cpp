@@ -437,6 +437,33 @@ void Costume::getBoundingBox(int *x1, int *y1, int *x2, int *y2) {
 	}
 }
 
+bool Costume::getModelBounds(Math::Vector3d &min, Math::Vector3d &max) {
+	bool found = false;
+	for (int i = 0; i < _numComponents; i++) {
+		Component *c = _components[i];
+		if (!c)
+			continue;
+		if (c->isComponentType('S','P','R','T'))
+			return false;
+		if (!c->isComponentType('M','M','D','L') && !c->isComponentType('M','O','D','L'))
+			continue;
+
+		Model *model = static_cast<ModelComponent *>(c)->getModel();
+		if (!model)
+			continue;
+		for (int k = 0; k < 3; k++) {
+			float low = model->_bboxPos.getValue(k);
+			float high = low + model->_bboxSize.getValue(k);
+			if (!found || low < min.getValue(k))
+				min.setValue(k, low);
+			if (!found || high > max.getValue(k))
+				max.setValue(k, high);
+		}
+		found = true;
+	}
+	return found;
+}
+
 int Costume::update(uint time) {
 	for (Common::List<Chore*>::iterator i = _playingChores.begin(); i != _playingChores.end(); ++i) {
 		(*i)->update(time);
@@ -531,11 +558,18 @@ void Costume::saveState(SaveGame *state) const {
 	_head->saveState(state);
 }
 
+Common::String Costume::readColormapName(SaveGame *state) {
+	if (state->readBool())
+		return state->readString();
+	return Common::String();
+}
+
 bool Costume::restoreState(SaveGame *state) {
-	if (state->readBool()) {
-		Common::String str = state->readString();
-		setColormap(str);
-	}
+	return restoreStateWithColormap(state, readColormapName(state));
+}
+
+bool Costume::restoreStateWithColormap(SaveGame *state, const Common::String &colormap) {
+	setColormap(colormap);
 
 	for (int i = 0; i < _numChores; ++i) {
 		_chores[i]->restoreState(state);
@@ -551,6 +585,7 @@ bool Costume::restoreState(SaveGame *state) {
 		}
 	}
 
+	_playingChores.clear();
 	int numPlayingChores = state->readLEUint32();
 	for (int i = 0; i < numPlayingChores; ++i) {
 		int id = state->readLESint32();
@@ -81,8 +81,19 @@ public:
 	virtual int update(uint frameTime);
 	void animate();
 	void setupTextures();
+	/**
+	 * Does the work of draw() that is independent of the renderer, such
+	 * as skinning the models.
+	 */
+	virtual void prepareForRender() { }
 	virtual void draw();
 	void getBoundingBox(int *x1, int *y1, int *x2, int *y2);
+	/**
+	 * Get the box around the models of the costume in their rest pose, in
+	 * the model space of the actor. Returns false if the costume draws
+	 * something whose extent is unknown, or nothing at all.
+	 */
+	virtual bool getModelBounds(Math::Vector3d &min, Math::Vector3d &max);
 	void setPosRotate(const Math::Vector3d &pos, const Math::Angle &pitch,
 					  const Math::Angle &yaw, const Math::Angle &roll);
 	Math::Matrix4 getMatrix() const;
@@ -91,6 +102,14 @@ public:
 
 	virtual void saveState(SaveGame *state) const;
 	virtual bool restoreState(SaveGame *state);
+	/**
+	 * Restore the state in two steps: first read the colormap name that
+	 * saveState() writes first, which is empty if there was none, then
+	 * the rest of the state. In between, the caller can look for a
+	 * costume that already has that colormap.
+	 */
+	static Common::String readColormapName(SaveGame *state);
+	bool restoreStateWithColormap(SaveGame *state, const Common::String &colormap);
 
 	Component *getComponent(int num) { return _components[num]; }
 protected:
@@ -45,11 +45,9 @@ void Head::Joint::orientTowards(bool entering, const Math::Vector3d &point, floa
 		return;
 
 	// Make sure we have up-to-date world transform matrices computed for the joint nodes of this character.
-	_node->_needsUpdate = true;
 	ModelNode *p = _node;
 	while (p->_parent) {
 		p = p->_parent;
-		p->_needsUpdate = true;
 	}
 	p->setMatrix(matrix);
 	p->update();
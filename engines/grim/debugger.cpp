@@ -31,6 +31,7 @@ Debugger::Debugger()
 
 	DCmd_Register("check_gamedata", WRAP_METHOD(Debugger, cmd_checkFiles));
 	DCmd_Register("lua_do", WRAP_METHOD(Debugger, cmd_lua_do));
+	DCmd_Register("cull", WRAP_METHOD(Debugger, cmd_cull));
 }
 
 Debugger::~Debugger() {
@@ -63,4 +64,19 @@ bool Debugger::cmd_lua_do(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmd_cull(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "on") != 0 && strcmp(argv[1], "off") != 0)) {
+		DebugPrintf("Usage: cull [on|off]\n");
+		return true;
+	}
+
+	if (argc == 2)
+		g_grim->setCulling(strcmp(argv[1], "on") == 0);
+
+	const GrimEngine::CullStats &stats = g_grim->getCullStats();
+	DebugPrintf("Actor culling is %s.\n", g_grim->getCulling() ? "on" : "off");
+	DebugPrintf("Last frame: %u visible actors tested, %u culled.\n", stats._tested, stats._culled);
+	return true;
+}
+
 }
@@ -34,6 +34,7 @@ public:
 
 	bool cmd_checkFiles(int argc, const char **argv);
 	bool cmd_lua_do(int argc, const char **argv);
+	bool cmd_cull(int argc, const char **argv);
 };
 
 }
@@ -0,0 +1,41 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/algorithm.h"
+
+#include "engines/grim/draw_bucket.h"
+
+namespace Grim {
+
+void DrawBucket::add(Pass pass, uint32 state, uint32 index) {
+	// Blended draws must stay in order, so only the index sorts them.
+	if (pass == kPassBlended)
+		state = 0;
+	uint64 key = ((uint64)pass << 63) | ((uint64)(state & 0x7fffffff) << 32) | index;
+	_keys.push_back(key);
+}
+
+void DrawBucket::sort() {
+	Common::sort(_keys.begin(), _keys.end());
+}
+
+} // end of namespace Grim
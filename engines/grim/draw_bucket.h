@@ -0,0 +1,61 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_DRAW_BUCKET_H
+#define GRIM_DRAW_BUCKET_H
+
+#include "common/array.h"
+
+namespace Grim {
+
+/**
+ * Collects the draws of the faces of a model, each with a key made of its
+ * render pass and render state (material, lighting or blending), and gives
+ * them back sorted so that the renderer only has to change state between
+ * runs of faces that share a key. Opaque draws are grouped by state,
+ * blended ones keep the order they were added in and come last.
+ */
+class DrawBucket {
+public:
+	enum Pass {
+		kPassOpaque = 0,
+		kPassBlended = 1
+	};
+
+	void clear() { _keys.clear(); }
+	/**
+	 * Record the draw of the face index. Only the lower 31 bits of state
+	 * are used.
+	 */
+	void add(Pass pass, uint32 state, uint32 index);
+	void sort();
+
+	uint size() const { return _keys.size(); }
+	uint32 getIndex(uint i) const { return (uint32)(_keys[i] & 0xffffffff); }
+
+private:
+	Common::Array<uint64> _keys;
+};
+
+} // end of namespace Grim
+
+#endif
@@ -53,6 +53,24 @@ AnimationEmi::~AnimationEmi() {
 
 void AnimationEmi::reset() {
 	_time = 0.0f;
+	for (int i = 0; i < _numBones; i++)
+		_bones[i]._keyframeCursor = 0;
+}
+
+void AnimationEmi::bindSkeleton(Skeleton *skel) {
+	_skeleton = skel;
+	for (int i = 0; i < _numBones; i++)
+		_bones[i]._target = skel->getJointNamed(_bones[i]._boneName);
+}
+
+// Returns the index of the first keyframe at or after time, or 0 if there
+// is none. The time only moves forward until reset(), so the keyframes
+// before the cursor were already passed and the search resumes there.
+template<class T>
+static int findKeyframe(const T *keyframes, int count, float time, int &cursor) {
+	while (cursor < count && keyframes[cursor]._time < time)
+		cursor++;
+	return cursor < count ? cursor : 0;
 }
 
 void AnimationEmi::animate(Skeleton *skel, float delta) {
@@ -61,25 +79,18 @@ void AnimationEmi::animate(Skeleton *skel, float delta) {
 		_time = _duration;
 	}
 
+	if (skel != _skeleton)
+		bindSkeleton(skel);
+
 	for (int bone = 0; bone < _numBones; ++bone) {
 		Bone &curBone = _bones[bone];
-		if (!curBone._target)
-			curBone._target = skel->getJointNamed(curBone._boneName);
-
 		Math::Matrix4 &relFinal = curBone._target->_finalMatrix;
 
 		if (curBone._rotations) {
-			int keyfIdx = 0;
+			int keyfIdx = findKeyframe(curBone._rotations, curBone._count, _time, curBone._keyframeCursor);
 			Math::Quaternion quat;
 			Math::Vector3d relPos = relFinal.getPosition();
 
-			for (int curKeyFrame = 0; curKeyFrame < curBone._count; curKeyFrame++) {
-				if (curBone._rotations[curKeyFrame]._time >= _time) {
-					keyfIdx = curKeyFrame;
-					break;
-				}
-			}
-
 			if (keyfIdx == 0) {
 				quat = curBone._rotations[keyfIdx]._quat;
 			} else if (keyfIdx == curBone._count - 1) {
@@ -96,16 +107,9 @@ void AnimationEmi::animate(Skeleton *skel, float delta) {
 		}
 
 		if (curBone._translations) {
-			int keyfIdx = 0;
+			int keyfIdx = findKeyframe(curBone._translations, curBone._count, _time, curBone._keyframeCursor);
 			Math::Vector3d vec;
 
-			for (int curKeyFrame = 0; curKeyFrame < curBone._count; curKeyFrame++) {
-				if (curBone._translations[curKeyFrame]._time >= _time) {
-					keyfIdx = curKeyFrame;
-					break;
-				}
-			}
-
 			if (keyfIdx == 0) {
 				vec = curBone._translations[keyfIdx]._vec;
 			} else if (keyfIdx == curBone._count - 1) {
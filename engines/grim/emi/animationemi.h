@@ -50,7 +50,8 @@ struct Bone {
 	AnimRotation *_rotations;
 	AnimTranslation *_translations;
 	Joint *_target;
-	Bone() : _rotations(NULL), _translations(NULL), _boneName(""), _operation(0), _target(NULL) {}
+	int _keyframeCursor;  // where the search for the current keyframe starts
+	Bone() : _rotations(NULL), _translations(NULL), _boneName(""), _operation(0), _target(NULL), _keyframeCursor(0) {}
 	~Bone();
 	void loadBinary(Common::SeekableReadStream *data);
 };
@@ -63,9 +64,11 @@ public:
 	int _numBones;
 	Bone *_bones;
 	float _time;
-	AnimationEmi(const Common::String &filename, Common::SeekableReadStream *data) : _name(""), _duration(0.0f), _numBones(0), _bones(NULL), _time(0.0f) { loadAnimation(data); }
+	Skeleton *_skeleton;  // skeleton the bones are bound to
+	AnimationEmi(const Common::String &filename, Common::SeekableReadStream *data) : _name(""), _duration(0.0f), _numBones(0), _bones(NULL), _time(0.0f), _skeleton(NULL) { loadAnimation(data); }
 	~AnimationEmi();
 
+	void bindSkeleton(Skeleton *skel);
 	void animate(Skeleton *skel, float delta);
 	void reset();
 };
@@ -65,6 +65,12 @@ void EMIMeshComponent::reset() {
 	_visible = true;
 }
 
+void EMIMeshComponent::prepareForRender() {
+	if ((_parent && _parent->isVisible()) || !_obj)
+		return;
+	_obj->prepareForRender();
+}
+
 void EMIMeshComponent::draw() {
 	// If the object was drawn by being a component
 	// of it's parent then don't draw it
@@ -36,6 +36,7 @@ public:
 	void init();
 	int update(uint time);
 	void reset();
+	void prepareForRender();
 	void draw();
 
 public:
@@ -187,6 +187,25 @@ Component *EMICostume::loadEMIComponent(Component *parent, int parentID, const c
 	return NULL;
 }
 
+void EMICostume::prepareForRender() {
+	// the meshes that draw() draws
+	bool hasMesh = false;
+	for (Common::List<Chore*>::iterator it = _playingChores.begin(); it != _playingChores.end(); ++it) {
+		Chore *c = (*it);
+		for (int i = 0; i < c->_numTracks; ++i) {
+			Component *component = c->_tracks[i].component;
+			if (component && component->isComponentType('m', 'e', 's', 'h')) {
+				static_cast<EMIMeshComponent *>(component)->prepareForRender();
+				hasMesh = true;
+			}
+		}
+	}
+
+	if (_emiMesh && !hasMesh) {
+		_emiMesh->prepareForRender();
+	}
+}
+
 void EMICostume::draw() {
 	bool drewMesh = false;
 	for (Common::List<Chore*>::iterator it = _playingChores.begin(); it != _playingChores.end(); ++it) {
@@ -205,6 +224,33 @@ void EMICostume::draw() {
 	}
 }
 
+bool EMICostume::getModelBounds(Math::Vector3d &min, Math::Vector3d &max) {
+	bool found = false;
+	for (int i = 0; i < _numComponents; i++) {
+		Component *c = _components[i];
+		if (!c)
+			continue;
+		if (c->isComponentType('s', 'p', 'r', 't'))
+			return false;
+		if (!c->isComponentType('m', 'e', 's', 'h'))
+			continue;
+
+		EMIModel *model = static_cast<EMIMeshComponent *>(c)->_obj;
+		if (!model)
+			continue;
+		for (int k = 0; k < 3; k++) {
+			float low = model->_bboxPos.getValue(k);
+			float high = low + model->_bboxSize.getValue(k);
+			if (!found || low < min.getValue(k))
+				min.setValue(k, low);
+			if (!found || high > max.getValue(k))
+				max.setValue(k, high);
+		}
+		found = true;
+	}
+	return found;
+}
+
 int EMICostume::update(uint time) {
 	if (_emiSkel)
 		_emiSkel->reset();
@@ -43,7 +43,9 @@ public:
 	void load(Common::SeekableReadStream *data);
 
 	int update(uint frameTime);
+	void prepareForRender();
 	void draw();
+	bool getModelBounds(Math::Vector3d &min, Math::Vector3d &max);
 
 	void saveState(SaveGame *state) const;
 	bool restoreState(SaveGame *state);
@@ -21,6 +21,7 @@
  */
 
 #include "common/foreach.h"
+#include "common/profiler.h"
 
 #include "engines/grim/emi/emi.h"
 #include "engines/grim/emi/lua_v2.h"
@@ -59,6 +60,7 @@ Common::List<TextObject *> *EMIEngine::popText() {
 }
 
 void EMIEngine::drawNormalMode() {
+	PROFILE_SCOPE("drawNormalMode");
 
 	// Draw Primitives
 	foreach (PrimitiveObject *p, PrimitiveObject::getPool()) {
@@ -77,6 +79,12 @@ void EMIEngine::drawNormalMode() {
 	// Draw actors
 	buildActiveActorsList();
 	sortActiveActorsList();
+	cullActors();
+	// Skin all the models first, like GrimEngine::drawNormalMode() does
+	foreach (Actor *a, _activeActors) {
+		if (a->isVisible() && !a->isCulled())
+			a->prepareForRender();
+	}
 
 	Bitmap *background = _currSet->getCurrSetup()->_bkgndBm;
 	background->_data->load();
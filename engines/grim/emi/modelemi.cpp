@@ -30,8 +30,67 @@
 #include "engines/grim/emi/animationemi.h"
 #include "engines/grim/emi/skeleton.h"
 
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MODELEMI_SSE
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MODELEMI_NEON
+#endif
+
 namespace Grim {
 
+// Transforms count packed xyz positions, and the matching normals without
+// the translation, by the joint matrix m. The joints only rotate and
+// translate, so the normals do not need the inverse transpose. The sums
+// are done in the same order as Math::Matrix4::transform().
+static void skinVertices(const float *m, const float *pos, const float *normals,
+                         float *drawPos, float *drawNormals, int count) {
+#if defined(MODELEMI_SSE)
+	const __m128 c0 = _mm_setr_ps(m[0], m[4], m[8], m[12]);
+	const __m128 c1 = _mm_setr_ps(m[1], m[5], m[9], m[13]);
+	const __m128 c2 = _mm_setr_ps(m[2], m[6], m[10], m[14]);
+	const __m128 c3 = _mm_setr_ps(m[3], m[7], m[11], m[15]);
+	for (int i = 0; i < count * 3; i += 3) {
+		__m128 p = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(pos[i])), _mm_mul_ps(c1, _mm_set1_ps(pos[i + 1])));
+		p = _mm_add_ps(_mm_add_ps(p, _mm_mul_ps(c2, _mm_set1_ps(pos[i + 2]))), c3);
+		__m128 n = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(normals[i])), _mm_mul_ps(c1, _mm_set1_ps(normals[i + 1])));
+		n = _mm_add_ps(n, _mm_mul_ps(c2, _mm_set1_ps(normals[i + 2])));
+
+		_mm_storel_pi((__m64 *)(drawPos + i), p);
+		_mm_store_ss(drawPos + i + 2, _mm_movehl_ps(p, p));
+		_mm_storel_pi((__m64 *)(drawNormals + i), n);
+		_mm_store_ss(drawNormals + i + 2, _mm_movehl_ps(n, n));
+	}
+#elif defined(MODELEMI_NEON)
+	const float c[16] = {
+		m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13],
+		m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]
+	};
+	const float32x4_t c0 = vld1q_f32(c), c1 = vld1q_f32(c + 4);
+	const float32x4_t c2 = vld1q_f32(c + 8), c3 = vld1q_f32(c + 12);
+	for (int i = 0; i < count * 3; i += 3) {
+		float32x4_t p = vaddq_f32(vmulq_n_f32(c0, pos[i]), vmulq_n_f32(c1, pos[i + 1]));
+		p = vaddq_f32(vaddq_f32(p, vmulq_n_f32(c2, pos[i + 2])), c3);
+		float32x4_t n = vaddq_f32(vmulq_n_f32(c0, normals[i]), vmulq_n_f32(c1, normals[i + 1]));
+		n = vaddq_f32(n, vmulq_n_f32(c2, normals[i + 2]));
+
+		vst1_f32(drawPos + i, vget_low_f32(p));
+		vst1q_lane_f32(drawPos + i + 2, p, 2);
+		vst1_f32(drawNormals + i, vget_low_f32(n));
+		vst1q_lane_f32(drawNormals + i + 2, n, 2);
+	}
+#else
+	for (int i = 0; i < count * 3; i += 3) {
+		for (int row = 0; row < 3; row++) {
+			const float *r = m + row * 4;
+			drawPos[i + row] = r[0] * pos[i] + r[1] * pos[i + 1] + r[2] * pos[i + 2] + r[3];
+			drawNormals[i + row] = r[0] * normals[i] + r[1] * normals[i + 1] + r[2] * normals[i + 2];
+		}
+	}
+#endif
+}
+
 struct Vector3int {
 	int _x;
 	int _y;
@@ -130,14 +189,24 @@ void EMIModel::loadMesh(Common::SeekableReadStream *data) {
 	// Vertices
 	_vertices = new Math::Vector3d[_numVertices];
 	_drawVertices = new Math::Vector3d[_numVertices];
+	Math::Vector3d max;
 	for (int i = 0; i < _numVertices; i++) {
 		_vertices[i].readFromStream(data);
 		_drawVertices[i] = _vertices[i];
+		for (int k = 0; k < 3; k++) {
+			if (i == 0 || _vertices[i].getValue(k) < _bboxPos.getValue(k))
+				_bboxPos.setValue(k, _vertices[i].getValue(k));
+			if (i == 0 || _vertices[i].getValue(k) > max.getValue(k))
+				max.setValue(k, _vertices[i].getValue(k));
+		}
 	}
+	_bboxSize = max - _bboxPos;
 	_normals = new Math::Vector3d[_numVertices];
+	_drawNormals = new Math::Vector3d[_numVertices];
 	if (type != 18) {
 		for (int i = 0; i < _numVertices; i++) {
 			_normals[i].readFromStream(data);
+			_drawNormals[i] = _normals[i];
 		}
 	}
 	_colorMap = new EMIColormap[_numVertices];
@@ -218,25 +287,47 @@ void EMIModel::setSkeleton(Skeleton *skel) {
 
 	Math::Vector3d vertex;
 	Math::Matrix4 mat;
+	_skinRuns.clear();
 	for (int i = 0; i < _numVertices; i++) {
+		int joint = _vertexBoneInfo[_vertexBone[i]];
 		vertex = _vertices[i];
-		if (_vertexBoneInfo[_vertexBone[i]] != -1) {
-			mat = _skeleton->_joints[_vertexBoneInfo[_vertexBone[i]]]._absMatrix;
+		if (joint != -1) {
+			mat = _skeleton->_joints[joint]._absMatrix;
 			mat.inverseTranslate(&vertex);
 			mat.inverseRotate(&vertex);
+			mat.inverseRotate(&_normals[i]);
 		}
 		_vertices[i] = vertex;
+
+		if (_skinRuns.empty() || _skinRuns.back()._joint != joint) {
+			EMISkinRun run = { joint, i, 0 };
+			_skinRuns.push_back(run);
+		}
+		_skinRuns.back()._count++;
 	}
+	_skinGeneration = 0;
 }
 
 void EMIModel::prepareForRender() {
-	if (!_skeleton || !_vertexBoneInfo)
+	if (!_skeleton || !_vertexBoneInfo || _skinGeneration == _skeleton->getGeneration())
 		return;
-	for (int i = 0; i < _numVertices; i++) {
-		_drawVertices[i] = _vertices[i];
-		int animIndex = _vertexBoneInfo[_vertexBone[i]];
-		_skeleton->_joints[animIndex]._finalMatrix.transform(_drawVertices + i, true);
+
+	for (uint i = 0; i < _skinRuns.size(); i++) {
+		const EMISkinRun &run = _skinRuns[i];
+		const float *pos = _vertices[run._first].getData();
+		const float *normals = _normals[run._first].getData();
+		float *drawPos = _drawVertices[run._first].getData();
+		float *drawNormals = _drawNormals[run._first].getData();
+
+		if (run._joint == -1) {
+			memcpy(drawPos, pos, run._count * 3 * sizeof(float));
+			memcpy(drawNormals, normals, run._count * 3 * sizeof(float));
+		} else {
+			skinVertices(_skeleton->_joints[run._joint]._finalMatrix.getData(), pos, normals,
+			             drawPos, drawNormals, run._count);
+		}
 	}
+	_skinGeneration = _skeleton->getGeneration();
 }
 
 void EMIModel::prepareTextures() {
@@ -250,14 +341,41 @@ void EMIModel::prepareTextures() {
 	}
 }
 
+bool EMIModel::hasAlpha(uint32 index) const {
+	if (index >= _numTextures || !_mats[index])
+		return false;
+	const Material *material = _mats[index];
+	return material->getData()->_textures[material->getActiveTexture()]._hasAlpha;
+}
+
 void EMIModel::draw() {
 	prepareForRender();
-	// We will need to add a call to the skeleton, to get the modified vertices, but for now,
-	// I'll be happy with just static drawing
+
+	// Draw the opaque faces grouped by texture, then the ones with alpha in
+	// the order of the model. The textures with alpha change the blending
+	// state, so they must come last anyway.
+	_drawOrder.clear();
 	for (uint32 i = 0; i < _numFaces; i++) {
-		setTex(_faces[i]._texID);
-		g_driver->drawEMIModelFace(this, &_faces[i]);
+		const EMIMeshFace &face = _faces[i];
+		DrawBucket::Pass pass = hasAlpha(face._texID) ? DrawBucket::kPassBlended : DrawBucket::kPassOpaque;
+		_drawOrder.add(pass, (face._texID << 1) | (face._hasTexture ? 1 : 0), i);
+	}
+	_drawOrder.sort();
+
+	GfxBase::RenderStats &stats = g_driver->getFrameStats();
+	int texID = -1;
+	g_driver->startEMIModelDraw(this);
+	for (uint i = 0; i < _drawOrder.size(); i++) {
+		const EMIMeshFace &face = _faces[_drawOrder.getIndex(i)];
+		if ((int)face._texID != texID) {
+			setTex(face._texID);
+			texID = face._texID;
+			stats._materialChanges++;
+		}
+		g_driver->drawEMIModelFace(this, &face);
+		stats._draws++;
 	}
+	g_driver->finishEMIModelDraw();
 }
 
 EMIModel::EMIModel(const Common::String &filename, Common::SeekableReadStream *data, EMIModel *parent) : _fname(filename) {
@@ -265,6 +383,7 @@ EMIModel::EMIModel(const Common::String &filename, Common::SeekableReadStream *d
 	_vertices = NULL;
 	_drawVertices = NULL;
 	_normals = NULL;
+	_drawNormals = NULL;
 	_colorMap = NULL;
 	_texVerts = NULL;
 	_numFaces = 0;
@@ -278,6 +397,7 @@ EMIModel::EMIModel(const Common::String &filename, Common::SeekableReadStream *d
 	_vertexBoneInfo = NULL;
 	_vertexBone = NULL;
 	_skeleton = NULL;
+	_skinGeneration = 0;
 	_sphereData = new Math::Vector4d();
 	_boxData = new Math::Vector3d();
 	_boxData2 = new Math::Vector3d();
@@ -292,6 +412,7 @@ EMIModel::~EMIModel() {
 	delete[] _vertices;
 	delete[] _drawVertices;
 	delete[] _normals;
+	delete[] _drawNormals;
 	delete[] _colorMap;
 	delete[] _texVerts;
 	delete[] _faces;
@@ -23,7 +23,10 @@
 #ifndef GRIM_MODELEMI_H
 #define GRIM_MODELEMI_H
 
+#include "common/array.h"
+
 #include "engines/grim/object.h"
+#include "engines/grim/draw_bucket.h"
 #include "math/matrix4.h"
 #include "math/vector2d.h"
 #include "math/vector3d.h"
@@ -66,6 +69,13 @@ public:
 	void render();
 };
 
+// Consecutive vertices attached to the same joint
+struct EMISkinRun {
+	int _joint;
+	int _first;
+	int _count;
+};
+
 /* TODO: Remember to credit JohnDoe for his EMIMeshViewer, as most of the Skeletal
  * math, and understandings comes from his Delphi-code.
  */
@@ -75,6 +85,7 @@ public:
 	Math::Vector3d *_vertices;
 	Math::Vector3d *_drawVertices;
 	Math::Vector3d *_normals;
+	Math::Vector3d *_drawNormals;
 	EMIColormap *_colorMap;
 	Math::Vector2d *_texVerts;
 
@@ -94,6 +105,10 @@ public:
 	Common::String *_boneNames;
 	int *_vertexBoneInfo;
 	int *_vertexBone;
+	Common::Array<EMISkinRun> _skinRuns;
+	uint32 _skinGeneration;   // skeleton generation of _drawVertices
+	Math::Vector3d _bboxPos;    // bounds of the vertices in the bind pose
+	Math::Vector3d _bboxSize;
 
 	// Stuff we dont know how to use:
 	Math::Vector4d *_sphereData;
@@ -103,6 +118,8 @@ public:
 	int _setType;
 
 	Common::String _fname;
+	// The faces in the order of the last draw()
+	DrawBucket _drawOrder;
 public:
 	EMIModel(const Common::String &filename, Common::SeekableReadStream *data, EMIModel *parent = NULL);
 	~EMIModel();
@@ -111,6 +128,7 @@ public:
 	void loadMesh(Common::SeekableReadStream *data);
 	void prepareForRender();
 	void prepareTextures();
+	bool hasAlpha(uint32 index) const;
 	void draw();
 };
 
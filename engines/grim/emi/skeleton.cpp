@@ -33,7 +33,7 @@ namespace Grim {
 #define ROTATE_OP 4
 #define TRANSLATE_OP 3
 
-Skeleton::Skeleton(const Common::String &filename, Common::SeekableReadStream *data) {
+Skeleton::Skeleton(const Common::String &filename, Common::SeekableReadStream *data) : _generation(1) {
 	loadSkeleton(data);
 }
 
@@ -57,6 +57,8 @@ void Skeleton::loadSkeleton(Common::SeekableReadStream *data) {
 		_joints[i]._quat.readFromStream(data);
 
 		_joints[i]._parentIndex = findJointIndex(_joints[i]._parent, i);
+		if (!_jointIndices.contains(_joints[i]._name))
+			_jointIndices[_joints[i]._name] = i;
 	}
 	initBones();
 	resetAnim();
@@ -90,22 +92,26 @@ void Skeleton::resetAnim() {
 }
 
 void Skeleton::commitAnim() {
+	bool moved = false;
 	for (int m = 0; m < _numJoints; ++m) {
-		const Joint *parent = getParentJoint(&_joints[m]);
+		Joint &joint = _joints[m];
+		const Joint *parent = getParentJoint(&joint);
 		if (parent) {
-			_joints[m]._finalMatrix = parent->_finalMatrix * _joints[m]._finalMatrix;
+			joint._finalMatrix = parent->_finalMatrix * joint._finalMatrix;
+		}
+		if (!(joint._finalMatrix == joint._committedMatrix)) {
+			joint._committedMatrix = joint._finalMatrix;
+			moved = true;
 		}
 	}
+	if (moved)
+		++_generation;
 }
 
 int Skeleton::findJointIndex(const Common::String &name, int max) const {
-	if (_numJoints > 0) {
-		for (int i = 0; i < max; i++) {
-			if (!_joints[i]._name.compareToIgnoreCase(name)) {
-				return i;
-			}
-		}
-	}
+	JointIndexMap::const_iterator it = _jointIndices.find(name);
+	if (it != _jointIndices.end() && it->_value < max)
+		return it->_value;
 	return -1;
 }
 
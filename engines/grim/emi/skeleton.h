@@ -23,6 +23,9 @@
 #ifndef GRIM_SKELETON_H
 #define GRIM_SKELETON_H
 
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+
 #include "math/mathfwd.h"
 #include "math/quat.h"
 #include "engines/grim/object.h"
@@ -47,6 +50,7 @@ struct Joint {
 	Math::Matrix4 _absMatrix;
 	Math::Matrix4 _relMatrix;
 	Math::Matrix4 _finalMatrix;
+	Math::Matrix4 _committedMatrix;
 };
 
 class Skeleton : public Object {
@@ -54,6 +58,11 @@ class Skeleton : public Object {
 	void loadSkeleton(Common::SeekableReadStream *data);
 	void initBone(int index);
 	void initBones();
+
+	uint32 _generation;
+	// index of the first joint with each name
+	typedef Common::HashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> JointIndexMap;
+	JointIndexMap _jointIndices;
 public:
 	int _numJoints;
 	Joint *_joints;
@@ -62,6 +71,11 @@ public:
 	~Skeleton();
 	void commitAnim();
 	void resetAnim();
+	/**
+	 * Changes every time commitAnim() moves a joint, so that the models
+	 * using the skeleton can tell if they have to be skinned again.
+	 */
+	uint32 getGeneration() const { return _generation; }
 	int findJointIndex(const Common::String &name, int max) const;
 	bool hasJoint(const Common::String &name) const;
 	Joint *getJointNamed(const Common::String &name) const;
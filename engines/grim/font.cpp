@@ -146,6 +146,10 @@ void Font::restoreState(SaveGame *state) {
 	Common::String fname = state->readString();
 	Common::SeekableReadStream *stream;
 
+	// The font has no state besides its data
+	if (_fontData && fname == getFilename())
+		return;
+
 	g_driver->destroyFont(this);
 	delete[] _fontData;
 	_fontData = NULL;
@@ -20,8 +20,11 @@
  *
  */
 
+#include "math/frustum.h"
+
 #include "engines/grim/gfx_base.h"
 #include "engines/grim/savegame.h"
+#include "engines/grim/grim.h"
 
 namespace Grim {
 
@@ -35,6 +38,121 @@ GfxBase::GfxBase() :
 
 }
 
+// The matrices below are built like the OpenGL calls named next to them.
+
+// glFrustum()
+static Math::Matrix4 makeFrustumMatrix(float left, float right, float bottom, float top, float nclip, float fclip) {
+	Math::Matrix4 m;
+	m(0, 0) = 2 * nclip / (right - left);
+	m(0, 2) = (right + left) / (right - left);
+	m(1, 1) = 2 * nclip / (top - bottom);
+	m(1, 2) = (top + bottom) / (top - bottom);
+	m(2, 2) = -(fclip + nclip) / (fclip - nclip);
+	m(2, 3) = -2 * fclip * nclip / (fclip - nclip);
+	m(3, 2) = -1;
+	m(3, 3) = 0;
+	return m;
+}
+
+// glScalef()
+static Math::Matrix4 makeScaleMatrix(float x, float y, float z) {
+	Math::Matrix4 m;
+	m(0, 0) = x;
+	m(1, 1) = y;
+	m(2, 2) = z;
+	return m;
+}
+
+// glTranslatef()
+static Math::Matrix4 makeTranslationMatrix(const Math::Vector3d &v) {
+	Math::Matrix4 m;
+	m.setPosition(v);
+	return m;
+}
+
+// glRotatef(roll, 0, 0, -1)
+static Math::Matrix4 makeRollMatrix(float roll) {
+	float angle = -roll * (LOCAL_PI / 180);
+	Math::Matrix4 m;
+	m(0, 0) = cos(angle);
+	m(0, 1) = -sin(angle);
+	m(1, 0) = sin(angle);
+	m(1, 1) = cos(angle);
+	return m;
+}
+
+// glMultMatrixf(), which reads the rows of a Matrix4 as its columns
+static Math::Matrix4 makeGLMatrix(const Math::Matrix4 &matrix) {
+	Math::Matrix4 m = matrix;
+	m.transpose();
+	return m;
+}
+
+// gluLookAt()
+static Math::Matrix4 makeLookAtMatrix(const Math::Vector3d &eye, const Math::Vector3d &center, const Math::Vector3d &up) {
+	Math::Vector3d z = eye - center;
+	z.normalize();
+	Math::Vector3d x = Math::Vector3d::crossProduct(up, z);
+	Math::Vector3d y = Math::Vector3d::crossProduct(z, x);
+	x.normalize();
+	y.normalize();
+
+	Math::Matrix4 m;
+	for (int i = 0; i < 3; i++) {
+		m(0, i) = x.getValue(i);
+		m(1, i) = y.getValue(i);
+		m(2, i) = z.getValue(i);
+	}
+	return m * makeTranslationMatrix(-eye);
+}
+
+void GfxBase::setCameraProjection(float fov, float nclip, float fclip) {
+	float right = nclip * tan(fov / 2 * (LOCAL_PI / 180));
+	_cameraProjection = makeFrustumMatrix(-right, right, -right * 0.75, right * 0.75, nclip, fclip);
+	_cameraView.setToIdentity();
+}
+
+void GfxBase::setCameraView(const Math::Vector3d &pos, const Math::Vector3d &interest, float roll) {
+	if (g_grim->getGameType() == GType_MONKEY4) {
+		_cameraView = _cameraView * makeScaleMatrix(1, 1, -1);
+	} else {
+		Math::Vector3d up_vec(0, 0, 1);
+
+		if (pos.x() == interest.x() && pos.y() == interest.y())
+			up_vec = Math::Vector3d(0, 1, 0);
+
+		_cameraView = _cameraView * makeRollMatrix(roll) * makeLookAtMatrix(pos, interest, up_vec);
+	}
+}
+
+bool GfxBase::isActorVisible(const Math::Vector3d &pos, float scale, const Math::Quaternion &quat,
+							 const bool inOverworld, const Math::Vector3d &center, float radius) const {
+	if (_currentShadowArray)
+		return true;
+
+	// Place the actor as startActorDraw() does
+	Math::Matrix4 projection, modelView;
+	if (inOverworld) {
+		projection = makeFrustumMatrix(-1, 1, -0.75, 0.75, 1, 3276.8f);
+		modelView = makeScaleMatrix(-1, 1, -1) * makeRollMatrix(180) * makeTranslationMatrix(pos);
+	} else {
+		Math::Vector3d relPos = (pos - _currentPos);
+
+		Math::Matrix4 worldRot = _currentQuat.toMatrix();
+		worldRot.inverseRotate(&relPos);
+		projection = _cameraProjection;
+		modelView = _cameraView * makeTranslationMatrix(relPos) * makeGLMatrix(worldRot) *
+					makeScaleMatrix(scale, scale, scale) * makeGLMatrix(quat.toMatrix());
+	}
+
+	// Math::Frustum takes the column-major arrays of OpenGL
+	projection.transpose();
+	modelView.transpose();
+	Math::Frustum frustum;
+	frustum.setup(projection.getData(), modelView.getData());
+	return frustum.isSphereInside(center, radius);
+}
+
 void GfxBase::setShadowMode() {
 	_shadowModeActive = true;
 }
@@ -23,6 +23,7 @@
 #ifndef GRIM_GFX_BASE_H
 #define GRIM_GFX_BASE_H
 
+#include "math/matrix4.h"
 #include "math/vector3d.h"
 #include "math/quat.h"
 
@@ -113,13 +114,41 @@ public:
 	 */
 	virtual void flipBuffer() = 0;
 
+	/**
+	 * Counts of the faces the models drew in a frame, and of the material
+	 * and render state changes that came with them.
+	 */
+	struct RenderStats {
+		RenderStats() : _draws(0), _materialChanges(0), _stateChanges(0) { }
+		uint _draws;
+		uint _materialChanges;
+		uint _stateChanges;
+	};
+	RenderStats &getFrameStats() { return _frameStats; }
+	void resetFrameStats() { _frameStats = RenderStats(); }
+
 	virtual void getBoundingBoxPos(const Mesh *mesh, int *x1, int *y1, int *x2, int *y2) = 0;
 	virtual void startActorDraw(const Math::Vector3d &pos, float scale, const Math::Quaternion &quat,
 								const bool inOverworld, const float alpha, const bool depthOnly) = 0;
 
 	virtual void finishActorDraw() = 0;
+	/**
+	 * Check whether a sphere in the model space of an actor, placed as
+	 * startActorDraw() would place it, can be seen from the current camera.
+	 * It may return true for spheres that are just outside the view.
+	 * The test is done on the CPU with the camera matrices kept by
+	 * setCameraProjection() and setCameraView(), so it does not touch the
+	 * state of the renderer.
+	 */
+	bool isActorVisible(const Math::Vector3d &pos, float scale, const Math::Quaternion &quat,
+						const bool inOverworld, const Math::Vector3d &center, float radius) const;
 	virtual void setShadow(Shadow *shadow) = 0;
 	virtual void drawShadowPlanes() = 0;
+	/**
+	 * Release what the renderer keeps for the planes of a shadow, which
+	 * are about to change.
+	 */
+	virtual void destroyShadow(Shadow *shadow) {}
 	virtual void setShadowMode();
 	virtual void clearShadowMode();
 	bool isShadowModeActive();
@@ -134,7 +163,16 @@ public:
 	virtual void translateViewpointFinish() = 0;
 
 	virtual void drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face) = 0;
-	virtual void drawModelFace(const MeshFace *face, float *vertices, float *vertNormals, float *textureVerts) = 0;
+	virtual void drawModelFace(const Mesh *mesh, const MeshFace *face) = 0;
+
+	/**
+	 * Bracket the drawing of all the faces of a mesh or an EMI model, so that
+	 * renderers can set up the shared vertex data once instead of per face.
+	 */
+	virtual void startMeshDraw(const Mesh *mesh) { }
+	virtual void finishMeshDraw() { }
+	virtual void startEMIModelDraw(const EMIModel *model) { }
+	virtual void finishEMIModelDraw() { }
 	virtual void drawSprite(const Sprite *sprite) = 0;
 
 	virtual void enableLights() = 0;
@@ -223,9 +261,7 @@ public:
 	 * Prepare a movie-frame for drawing
 	 * performing any necessary conversion
 	 *
-	 * @param width         the width of the movie-frame.
-	 * @param height        the height of the movie-frame.
-	 * @param bitmap        a pointer to the data for the movie-frame.
+	 * @param frame         the movie-frame.
 	 * @see drawMovieFrame
 	 * @see releaseMovieFrame
 	 */
@@ -259,6 +295,13 @@ public:
 	virtual void refreshBuffers() {}
 
 protected:
+	/**
+	 * Keep a copy of the projection and view matrices that setupCamera()
+	 * and positionCamera() give to the renderer, for isActorVisible().
+	 */
+	void setCameraProjection(float fov, float nclip, float fclip);
+	void setCameraView(const Math::Vector3d &pos, const Math::Vector3d &interest, float roll);
+
 	static const int _gameHeight = 480;
 	static const int _gameWidth = 640;
 	float _scaleW, _scaleH;
@@ -275,7 +318,10 @@ protected:
 	SpecialtyMaterial _specialty[8];
 	Math::Vector3d _currentPos;
 	Math::Quaternion _currentQuat;
+	Math::Matrix4 _cameraProjection;
+	Math::Matrix4 _cameraView;
 	float _dimLevel;
+	RenderStats _frameStats;
 };
 
 // Factory-like functions:
@@ -97,6 +97,8 @@ GfxOpenGL::GfxOpenGL() : _smushNumTex(0),
 						_smushTexIds(NULL),
 						_smushWidth(0),
 						_smushHeight(0),
+						_smushTexWidth(0),
+						_smushTexHeight(0),
 						_useDepthShader(false),
 						_fragmentProgram(0),
 						_useDimShader(0),
@@ -106,6 +108,7 @@ GfxOpenGL::GfxOpenGL() : _smushNumTex(0),
 	_storedDisplay = NULL;
 	_emergFont = 0;
 	_alpha = 1.f;
+	_emiTextured = true;
 }
 
 GfxOpenGL::~GfxOpenGL() {
@@ -233,9 +236,12 @@ void GfxOpenGL::setupCamera(float fov, float nclip, float fclip, float roll) {
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
 
+	setCameraProjection(fov, nclip, fclip);
 }
 
 void GfxOpenGL::positionCamera(const Math::Vector3d &pos, const Math::Vector3d &interest, float roll) {
+	setCameraView(pos, interest, roll);
+
 	if (g_grim->getGameType() == GType_MONKEY4) {
 		glScaled(1, 1, -1);
 
@@ -323,6 +329,23 @@ void GfxOpenGL::getBoundingBoxPos(const Mesh *model, int *x1, int *y1, int *x2,
 		return;
 	}
 
+	GLfloat modelViewf[16], projectionf[16];
+	GLint viewPort[4];
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelViewf);
+	glGetFloatv(GL_PROJECTION_MATRIX, projectionf);
+	glGetIntegerv(GL_VIEWPORT, viewPort);
+
+	// Actors standing still project their meshes with the same matrices
+	// every frame, so reuse the box computed then.
+	if (model->_screenBounds.get(modelViewf, projectionf, viewPort, x1, y1, x2, y2))
+		return;
+
+	GLdouble modelView[16], projection[16];
+	for (int i = 0; i < 16; i++) {
+		modelView[i] = modelViewf[i];
+		projection[i] = projectionf[i];
+	}
+
 	GLdouble top = 1000;
 	GLdouble right = -1000;
 	GLdouble left = 1000;
@@ -334,13 +357,6 @@ void GfxOpenGL::getBoundingBoxPos(const Mesh *model, int *x1, int *y1, int *x2,
 		float *pVertices;
 
 		for (int j = 0; j < model->_faces[i]._numVertices; j++) {
-			GLdouble modelView[16], projection[16];
-			GLint viewPort[4];
-
-			glGetDoublev(GL_MODELVIEW_MATRIX, modelView);
-			glGetDoublev(GL_PROJECTION_MATRIX, projection);
-			glGetIntegerv(GL_VIEWPORT, viewPort);
-
 			pVertices = model->_vertices + 3 * model->_faces[i]._vertices[j];
 
 			v.set(*(pVertices), *(pVertices + 1), *(pVertices + 2));
@@ -376,13 +392,13 @@ void GfxOpenGL::getBoundingBoxPos(const Mesh *model, int *x1, int *y1, int *x2,
 		*y1 = -1;
 		*x2 = -1;
 		*y2 = -1;
-		return;
+	} else {
+		*x1 = (int)left;
+		*y1 = (int)top;
+		*x2 = (int)right;
+		*y2 = (int)bottom;
 	}
-
-	*x1 = (int)left;
-	*y1 = (int)top;
-	*x2 = (int)right;
-	*y2 = (int)bottom;
+	model->_screenBounds.set(modelViewf, projectionf, viewPort, *x1, *y1, *x2, *y2);
 }
 
 void GfxOpenGL::startActorDraw(const Math::Vector3d &pos, float scale, const Math::Quaternion &quat,
@@ -532,9 +548,7 @@ void GfxOpenGL::set3DMode() {
 	glDepthFunc(GL_LESS);
 }
 
-void GfxOpenGL::drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face) {
-	int *indices = (int *)face->_indexes;
-
+void GfxOpenGL::startEMIModelDraw(const EMIModel *model) {
 	glEnable(GL_DEPTH_TEST);
 	glDisable(GL_ALPHA_TEST);
 	glDisable(GL_LIGHTING);
@@ -542,10 +556,32 @@ void GfxOpenGL::drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face)
 	//Transparency-Support
 	glEnable(GL_BLEND);
 
-	if (face->_hasTexture)
-		glEnable(GL_TEXTURE_2D);
-	else
-		glDisable(GL_TEXTURE_2D);
+	glEnable(GL_TEXTURE_2D);
+	_emiTextured = true;
+}
+
+void GfxOpenGL::finishEMIModelDraw() {
+	glEnable(GL_TEXTURE_2D);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_ALPHA_TEST);
+	glEnable(GL_LIGHTING);
+	glDisable(GL_BLEND);
+	glDepthMask(true);
+	glColor3f(1.0f, 1.0f, 1.0f);
+}
+
+void GfxOpenGL::drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face) {
+	int *indices = (int *)face->_indexes;
+
+	bool textured = face->_hasTexture != 0;
+	if (textured != _emiTextured) {
+		if (textured)
+			glEnable(GL_TEXTURE_2D);
+		else
+			glDisable(GL_TEXTURE_2D);
+		_emiTextured = textured;
+		_frameStats._stateChanges++;
+	}
 
 	float dim = 1.0f - _dimLevel;
 	glBegin(GL_TRIANGLES);
@@ -556,23 +592,16 @@ void GfxOpenGL::drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face)
 		}
 		glColor4ub((byte)(model->_colorMap[index].r * dim), (byte)(model->_colorMap[index].g * dim), (byte)(model->_colorMap[index].b * dim), (int)(model->_colorMap[index].a * _alpha));
 
-		Math::Vector3d normal = model->_normals[index];
+		Math::Vector3d normal = model->_drawNormals[index];
 		Math::Vector3d vertex = model->_drawVertices[index];
 
 		glNormal3fv(normal.getData());
 		glVertex3fv(vertex.getData());
 	}
 	glEnd();
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_ALPHA_TEST);
-	glEnable(GL_LIGHTING);
-	glDisable(GL_BLEND);
-	glDepthMask(true);
-	glColor3f(1.0f, 1.0f, 1.0f);
 }
 
-void GfxOpenGL::drawModelFace(const MeshFace *face, float *vertices, float *vertNormals, float *textureVerts) {
+void GfxOpenGL::drawModelFace(const Mesh *mesh, const MeshFace *face) {
 	// Support transparency in actor objects, such as the message tube
 	// in Manny's Office
 	glAlphaFunc(GL_GREATER, 0.5);
@@ -580,12 +609,12 @@ void GfxOpenGL::drawModelFace(const MeshFace *face, float *vertices, float *vert
 	glNormal3fv(face->_normal.getData());
 	glBegin(GL_POLYGON);
 	for (int i = 0; i < face->_numVertices; i++) {
-		glNormal3fv(vertNormals + 3 * face->_vertices[i]);
+		glNormal3fv(mesh->_vertNormals + 3 * face->_vertices[i]);
 
 		if (face->_texVertices)
-			glTexCoord2fv(textureVerts + 2 * face->_texVertices[i]);
+			glTexCoord2fv(mesh->_textureVerts + 2 * face->_texVertices[i]);
 
-		glVertex3fv(vertices + 3 * face->_vertices[i]);
+		glVertex3fv(mesh->_vertices + 3 * face->_vertices[i]);
 	}
 	glEnd();
 	// Done with transparency-capable objects
@@ -1277,25 +1306,30 @@ void GfxOpenGL::prepareMovieFrame(Graphics::Surface *frame) {
 	int width = frame->w;
 	byte *bitmap = (byte *)frame->pixels;
 
-	// remove if already exist
-	if (_smushNumTex > 0) {
-		glDeleteTextures(_smushNumTex, _smushTexIds);
-		delete[] _smushTexIds;
-		_smushNumTex = 0;
-	}
+	// Only recreate the textures when the frame size changed
+	if (_smushNumTex == 0 || width != _smushTexWidth || height != _smushTexHeight) {
+		// remove if already exist
+		if (_smushNumTex > 0) {
+			glDeleteTextures(_smushNumTex, _smushTexIds);
+			delete[] _smushTexIds;
+			_smushNumTex = 0;
+		}
 
-	// create texture
-	_smushNumTex = ((width + (BITMAP_TEXTURE_SIZE - 1)) / BITMAP_TEXTURE_SIZE) *
-				   ((height + (BITMAP_TEXTURE_SIZE - 1)) / BITMAP_TEXTURE_SIZE);
-	_smushTexIds = new GLuint[_smushNumTex];
-	glGenTextures(_smushNumTex, _smushTexIds);
-	for (int i = 0; i < _smushNumTex; i++) {
-		glBindTexture(GL_TEXTURE_2D, _smushTexIds[i]);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, BITMAP_TEXTURE_SIZE, BITMAP_TEXTURE_SIZE, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, NULL);
+		// create texture
+		_smushNumTex = ((width + (BITMAP_TEXTURE_SIZE - 1)) / BITMAP_TEXTURE_SIZE) *
+					   ((height + (BITMAP_TEXTURE_SIZE - 1)) / BITMAP_TEXTURE_SIZE);
+		_smushTexIds = new GLuint[_smushNumTex];
+		glGenTextures(_smushNumTex, _smushTexIds);
+		for (int i = 0; i < _smushNumTex; i++) {
+			glBindTexture(GL_TEXTURE_2D, _smushTexIds[i]);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, BITMAP_TEXTURE_SIZE, BITMAP_TEXTURE_SIZE, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, NULL);
+		}
+		_smushTexWidth = width;
+		_smushTexHeight = height;
 	}
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
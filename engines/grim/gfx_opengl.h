@@ -78,8 +78,10 @@ public:
 	void rotateViewpoint(const Math::Angle &angle, const Math::Vector3d &axis);
 	void translateViewpointFinish();
 
+	void startEMIModelDraw(const EMIModel *model);
+	void finishEMIModelDraw();
 	void drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face);
-	void drawModelFace(const MeshFace *face, float *vertices, float *vertNormals, float *textureVerts);
+	void drawModelFace(const Mesh *mesh, const MeshFace *face);
 	void drawSprite(const Sprite *sprite);
 
 	void enableLights();
@@ -130,6 +132,8 @@ private:
 	GLuint *_smushTexIds;
 	int _smushWidth;
 	int _smushHeight;
+	int _smushTexWidth;
+	int _smushTexHeight;
 	byte *_storedDisplay;
 	bool _useDepthShader;
 	GLuint _fragmentProgram;
@@ -137,6 +141,7 @@ private:
 	GLuint _dimFragProgram;
 	GLint _maxLights;
 	float _alpha;
+	bool _emiTextured;
 };
 
 } // end of namespace Grim
@@ -27,6 +27,7 @@
 #include "graphics/colormasks.h"
 
 #include "engines/grim/actor.h"
+#include "engines/grim/blitimage.h"
 #include "engines/grim/colormap.h"
 #include "engines/grim/material.h"
 #include "engines/grim/font.h"
@@ -41,92 +42,6 @@
 
 namespace Grim {
 
-/**
- * This class is used for blitting bitmaps with transparent pixels.
- * Instead of checking every pixel for transparency, it creates a list of 'lines'.
- * A line is, well, a line of non trasparent pixels, and itstores a pointer to the
- * first pixel, and the position of it, which can be used to memcpy the entire line
- * to the destination buffer.
- */
-class BlitImage {
-public:
-	BlitImage() {
-		_lines = NULL;
-		_last = NULL;
-		_width = 0;
-		_height = 0;
-	}
-	~BlitImage() {
-		Line *temp = _lines;
-		while (temp != NULL) {
-			_lines = temp->next;
-			delete temp;
-			temp = _lines;
-		}
-	}
-	void create(const Graphics::PixelBuffer &buf, uint32 transparency, int x, int y, int width, int height) {
-		Graphics::PixelBuffer srcBuf = buf;
-		_width = width;
-		_height = height;
-		// A line of pixels can not wrap more that one line of the image, since it would break
-		// blitting of bitmaps with a non-zero x position.
-		for (int l = 0; l < height; l++) {
-			int start = -1;
-
-			for (int r = 0; r < width; ++r) {
-				// We found a transparent pixel, so save a line from 'start' to the pixel before this.
-				if (srcBuf.getValueAt(r) == transparency && start >= 0) {
-					newLine(start, l, r - start, srcBuf.getRawBuffer(start));
-
-					start = -1;
-				} else if (srcBuf.getValueAt(r) != transparency && start == -1) {
-					start = r;
-				}
-			}
-			// end of the bitmap line. if start is an actual pixel save the line.
-			if (start >= 0) {
-				newLine(start, l, width - start, srcBuf.getRawBuffer(start));
-			}
-
-			srcBuf.shiftBy(width);
-		}
-	}
-
-	void newLine(int x, int y, int length, byte *pixels) {
-		if (length < 1) {
-			return;
-		}
-
-		Line *line = new Line;
-
-		line->x = x;
-		line->y = y;
-		line->length = length;
-		line->pixels = pixels;
-		line->next = NULL;
-
-		if (_last) {
-			_last->next = line;
-		}
-		if (!_lines) {
-			_lines = line;
-		}
-		_last = line;
-	}
-
-	struct Line {
-		int x;
-		int y;
-		int length;
-		byte *pixels;
-
-		Line *next;
-	};
-	Line *_lines;
-	Line *_last;
-	int _width, _height;
-};
-
 GfxBase *CreateGfxTinyGL() {
 	return new GfxTinyGL();
 }
@@ -236,6 +151,8 @@ GfxTinyGL::GfxTinyGL() : _smushWidth(0), _smushHeight(0) {
 	_zb = NULL;
 	_storedDisplay = NULL;
 	_alpha = 1.f;
+	_emiTextured = true;
+	_drawnMesh = NULL;
 	_bufferId = 0;
 }
 
@@ -297,9 +214,12 @@ void GfxTinyGL::setupCamera(float fov, float nclip, float fclip, float roll) {
 	tglMatrixMode(TGL_MODELVIEW);
 	tglLoadIdentity();
 
+	setCameraProjection(fov, nclip, fclip);
 }
 
 void GfxTinyGL::positionCamera(const Math::Vector3d &pos, const Math::Vector3d &interest, float roll) {
+	setCameraView(pos, interest, roll);
+
 	if (g_grim->getGameType() == GType_MONKEY4) {
 		tglScalef(1.0, 1.0, -1.0);
 
@@ -436,6 +356,17 @@ void GfxTinyGL::getBoundingBoxPos(const Mesh *model, int *x1, int *y1, int *x2,
 		return;
 	}
 
+	TGLfloat modelView[16], projection[16];
+	TGLint viewPort[4];
+	tglGetFloatv(TGL_MODELVIEW_MATRIX, modelView);
+	tglGetFloatv(TGL_PROJECTION_MATRIX, projection);
+	tglGetIntegerv(TGL_VIEWPORT, viewPort);
+
+	// Actors standing still project their meshes with the same matrices
+	// every frame, so reuse the box computed then.
+	if (model->_screenBounds.get(modelView, projection, viewPort, x1, y1, x2, y2))
+		return;
+
 	TGLfloat top = 1000;
 	TGLfloat right = -1000;
 	TGLfloat left = 1000;
@@ -447,13 +378,6 @@ void GfxTinyGL::getBoundingBoxPos(const Mesh *model, int *x1, int *y1, int *x2,
 		float *pVertices;
 
 		for (int j = 0; j < model->_faces[i]._numVertices; j++) {
-			TGLfloat modelView[16], projection[16];
-			TGLint viewPort[4];
-
-			tglGetFloatv(TGL_MODELVIEW_MATRIX, modelView);
-			tglGetFloatv(TGL_PROJECTION_MATRIX, projection);
-			tglGetIntegerv(TGL_VIEWPORT, viewPort);
-
 			pVertices = model->_vertices + 3 * model->_faces[i]._vertices[j];
 
 			v.set(*(pVertices), *(pVertices + 1), *(pVertices + 2));
@@ -489,13 +413,13 @@ void GfxTinyGL::getBoundingBoxPos(const Mesh *model, int *x1, int *y1, int *x2,
 		*y1 = -1;
 		*x2 = -1;
 		*y2 = -1;
-		return;
+	} else {
+		*x1 = (int)left;
+		*y1 = (int)top;
+		*x2 = (int)right;
+		*y2 = (int)bottom;
 	}
-
-	*x1 = (int)left;
-	*y1 = (int)top;
-	*x2 = (int)right;
-	*y2 = (int)bottom;
+	model->_screenBounds.set(modelView, projection, viewPort, *x1, *y1, *x2, *y2);
 /*
 	uint16 *dst = (uint16 *)_zb->pbuf;
 	uint16 c = 0xffff;
@@ -604,6 +528,10 @@ void GfxTinyGL::finishActorDraw() {
 	tglColorMask(TGL_TRUE, TGL_TRUE, TGL_TRUE, TGL_TRUE);
 }
 
+struct ShadowUserData {
+	TGLuint planeList;
+};
+
 void GfxTinyGL::drawShadowPlanes() {
 	tglEnable(TGL_SHADOW_MASK_MODE);
 	if (!_currentShadowArray->shadowMask) {
@@ -613,19 +541,40 @@ void GfxTinyGL::drawShadowPlanes() {
 	memset(_currentShadowArray->shadowMask, 0, _gameWidth * _gameHeight);
 
 	tglSetShadowMaskBuf(_currentShadowArray->shadowMask);
-	_currentShadowArray->planeList.begin();
-	for (SectorListType::iterator i = _currentShadowArray->planeList.begin(); i != _currentShadowArray->planeList.end(); ++i) {
-		Sector *shadowSector = i->sector;
-		tglBegin(TGL_POLYGON);
-		for (int k = 0; k < shadowSector->getNumVertices(); k++) {
-			tglVertex3f(shadowSector->getVertices()[k].x(), shadowSector->getVertices()[k].y(), shadowSector->getVertices()[k].z());
+
+	// The planes do not move: compiled into a display list, they are only
+	// transformed again when the camera moves
+	ShadowUserData *userData = (ShadowUserData *)_currentShadowArray->userData;
+	if (!userData) {
+		userData = new ShadowUserData;
+		userData->planeList = tglGenLists(1);
+		tglNewList(userData->planeList, TGL_COMPILE);
+		for (SectorListType::iterator i = _currentShadowArray->planeList.begin(); i != _currentShadowArray->planeList.end(); ++i) {
+			Sector *shadowSector = i->sector;
+			tglBegin(TGL_POLYGON);
+			for (int k = 0; k < shadowSector->getNumVertices(); k++) {
+				tglVertex3f(shadowSector->getVertices()[k].x(), shadowSector->getVertices()[k].y(), shadowSector->getVertices()[k].z());
+			}
+			tglEnd();
 		}
-		tglEnd();
+		tglEndList();
+		_currentShadowArray->userData = userData;
 	}
+	tglCallList(userData->planeList);
+
 	tglSetShadowMaskBuf(NULL);
 	tglDisable(TGL_SHADOW_MASK_MODE);
 }
 
+void GfxTinyGL::destroyShadow(Shadow *shadow) {
+	ShadowUserData *userData = (ShadowUserData *)shadow->userData;
+	if (userData) {
+		tglDeleteLists(userData->planeList, 1);
+		delete userData;
+		shadow->userData = NULL;
+	}
+}
+
 void GfxTinyGL::setShadowMode() {
 	GfxBase::setShadowMode();
 	tglEnable(TGL_SHADOW_MODE);
@@ -661,52 +610,100 @@ void GfxTinyGL::getShadowColor(byte *r, byte *g, byte *b) {
 	*b = _shadowColorB;
 }
 
-void GfxTinyGL::drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face) {
-	int *indices = (int *)face->_indexes;
+void GfxTinyGL::startEMIModelDraw(const EMIModel *model) {
+	// The vertex colors depend on the dim level and the actor alpha, which do
+	// not change while the model is drawn, so bake them once for all faces.
+	float dim = 1.0f - _dimLevel;
+	float alpha = (byte)(int)_alpha / 255.0f;
+	_emiColors.resize(model->_numVertices * 4);
+	for (int i = 0; i < model->_numVertices; i++) {
+		const EMIColormap &color = model->_colorMap[i];
+		_emiColors[i * 4 + 0] = (byte)(color.r * dim) / 255.0f;
+		_emiColors[i * 4 + 1] = (byte)(color.g * dim) / 255.0f;
+		_emiColors[i * 4 + 2] = (byte)(color.b * dim) / 255.0f;
+		_emiColors[i * 4 + 3] = alpha;
+	}
+
+	tglEnableClientState(TGL_VERTEX_ARRAY);
+	tglEnableClientState(TGL_NORMAL_ARRAY);
+	tglEnableClientState(TGL_COLOR_ARRAY);
+	tglVertexPointer(3, TGL_FLOAT, 0, model->_drawVertices);
+	tglNormalPointer(TGL_FLOAT, 0, model->_drawNormals);
+	tglColorPointer(4, TGL_FLOAT, 0, &_emiColors.front());
+	tglTexCoordPointer(2, TGL_FLOAT, 0, model->_texVerts);
+	// Faces share their vertices, so let TinyGL keep the transformed and
+	// lit vertices around until the whole model has been drawn.
+	tglLockArraysEXT(0, model->_numVertices);
+
+	// The faces only switch texturing on and off, the rest of the state is
+	// the same for all of them.
 	tglEnable(TGL_DEPTH_TEST);
 	tglDisable(TGL_ALPHA_TEST);
 
 	//Transparency-Support
 	tglEnable(TGL_BLEND); // TODO: TinyGL doesn't support enough alpha-bits yet.
 
-	if (face->_hasTexture)
-		tglEnable(TGL_TEXTURE_2D);
-	else
-		tglDisable(TGL_TEXTURE_2D);
-	tglBegin(TGL_TRIANGLES);
-
-	float dim = 1.0f - _dimLevel;
-	for (uint j = 0; j < face->_faceLength * 3; j++) {
-		int index = indices[j];
-		if (face->_hasTexture) {
-			tglTexCoord2f(model->_texVerts[index].getX(), model->_texVerts[index].getY());
-		}
-		tglColor4ub((byte)(model->_colorMap[index].r * dim), (byte)(model->_colorMap[index].g * dim), (byte)(model->_colorMap[index].b * dim), (int)_alpha);
+	tglEnable(TGL_TEXTURE_2D);
+	tglEnableClientState(TGL_TEXTURE_COORD_ARRAY);
+	_emiTextured = true;
+}
 
-		Math::Vector3d normal = model->_normals[index];
-		Math::Vector3d vertex = model->_drawVertices[index];
+void GfxTinyGL::finishEMIModelDraw() {
+	tglUnlockArraysEXT();
+	tglDisableClientState(TGL_TEXTURE_COORD_ARRAY);
+	tglDisableClientState(TGL_COLOR_ARRAY);
+	tglDisableClientState(TGL_NORMAL_ARRAY);
+	tglDisableClientState(TGL_VERTEX_ARRAY);
 
-		tglNormal3fv(normal.getData());
-		tglVertex3fv(vertex.getData());
-	}
-
-	tglEnd();
 	tglEnable(TGL_TEXTURE_2D);
 	tglEnable(TGL_DEPTH_TEST);
 	tglEnable(TGL_ALPHA_TEST);
 	tglDisable(TGL_BLEND);
 }
 
-void GfxTinyGL::drawModelFace(const MeshFace *face, float *vertices, float *vertNormals, float *textureVerts) {
-	tglNormal3fv(const_cast<float *>(face->_normal.getData()));
+void GfxTinyGL::drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face) {
+	bool textured = face->_hasTexture != 0;
+	if (textured != _emiTextured) {
+		if (textured) {
+			tglEnable(TGL_TEXTURE_2D);
+			tglEnableClientState(TGL_TEXTURE_COORD_ARRAY);
+		} else {
+			tglDisable(TGL_TEXTURE_2D);
+			tglDisableClientState(TGL_TEXTURE_COORD_ARRAY);
+		}
+		_emiTextured = textured;
+		_frameStats._stateChanges++;
+	}
+
+	tglDrawElements(TGL_TRIANGLES, face->_faceLength * 3, TGL_UNSIGNED_INT, face->_indexes);
+}
+
+void GfxTinyGL::startMeshDraw(const Mesh *mesh) {
+	tglEnableClientState(TGL_VERTEX_ARRAY);
+	tglEnableClientState(TGL_NORMAL_ARRAY);
+	tglVertexPointer(3, TGL_FLOAT, 0, mesh->_vertices);
+	tglNormalPointer(TGL_FLOAT, 0, mesh->_vertNormals);
+	tglLockArraysEXT(0, mesh->_numVertices);
+	_drawnMesh = mesh;
+}
+
+void GfxTinyGL::finishMeshDraw() {
+	tglUnlockArraysEXT();
+	tglDisableClientState(TGL_NORMAL_ARRAY);
+	tglDisableClientState(TGL_VERTEX_ARRAY);
+	_drawnMesh = NULL;
+}
+
+void GfxTinyGL::drawModelFace(const Mesh *mesh, const MeshFace *face) {
+	// The vertex and normal arrays have been set up by startMeshDraw(), only
+	// the texture coordinates have their own indices.
+	assert(mesh == _drawnMesh);
 	tglBegin(TGL_POLYGON);
 	for (int i = 0; i < face->_numVertices; i++) {
-		tglNormal3fv(vertNormals + 3 * face->_vertices[i]);
-
 		if (face->_texVertices)
-			tglTexCoord2fv(textureVerts + 2 * face->_texVertices[i]);
+			tglTexCoord2fv(mesh->_textureVerts + 2 * face->_texVertices[i]);
 
-		tglVertex3fv(vertices + 3 * face->_vertices[i]);
+		tglArrayElement(face->_vertices[i]);
 	}
 	tglEnd();
 }
@@ -901,65 +898,7 @@ void GfxTinyGL::blit(const Graphics::PixelFormat &format, BlitImage *image, byte
 		warning("TinyGL doesn't implement partial screen-dimming yet");
 	}
 
-	if (dstX >= _gameWidth || dstY >= _gameHeight)
-		return;
-
-	int clampWidth, clampHeight;
-
-	if (dstX + width > _gameWidth)
-		clampWidth = _gameWidth - dstX;
-	else
-		clampWidth = width;
-
-	if (dstY + height > _gameHeight)
-		clampHeight = _gameHeight - dstY;
-	else
-		clampHeight = height;
-
-	dst += (dstX + (dstY * _gameWidth)) * format.bytesPerPixel;
-	src += (srcX + (srcY * srcWidth)) * format.bytesPerPixel;
-
-	Graphics::PixelBuffer srcBuf(format, src);
-	Graphics::PixelBuffer dstBuf(format, dst);
-
-	if (!trans) {
-		for (int l = 0; l < clampHeight; l++) {
-			dstBuf.copyBuffer(0, clampWidth, srcBuf);
-			dstBuf.shiftBy(_gameWidth);
-			srcBuf.shiftBy(srcWidth);
-		}
-	} else {
-		if (image) {
-			BlitImage::Line *l = image->_lines;
-			int maxY = srcY + clampHeight;
-			int maxX = srcX + clampWidth;
-			while (l && l->y < srcY)
-				l = l->next;
-
-			while (l && l->y <= maxY) {
-				if (l->x < maxX && l->x + l->length > srcX) {
-					int length = l->length;
-					int skipStart = l->x < srcX ? srcX - l->x : 0;
-					length -= skipStart;
-					int skipEnd   = l->x + l->length > maxX ? l->x + l->length - maxX : 0;
-					length -= skipEnd;
-					memcpy(dstBuf.getRawBuffer((l->y - srcY) * _gameWidth + MAX(l->x - srcX, 0)),
-						   l->pixels + skipStart * format.bytesPerPixel, length * format.bytesPerPixel);
-				}
-				l = l->next;
-			}
-		} else {
-			for (int l = 0; l < clampHeight; l++) {
-				for (int r = 0; r < clampWidth; ++r) {
-					if (srcBuf.getValueAt(r) != 0xf81f) {
-						dstBuf.setPixelAt(r, srcBuf);
-					}
-				}
-				dstBuf.shiftBy(_gameWidth);
-				srcBuf.shiftBy(srcWidth);
-			}
-		}
-	}
+	blitImage(format, image, dst, _gameWidth, _gameHeight, src, dstX, dstY, srcX, srcY, width, height, srcWidth, srcHeight, trans);
 }
 
 void GfxTinyGL::drawBitmap(const Bitmap *bitmap, int x, int y, uint32 layer) {
@@ -1175,8 +1114,9 @@ void GfxTinyGL::createMaterial(Texture *material, const char *data, const CMap *
 	tglBindTexture(TGL_TEXTURE_2D, textures[0]);
 	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_S, TGL_REPEAT);
 	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_T, TGL_REPEAT);
-	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_LINEAR);
-	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_LINEAR);
+	// Bilinear filtering is too slow in software
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
 	tglTexImage2D(TGL_TEXTURE_2D, 0, 3, material->_width, material->_height, 0, format, TGL_UNSIGNED_BYTE, texdata);
 	delete[] texdata;
 }
@@ -1202,11 +1142,14 @@ void GfxTinyGL::destroyMaterial(Texture *material) {
 }
 
 void GfxTinyGL::prepareMovieFrame(Graphics::Surface *frame) {
+	// Only reallocate the bitmap when the frame size changed
+	if (!_smushBitmap || frame->w != _smushWidth || frame->h != _smushHeight)
+		_smushBitmap.create(_pixelFormat, frame->w * frame->h, DisposeAfterUse::YES);
+
 	_smushWidth = frame->w;
 	_smushHeight = frame->h;
 
 	Graphics::PixelBuffer srcBuf(frame->format, (byte *)frame->pixels);
-	_smushBitmap.create(_pixelFormat, frame->w * frame->h, DisposeAfterUse::YES);
 	_smushBitmap.copyBuffer(0, frame->w * frame->h, srcBuf);
 }
 
@@ -23,6 +23,9 @@
 #ifndef GRIM_GFX_TINYGL_H
 #define GRIM_GFX_TINYGL_H
 
+#include "common/array.h"
+#include "common/hashmap.h"
+
 #include "engines/grim/gfx_base.h"
 
 #include "graphics/tinygl/zgl.h"
@@ -62,6 +65,7 @@ public:
 	void finishActorDraw();
 	void setShadow(Shadow *shadow);
 	void drawShadowPlanes();
+	void destroyShadow(Shadow *shadow);
 	void setShadowMode();
 	void clearShadowMode();
 	void setShadowColor(byte r, byte g, byte b);
@@ -75,7 +79,11 @@ public:
 	void translateViewpointFinish();
 
 	void drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face);
-	void drawModelFace(const MeshFace *face, float *vertices, float *vertNormals, float *textureVerts);
+	void drawModelFace(const Mesh *mesh, const MeshFace *face);
+	void startMeshDraw(const Mesh *mesh);
+	void finishMeshDraw();
+	void startEMIModelDraw(const EMIModel *model);
+	void finishEMIModelDraw();
 	void drawSprite(const Sprite *sprite);
 
 	void enableLights();
@@ -135,6 +143,9 @@ private:
 	int _smushHeight;
 	Graphics::PixelBuffer _storedDisplay;
 	float _alpha;
+	bool _emiTextured;
+	const Mesh *_drawnMesh;
+	Common::Array<float> _emiColors;
 	Common::HashMap<int, TinyGL::Buffer *> _buffers;
 	uint _bufferId;
 
@@ -31,6 +31,7 @@
 #include "common/foreach.h"
 #include "common/fs.h"
 #include "common/config-manager.h"
+#include "common/profiler.h"
 
 #include "graphics/pixelbuffer.h"
 
@@ -91,6 +92,7 @@ GrimEngine::GrimEngine(OSystem *syst, uint32 gameFlags, GrimGameType gameType, C
 
 	_showFps = g_registry->getBool("show_fps");
 	_softRenderer = true;
+	_culling = true;
 
 	_mixer->setVolumeForSoundType(Audio::Mixer::kPlainSoundType, 192);
 	_mixer->setVolumeForSoundType(Audio::Mixer::kSFXSoundType, ConfMan.getInt("sfx_volume"));
@@ -120,6 +122,8 @@ GrimEngine::GrimEngine(OSystem *syst, uint32 gameFlags, GrimGameType gameType, C
 	_refreshDrawNeeded = true;
 	_listFilesIter = NULL;
 	_savedState = NULL;
+	_savegameWriter = NULL;
+	_savegameSizeHint = 0;
 	_fps[0] = 0;
 	_iris = new Iris();
 	_buildActiveActorsList = false;
@@ -158,6 +162,8 @@ GrimEngine::GrimEngine(OSystem *syst, uint32 gameFlags, GrimGameType gameType, C
 }
 
 GrimEngine::~GrimEngine() {
+	finishSavegameWrite(true);
+
 	delete[] _controlsEnabled;
 	delete[] _controlsState;
 
@@ -422,6 +428,8 @@ void GrimEngine::playIrisAnimation(Iris::Direction dir, int x, int y, int time)
 }
 
 void GrimEngine::luaUpdate() {
+	PROFILE_SCOPE("luaUpdate");
+
 	if (_savegameLoadRequest || _savegameSaveRequest || _changeHardwareState)
 		return;
 
@@ -469,14 +477,18 @@ void GrimEngine::luaUpdate() {
 }
 
 void GrimEngine::updateDisplayScene() {
+	PROFILE_SCOPE("updateDisplayScene");
+
 	_doFlip = true;
+	// Reset here rather than in doFlip(), which may return early
+	g_driver->resetFrameStats();
 
 	if (_mode == SmushMode) {
 		if (g_movie->isPlaying()) {
 			_movieTime = g_movie->getMovieTime();
 			if (g_movie->isUpdateNeeded()) {
-				g_driver->prepareMovieFrame(g_movie->getDstSurface());
-				g_movie->clearUpdateNeeded();
+				Graphics::Surface *frame = g_movie->getDstSurface();
+				g_driver->prepareMovieFrame(frame);
 			}
 			int frame = g_movie->getFrame();
 			if (frame >= 0) {
@@ -513,6 +525,8 @@ void GrimEngine::updateDisplayScene() {
 }
 
 void GrimEngine::drawNormalMode() {
+	PROFILE_SCOPE("drawNormalMode");
+
 	_prevSmushFrame = 0;
 	_movieTime = 0;
 
@@ -536,8 +550,8 @@ void GrimEngine::drawNormalMode() {
 	if (g_movie->isPlaying() && _movieSetup == _currSet->getCurrSetup()->_name) {
 		_movieTime = g_movie->getMovieTime();
 		if (g_movie->isUpdateNeeded()) {
-			g_driver->prepareMovieFrame(g_movie->getDstSurface());
-			g_movie->clearUpdateNeeded();
+			Graphics::Surface *frame = g_movie->getDstSurface();
+			g_driver->prepareMovieFrame(frame);
 		}
 		if (g_movie->getFrame() >= 0)
 			g_driver->drawMovieFrame(g_movie->getX(), g_movie->getY());
@@ -566,6 +580,12 @@ void GrimEngine::drawNormalMode() {
 
 	// Draw actors
 	buildActiveActorsList();
+	cullActors();
+	// Skin all the models first, so that drawing only feeds the renderer
+	foreach (Actor *a, _activeActors) {
+		if (a->isVisible() && !a->isCulled())
+			a->prepareForRender();
+	}
 	foreach (Actor *a, _activeActors) {
 		if (a->isVisible())
 			a->draw();
@@ -579,17 +599,35 @@ void GrimEngine::drawNormalMode() {
 	_currSet->drawBitmaps(ObjectState::OBJSTATE_OVERLAY);
 }
 
+void GrimEngine::cullActors() {
+	_cullStats = CullStats();
+	foreach (Actor *a, _activeActors) {
+		if (!a->isVisible())
+			continue;
+		_cullStats._tested++;
+		if (a->cull())
+			_cullStats._culled++;
+	}
+}
+
 void GrimEngine::doFlip() {
 	_frameCounter++;
 	if (!_doFlip) {
 		return;
 	}
 
-	if (_showFps && _mode != DrawMode)
+	if (_showFps && _mode != DrawMode) {
 		g_driver->drawEmergString(550, 25, _fps, Color(255, 255, 255));
 
-	if (_flipEnable)
+		const GfxBase::RenderStats &stats = g_driver->getFrameStats();
+		Common::String counts = Common::String::format("%u faces %u mat %u state", stats._draws, stats._materialChanges, stats._stateChanges);
+		g_driver->drawEmergString(630 - 8 * counts.size(), 40, counts.c_str(), Color(255, 255, 255));
+	}
+
+	if (_flipEnable) {
+		PROFILE_SCOPE("flipBuffer");
 		g_driver->flipBuffer();
+	}
 
 	if (_showFps && _mode != DrawMode) {
 		unsigned int currentTime = g_system->getMillis();
@@ -628,6 +666,8 @@ void GrimEngine::mainLoop() {
 		if (shouldQuit())
 			return;
 
+		finishSavegameWrite(false);
+
 		if (_savegameLoadRequest) {
 			savegameRestore();
 		}
@@ -756,6 +796,10 @@ void GrimEngine::loadGame(const Common::String &file) {
 void GrimEngine::savegameRestore() {
 	debug("GrimEngine::savegameRestore() started.");
 	_savegameLoadRequest = false;
+
+	// The savegame may be the one still being written
+	finishSavegameWrite(true);
+
 	Common::String filename;
 	if (_savegameFileName.size() == 0) {
 		filename = "grim.sav";
@@ -765,6 +809,11 @@ void GrimEngine::savegameRestore() {
 	_savedState = SaveGame::openForLoading(filename);
 	if (!_savedState || !_savedState->isCompatible())
 		return;
+
+	// Most of the resources of the savegame are already loaded when it is in
+	// the same room as the current game: reuse them.
+	g_resourceloader->holdResources();
+
 	g_imuse->stopAllSounds();
 	g_imuse->resetState();
 	g_movie->stop();
@@ -822,6 +871,9 @@ void GrimEngine::savegameRestore() {
 
 	delete _savedState;
 
+	// Free what the savegame did not use
+	g_resourceloader->releaseResources();
+
 	//Re-read the values, since we may have been in some state that changed them when loading the savegame,
 	//e.g. running a cutscene, which sets the sfx volume to 0.
 	_mixer->setVolumeForSoundType(Audio::Mixer::kSFXSoundType, ConfMan.getInt("sfx_volume"));
@@ -922,7 +974,11 @@ void GrimEngine::savegameSave() {
 	if (getGameType() == GType_MONKEY4 && filename.contains('/')) {
 		filename = Common::lastPathComponent(filename, '/');
 	}
-	_savedState = SaveGame::openForSaving(filename);
+
+	// Only one savegame is written at a time
+	finishSavegameWrite(true);
+
+	_savedState = SaveGame::openForSaving(filename, _savegameSizeHint);
 	if (!_savedState) {
 		//TODO: Translate this!
 		GUI::displayErrorDialog("Error: the game could not be saved.");
@@ -979,7 +1035,12 @@ void GrimEngine::savegameSave() {
 
 	lua_Save(_savedState);
 
-	delete _savedState;
+	// The game state is all in memory now: let the game go on while the
+	// savegame is written
+	_savegameSizeHint = _savedState->getSize();
+	_savegameWriter = new SaveGameWriter(_savedState,
+		new Common::Functor1Mem<bool, void, GrimEngine>(this, &GrimEngine::savegameWritten));
+	_savedState = NULL;
 
 	g_imuse->pause(false);
 	g_movie->pause(false);
@@ -989,6 +1050,28 @@ void GrimEngine::savegameSave() {
 	clearEventQueue();
 }
 
+void GrimEngine::savegameWritten(bool success) {
+	if (!success) {
+		warning("GrimEngine::savegameWritten() Can't write file. (Disk full?)");
+		//TODO: Translate this!
+		GUI::displayErrorDialog("Error: the game could not be saved.");
+	}
+	debug("GrimEngine::savegameWritten() finished.");
+}
+
+void GrimEngine::finishSavegameWrite(bool wait) {
+	if (!_savegameWriter)
+		return;
+
+	if (wait)
+		_savegameWriter->wait();
+	else if (!_savegameWriter->poll())
+		return;
+
+	delete _savegameWriter;
+	_savegameWriter = NULL;
+}
+
 void GrimEngine::saveGRIM() {
 	_savedState->beginSection('GRIM');
 
@@ -38,6 +38,7 @@ namespace Grim {
 
 class Actor;
 class SaveGame;
+class SaveGameWriter;
 class Bitmap;
 class Font;
 class Color;
@@ -159,6 +160,19 @@ public:
 	 */
 	const Common::List<Actor *> &getActiveActors() const { return _activeActors; }
 
+	/**
+	 * Counts of the visible actors tested against the view in the last
+	 * frame, and of those that were not drawn because they are out of it.
+	 */
+	struct CullStats {
+		CullStats() : _tested(0), _culled(0) { }
+		uint _tested;
+		uint _culled;
+	};
+	const CullStats &getCullStats() const { return _cullStats; }
+	void setCulling(bool enable) { _culling = enable; }
+	bool getCulling() const { return _culling; }
+
 	/**
 	 * Add an actor to the list of actors that are talking
 	 */
@@ -197,6 +211,7 @@ protected:
 	void cameraChangeHandle(int prev, int next);
 	void cameraPostChangeHandle(int num);
 	void buildActiveActorsList();
+	void cullActors();
 	void savegameCallback();
 	void createRenderer();
 	virtual LuaBase *createLua();
@@ -204,6 +219,8 @@ protected:
 
 	void savegameSave();
 	void saveGRIM();
+	void savegameWritten(bool success);
+	void finishSavegameWrite(bool wait);
 
 	void savegameRestore();
 	void restoreGRIM();
@@ -214,6 +231,8 @@ protected:
 	bool _savegameSaveRequest;
 	Common::String _savegameFileName;
 	SaveGame *_savedState;
+	SaveGameWriter *_savegameWriter;
+	uint32 _savegameSizeHint; ///< Size of the last savegame, to size the buffer of the next one
 
 	Set *_currSet;
 	EngineMode _mode, _previousMode;
@@ -249,6 +268,8 @@ protected:
 
 	bool _buildActiveActorsList;
 	Common::List<Actor *> _activeActors;
+	bool _culling;
+	CullStats _cullStats;
 	Common::List<Actor *> _talkingActors;
 
 	uint32 _gameFlags;
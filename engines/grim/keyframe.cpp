@@ -160,21 +160,34 @@ KeyframeAnim::~KeyframeAnim() {
 	g_resourceloader->uncacheKeyframe(this);
 }
 
-bool KeyframeAnim::animate(ModelNode *nodes, int num, float time, float fade, bool tagged) const {
-	// Without this sending the bread down the tube in "mo" often crashes,
-	// because it goes outside the bounds of the array of the nodes.
-	if (num >= _numJoints)
-		return false;
+void AnimPose::resize(int numNodes) {
+	_numNodes = numNodes;
+	for (int c = 0; c < NumChannels; c++) {
+		_sample[c].resize(numNodes);
+		_layer[c].resize(numNodes);
+		_blended[c].resize(numNodes);
+	}
+	_sampled.resize(numNodes);
+	_totalWeight.resize(numNodes);
+	_remainingWeight.resize(numNodes);
+}
 
+void KeyframeAnim::sample(const ModelNode *nodes, float time, bool tagged, int *cursors, AnimPose &pose) const {
 	float frame = time * _fps;
 
 	if (frame > _numFrames)
 		frame = _numFrames;
 
-	if (_nodes[num] && tagged == ((_type & nodes[num]._type) != 0)) {
-		return _nodes[num]->animate(nodes[num], frame, fade, (_flags & 256) == 0);
-	} else {
-		return false;
+	bool useDelta = (_flags & 256) == 0;
+	for (int i = 0; i < pose._numNodes; i++) {
+		pose._sampled[i] = false;
+		// Without this sending the bread down the tube in "mo" often crashes,
+		// because it goes outside the bounds of the array of the nodes.
+		if (i >= _numJoints || pose._remainingWeight[i] <= 0.0f)
+			continue;
+
+		if (_nodes[i] && tagged == ((_type & nodes[i]._type) != 0))
+			pose._sampled[i] = _nodes[i]->sample(nodes[i], frame, useDelta, cursors ? cursors + i : NULL, pose, i);
 	}
 }
 
@@ -247,9 +260,16 @@ KeyframeAnim::KeyframeNode::~KeyframeNode() {
 	delete[] _entries;
 }
 
-bool KeyframeAnim::KeyframeNode::animate(ModelNode &node, float frame, float fade, bool useDelta) const {
-	if (_numEntries == 0)
-		return false;
+// Find the nearest previous keyframe. When the frame did not go back since
+// the last call, step forward from the keyframe found then.
+int KeyframeAnim::KeyframeNode::findEntry(float frame, int *cursor) const {
+	if (cursor && *cursor < _numEntries && _entries[*cursor]._frame <= frame) {
+		int i = *cursor;
+		while (i + 1 < _numEntries && _entries[i + 1]._frame <= frame)
+			i++;
+		*cursor = i;
+		return i;
+	}
 
 	// Do a binary search for the nearest previous frame
 	// Loop invariant: entries_[low].frame_ <= frame < entries_[high].frame_
@@ -261,6 +281,16 @@ bool KeyframeAnim::KeyframeNode::animate(ModelNode &node, float frame, float fad
 		else
 			high = mid;
 	}
+	if (cursor)
+		*cursor = low;
+	return low;
+}
+
+bool KeyframeAnim::KeyframeNode::sample(const ModelNode &node, float frame, bool useDelta, int *cursor, AnimPose &pose, int num) const {
+	if (_numEntries == 0)
+		return false;
+
+	int low = findEntry(frame, cursor);
 
 	float dt = frame - _entries[low]._frame;
 	Math::Vector3d pos = _entries[low]._pos;
@@ -281,16 +311,19 @@ bool KeyframeAnim::KeyframeNode::animate(ModelNode &node, float frame, float fad
 		roll += dt * _entries[low]._droll;
 	}
 
-	node._animPos += (pos - node._pos) * fade;
+	Math::Vector3d dpos = pos - node._pos;
+	pose._sample[AnimPose::PosX][num] = dpos.x();
+	pose._sample[AnimPose::PosY][num] = dpos.y();
+	pose._sample[AnimPose::PosZ][num] = dpos.z();
 
 	Math::Angle dpitch = pitch - node._pitch;
-	node._animPitch += dpitch.normalize(-180) * fade;
+	pose._sample[AnimPose::Pitch][num] = dpitch.normalize(-180).getDegrees();
 
 	Math::Angle dyaw = yaw - node._yaw;
-	node._animYaw += dyaw.normalize(-180) * fade;
+	pose._sample[AnimPose::Yaw][num] = dyaw.normalize(-180).getDegrees();
 
 	Math::Angle droll = roll - node._roll;
-	node._animRoll += droll.normalize(-180) * fade;
+	pose._sample[AnimPose::Roll][num] = droll.normalize(-180).getDegrees();
 
 	return true;
 }
@@ -23,6 +23,8 @@
 #ifndef GRIM_KEYFRAME_H
 #define GRIM_KEYFRAME_H
 
+#include "common/array.h"
+
 #include "math/vector3d.h"
 
 #include "engines/grim/object.h"
@@ -36,6 +38,31 @@ namespace Grim {
 class ModelNode;
 class TextSplitter;
 
+/**
+ * Blending state of a hierarchy, stored as one array per channel so that a
+ * priority layer is summed over contiguous floats instead of ModelNodes.
+ */
+struct AnimPose {
+	enum Channel {
+		PosX, PosY, PosZ, Pitch, Yaw, Roll,
+		NumChannels
+	};
+
+	AnimPose() : _numNodes(0) {}
+	void resize(int numNodes);
+
+	int _numNodes;
+	/** Offsets from the rest pose sampled from the last keyframe animation. */
+	Common::Array<float> _sample[NumChannels];
+	Common::Array<bool> _sampled;
+	/** Sum of the weighted samples of the current priority layer. */
+	Common::Array<float> _layer[NumChannels];
+	/** Blended result of the layers with a higher priority. */
+	Common::Array<float> _blended[NumChannels];
+	Common::Array<float> _totalWeight;
+	Common::Array<float> _remainingWeight;
+};
+
 class KeyframeAnim : public Object {
 public:
 	KeyframeAnim(const Common::String &filename, Common::SeekableReadStream *data);
@@ -43,10 +70,19 @@ public:
 
 	void loadBinary(Common::SeekableReadStream *data);
 	void loadText(TextSplitter &ts);
-	bool animate(ModelNode *nodes, int num, float time, float fade, bool tagged) const;
+	/**
+	 * Sample the animation for every node of the hierarchy into the _sample
+	 * channels of pose, and flag in _sampled the nodes it applies to. Nodes
+	 * whose remaining weight is used up are skipped. cursors may point to an
+	 * array of getNumJoints() entries, zeroed at first, where a playback keeps
+	 * the keyframe it reached for each node. Playing forward then finds
+	 * the next keyframe without a search.
+	 */
+	void sample(const ModelNode *nodes, float time, bool tagged, int *cursors, AnimPose &pose) const;
 	int getMarker(float startTime, float stopTime) const;
 
 	float getLength() const { return _numFrames / _fps; }
+	int getNumJoints() const { return _numJoints; }
 	const Common::String &getFilename() const { return _fname; }
 
 private:
@@ -83,7 +119,8 @@ private:
 		void loadText(TextSplitter &ts);
 		~KeyframeNode();
 
-		bool animate(ModelNode &node, float frame, float fade, bool useDelta) const;
+		bool sample(const ModelNode &node, float frame, bool useDelta, int *cursor, AnimPose &pose, int num) const;
+		int findEntry(float frame, int *cursor) const;
 
 		char _meshName[32];
 		int _numEntries;
@@ -343,17 +343,6 @@ void MeshFace::changeMaterial(Material *material) {
 	_material = material;
 }
 
-void MeshFace::draw(float *vertices, float *vertNormals, float *textureVerts) const {
-	if (_light == 0 && !g_driver->isShadowModeActive())
-		g_driver->disableLights();
-
-	_material->select();
-	g_driver->drawModelFace(this, vertices, vertNormals, textureVerts);
-
-	if (_light == 0 && !g_driver->isShadowModeActive())
-		g_driver->enableLights();
-}
-
 /**
  * @class Mesh
  */
@@ -425,6 +414,8 @@ void Mesh::loadBinary(Common::SeekableReadStream *data, Material *materials[]) {
 	data->read(f, 4);
 	_radius = get_float(f);
 	data->seek(24, SEEK_CUR);
+
+	sortFaces();
 }
 
 void Mesh::loadText(TextSplitter *ts, Material *materials[]) {
@@ -516,6 +507,8 @@ void Mesh::loadText(TextSplitter *ts, Material *materials[]) {
 		ts->scanString(" %d: %f %f %f", 4, &num, &x, &y, &z);
 		_faces[num]._normal = Math::Vector3d(x, y, z);
 	}
+
+	sortFaces();
 }
 
 void Mesh::update() {
@@ -526,14 +519,52 @@ void Mesh::changeMaterials(Material *materials[]) {
 		_faces[i].changeMaterial(materials[_materialid[i]]);
 }
 
+void Mesh::sortFaces() {
+	_drawOrder.clear();
+	for (int i = 0; i < _numFaces; i++) {
+		uint32 state = (_materialid[i] << 1) | (_faces[i]._light == 0 ? 1 : 0);
+		_drawOrder.add(DrawBucket::kPassOpaque, state, i);
+	}
+	_drawOrder.sort();
+}
+
 void Mesh::draw() const {
 	if (_lightingMode == 0)
 		g_driver->disableLights();
 
-	for (int i = 0; i < _numFaces; i++)
-		_faces[i].draw(_vertices, _vertNormals, _textureVerts);
+	GfxBase::RenderStats &stats = g_driver->getFrameStats();
+	const bool shadowMode = g_driver->isShadowModeActive();
+	const Material *material = NULL;
+	bool lightsOn = _lightingMode != 0;
+
+	// The faces are grouped by material and lighting, so that these only
+	// change between the groups.
+	g_driver->startMeshDraw(this);
+	for (uint i = 0; i < _drawOrder.size(); i++) {
+		const MeshFace &face = _faces[_drawOrder.getIndex(i)];
+
+		bool faceLit = _lightingMode != 0 && (face._light != 0 || shadowMode);
+		if (faceLit != lightsOn && !shadowMode) {
+			if (faceLit)
+				g_driver->enableLights();
+			else
+				g_driver->disableLights();
+			lightsOn = faceLit;
+			stats._stateChanges++;
+		}
 
-	if (_lightingMode == 0)
+		if (face._material != material) {
+			face._material->select();
+			material = face._material;
+			stats._materialChanges++;
+		}
+
+		g_driver->drawModelFace(this, &face);
+		stats._draws++;
+	}
+	g_driver->finishMeshDraw();
+
+	if (!lightsOn)
 		g_driver->enableLights();
 }
 
@@ -548,6 +579,32 @@ void Mesh::getBoundingBox(int *x1, int *y1, int *x2, int *y2) const {
 	}
 }
 
+bool Mesh::ScreenBounds::get(const float *modelView, const float *projection, const int *viewport,
+                             int *x1, int *y1, int *x2, int *y2) const {
+	if (!_valid || memcmp(_modelView, modelView, sizeof(_modelView)) != 0 ||
+	    memcmp(_projection, projection, sizeof(_projection)) != 0 ||
+	    memcmp(_viewport, viewport, sizeof(_viewport)) != 0)
+		return false;
+
+	*x1 = _x1;
+	*y1 = _y1;
+	*x2 = _x2;
+	*y2 = _y2;
+	return true;
+}
+
+void Mesh::ScreenBounds::set(const float *modelView, const float *projection, const int *viewport,
+                             int x1, int y1, int x2, int y2) {
+	memcpy(_modelView, modelView, sizeof(_modelView));
+	memcpy(_projection, projection, sizeof(_projection));
+	memcpy(_viewport, viewport, sizeof(_viewport));
+	_x1 = x1;
+	_y1 = y1;
+	_x2 = x2;
+	_y2 = y2;
+	_valid = true;
+}
+
 /**
  * @class ModelNode
  */
@@ -686,39 +743,65 @@ void ModelNode::removeChild(ModelNode *child) {
 }
 
 void ModelNode::setMatrix(const Math::Matrix4 &matrix) {
-	_matrix = matrix;
+	if (!(_parentMatrix == matrix)) {
+		_parentMatrix = matrix;
+		_dirty = true;
+	}
 	if (_sibling)
 		_sibling->setMatrix(matrix);
 }
 
+// Rebuild the local matrix if the animation moved the node since it was
+// last built, and return whether it did.
+bool ModelNode::updateLocalMatrix() {
+	Math::Vector3d animPos = _pos + _animPos;
+	Math::Angle animPitch = _pitch + _animPitch;
+	Math::Angle animYaw = _yaw + _animYaw;
+	Math::Angle animRoll = _roll + _animRoll;
+
+	if (_localBuilt && animPos == _localPos && animPitch.getDegrees() == _localPitch.getDegrees() &&
+	    animYaw.getDegrees() == _localYaw.getDegrees() && animRoll.getDegrees() == _localRoll.getDegrees())
+		return false;
+
+	_localPos = animPos;
+	_localPitch = animPitch;
+	_localYaw = animYaw;
+	_localRoll = animRoll;
+	_localBuilt = true;
+
+	_localMatrix.setPosition(animPos);
+	_localMatrix.buildFromPitchYawRoll(animPitch, animYaw, animRoll);
+	return true;
+}
+
 void ModelNode::update() {
 	if (!_initialized)
 		return;
 
-	if (_hierVisible && _needsUpdate) {
-		Math::Vector3d animPos = _pos + _animPos;
-		Math::Angle animPitch = _pitch + _animPitch;
-		Math::Angle animYaw = _yaw + _animYaw;
-		Math::Angle animRoll = _roll + _animRoll;
+	if (_hierVisible) {
+		if (updateLocalMatrix())
+			_dirty = true;
 
-		_localMatrix.setPosition(animPos);
-		_localMatrix.buildFromPitchYawRoll(animPitch, animYaw, animRoll);
+		if (_dirty) {
+			_matrix = _parentMatrix * _localMatrix;
 
-		_matrix = _matrix * _localMatrix;
+			_pivotMatrix = _matrix;
+			_pivotMatrix.translate(_pivot);
 
-		_pivotMatrix = _matrix;
-		_pivotMatrix.translate(_pivot);
+			if (_mesh) {
+				_mesh->_matrix = _pivotMatrix;
+			}
 
-		if (_mesh) {
-			_mesh->_matrix = _pivotMatrix;
+			if (_child) {
+				_child->setMatrix(_matrix);
+			}
+
+			_dirty = false;
 		}
 
 		if (_child) {
-			_child->setMatrix(_matrix);
 			_child->update();
 		}
-
-		_needsUpdate = false;
 	}
 
 	if (_sibling) {
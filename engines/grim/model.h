@@ -24,6 +24,7 @@
 #define GRIM_MODEL_H
 
 #include "engines/grim/object.h"
+#include "engines/grim/draw_bucket.h"
 #include "math/matrix4.h"
 
 namespace Common {
@@ -91,7 +92,6 @@ public:
 class MeshFace {
 public:
 	int loadBinary(Common::SeekableReadStream *data, Material *materials[]);
-	void draw(float *vertices, float *vertNormals, float *textureVerts) const;
 	void changeMaterial(Material *material);
 	~MeshFace();
 
@@ -111,6 +111,7 @@ public:
 	void draw() const;
 	void getBoundingBox(int *x1, int *y1, int *x2, int *y2) const;
 	void update();
+	void sortFaces();
 	Mesh();
 	~Mesh();
 
@@ -129,19 +130,49 @@ public:
 
 	int _numFaces;
 	MeshFace *_faces;
+	// The faces sorted by material and lighting
+	DrawBucket _drawOrder;
 	Math::Matrix4 _matrix;
+
+	/**
+	 * The screen bounding box computed by the last GfxBase::getBoundingBoxPos()
+	 * call, together with the matrices and viewport the mesh was projected with.
+	 */
+	struct ScreenBounds {
+		ScreenBounds() : _valid(false) { }
+		bool get(const float *modelView, const float *projection, const int *viewport,
+		         int *x1, int *y1, int *x2, int *y2) const;
+		void set(const float *modelView, const float *projection, const int *viewport,
+		         int x1, int y1, int x2, int y2);
+
+		bool _valid;
+		float _modelView[16];
+		float _projection[16];
+		int _viewport[4];
+		int _x1, _y1, _x2, _y2;
+	};
+	mutable ScreenBounds _screenBounds;
 };
 
 class ModelNode {
 public:
-	ModelNode() : _initialized(false), _needsUpdate(true) { }
+	ModelNode() : _initialized(false), _dirty(true), _localBuilt(false) { }
 	~ModelNode();
 	void loadBinary(Common::SeekableReadStream *data, ModelNode *hierNodes, const Model::Geoset *g);
 	void draw() const;
 	void getBoundingBox(int *x1, int *y1, int *x2, int *y2) const;
 	void addChild(ModelNode *child);
 	void removeChild(ModelNode *child);
+	/**
+	 * Set the world matrix of the parent of this node and its siblings.
+	 * Nodes whose parent matrix changed are marked dirty.
+	 */
 	void setMatrix(const Math::Matrix4 &matrix);
+	/**
+	 * Bring the world matrices of this node, its children and its siblings
+	 * up to date. Only the nodes that were animated or whose parent moved
+	 * since the last update are recomputed.
+	 */
 	void update();
 	void addSprite(Sprite *sprite);
 	void removeSprite(Sprite *sprite);
@@ -172,11 +203,21 @@ public:
 	Math::Angle _animPitch, _animYaw, _animRoll;
 	bool _meshVisible, _hierVisible;
 	bool _initialized;
-	bool _needsUpdate;
+	/** The world matrix is out of date because the parent matrix changed. */
+	bool _dirty;
+	Math::Matrix4 _parentMatrix;
 	Math::Matrix4 _matrix;
 	Math::Matrix4 _localMatrix;
 	Math::Matrix4 _pivotMatrix;
 	Sprite *_sprite;
+
+private:
+	bool updateLocalMatrix();
+
+	// The animated transform _localMatrix was last built from.
+	bool _localBuilt;
+	Math::Vector3d _localPos;
+	Math::Angle _localPitch, _localYaw, _localRoll;
 };
 
 } // end of namespace Grim
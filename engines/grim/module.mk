@@ -85,11 +85,13 @@ MODULE_OBJS := \
 	actor.o \
 	animation.o \
 	bitmap.o \
+	blitimage.o \
 	costume.o \
 	color.o \
 	colormap.o \
 	debug.o \
 	detection.o \
+	draw_bucket.o \
 	font.o \
 	gfx_base.o \
 	gfx_opengl.o \
@@ -38,6 +38,7 @@ MoviePlayer *CreateBinkPlayer(bool demo) {
 
 BinkPlayer::BinkPlayer(bool demo) : MoviePlayer(), _demo(demo) {
 	_videoDecoder = new Video::BinkDecoder();
+	_videoDecoder->setDecodeAhead(4);
 }
 
 bool BinkPlayer::loadFile(const Common::String &filename) {
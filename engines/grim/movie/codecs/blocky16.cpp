@@ -26,6 +26,16 @@
 
 #include "engines/grim/movie/codecs/blocky16.h"
 
+// The vectorized block operations write 16 bit pixels lane by lane, so they
+// are only enabled on little endian targets.
+#if !defined(SCUMM_BIG_ENDIAN) && defined(__SSE2__)
+#include <emmintrin.h>
+#define BLOCKY16_SSE2
+#elif !defined(SCUMM_BIG_ENDIAN) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#define BLOCKY16_NEON
+#endif
+
 namespace Grim {
 
 #if defined(SCUMM_NEED_ALIGNMENT)
@@ -156,6 +166,232 @@ static int8 blocky16_table[] = {
 	  0,   0,   0
 };
 
+/**
+ * Block operations used by level1() and level2() for 8x8 and 4x4 blocks.
+ * The copy offset is relative to the destination, in bytes; the fill value
+ * holds the same 16 bit pixel twice; the pattern value holds the colour of
+ * the first pixel list in its low and the colour of the second list in its
+ * high 16 bits.
+ */
+struct ScalarBlockOps {
+	static inline void copyBlock8(byte *d_dst, int32 offset, int pitch) {
+		for (int i = 0; i < 8; i++) {
+			COPY_4X1_LINE(d_dst +  0, d_dst + offset +  0);
+			COPY_4X1_LINE(d_dst +  4, d_dst + offset +  4);
+			COPY_4X1_LINE(d_dst +  8, d_dst + offset +  8);
+			COPY_4X1_LINE(d_dst + 12, d_dst + offset + 12);
+			d_dst += pitch;
+		}
+	}
+
+	static inline void copyBlock4(byte *d_dst, int32 offset, int pitch) {
+		for (int i = 0; i < 4; i++) {
+			COPY_4X1_LINE(d_dst +  0, d_dst + offset +  0);
+			COPY_4X1_LINE(d_dst +  4, d_dst + offset +  4);
+			d_dst += pitch;
+		}
+	}
+
+	static inline void fillBlock8(byte *d_dst, uint32 t, int pitch) {
+		for (int i = 0; i < 8; i++) {
+			WRITE_4X1_LINE(d_dst +  0, t);
+			WRITE_4X1_LINE(d_dst +  4, t);
+			WRITE_4X1_LINE(d_dst +  8, t);
+			WRITE_4X1_LINE(d_dst + 12, t);
+			d_dst += pitch;
+		}
+	}
+
+	static inline void fillBlock4(byte *d_dst, uint32 t, int pitch) {
+		for (int i = 0; i < 4; i++) {
+			WRITE_4X1_LINE(d_dst + 0, t);
+			WRITE_4X1_LINE(d_dst + 4, t);
+			d_dst += pitch;
+		}
+	}
+
+	static inline void patternBlock8(byte *d_dst, const byte *tmp_ptr, const uint32 *mask, uint32 val, int pitch) {
+		byte l = tmp_ptr[384];
+		const int16 *tmp_ptr2 = (const int16 *)tmp_ptr;
+		while (l--) {
+			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
+			tmp_ptr2++;
+		}
+		l = tmp_ptr[385];
+		val >>= 16;
+		tmp_ptr2 = (const int16 *)(tmp_ptr + 128);
+		while (l--) {
+			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
+			tmp_ptr2++;
+		}
+	}
+
+	static inline void patternBlock4(byte *d_dst, const byte *tmp_ptr, uint16 mask, uint32 val, int pitch) {
+		byte l = tmp_ptr[96];
+		const int16 *tmp_ptr2 = (const int16 *)tmp_ptr;
+		while (l--) {
+			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
+			tmp_ptr2++;
+		}
+		l = tmp_ptr[97];
+		val >>= 16;
+		tmp_ptr2 = (const int16 *)(tmp_ptr + 32);
+		while (l--) {
+			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
+			tmp_ptr2++;
+		}
+	}
+};
+
+#if defined(BLOCKY16_SSE2)
+
+struct SIMDBlockOps {
+	static inline void copyBlock8(byte *d_dst, int32 offset, int pitch) {
+		// A source overlapping the destination row has to be copied in
+		// the same order as the plain C version.
+		if (offset > -16 && offset < 16) {
+			ScalarBlockOps::copyBlock8(d_dst, offset, pitch);
+			return;
+		}
+		for (int i = 0; i < 8; i++) {
+			_mm_storeu_si128((__m128i *)d_dst, _mm_loadu_si128((const __m128i *)(d_dst + offset)));
+			d_dst += pitch;
+		}
+	}
+
+	static inline void copyBlock4(byte *d_dst, int32 offset, int pitch) {
+		if (offset > -8 && offset < 8) {
+			ScalarBlockOps::copyBlock4(d_dst, offset, pitch);
+			return;
+		}
+		for (int i = 0; i < 4; i++) {
+			_mm_storel_epi64((__m128i *)d_dst, _mm_loadl_epi64((const __m128i *)(d_dst + offset)));
+			d_dst += pitch;
+		}
+	}
+
+	static inline void fillBlock8(byte *d_dst, uint32 t, int pitch) {
+		const __m128i v = _mm_set1_epi32((int)t);
+		for (int i = 0; i < 8; i++) {
+			_mm_storeu_si128((__m128i *)d_dst, v);
+			d_dst += pitch;
+		}
+	}
+
+	static inline void fillBlock4(byte *d_dst, uint32 t, int pitch) {
+		const __m128i v = _mm_set1_epi32((int)t);
+		for (int i = 0; i < 4; i++) {
+			_mm_storel_epi64((__m128i *)d_dst, v);
+			d_dst += pitch;
+		}
+	}
+
+	// Expands eight mask bits into eight pixels of either colour.
+	static inline __m128i selectPixels(uint32 bits, __m128i colA, __m128i colB) {
+		const __m128i laneBits = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+		__m128i sel = _mm_set1_epi16((short)bits);
+		sel = _mm_cmpeq_epi16(_mm_and_si128(sel, laneBits), laneBits);
+		return _mm_or_si128(_mm_and_si128(sel, colA), _mm_andnot_si128(sel, colB));
+	}
+
+	static inline void patternBlock8(byte *d_dst, const byte *tmp_ptr, const uint32 *mask, uint32 val, int pitch) {
+		const __m128i colA = _mm_set1_epi16((short)(val & 0xFFFF));
+		const __m128i colB = _mm_set1_epi16((short)(val >> 16));
+		for (int i = 0; i < 8; i++) {
+			uint32 bits = (mask[i >> 2] >> ((i & 3) * 8)) & 0xFF;
+			_mm_storeu_si128((__m128i *)d_dst, selectPixels(bits, colA, colB));
+			d_dst += pitch;
+		}
+	}
+
+	static inline void patternBlock4(byte *d_dst, const byte *tmp_ptr, uint16 mask, uint32 val, int pitch) {
+		const __m128i colA = _mm_set1_epi16((short)(val & 0xFFFF));
+		const __m128i colB = _mm_set1_epi16((short)(val >> 16));
+		// Two rows of four pixels per register.
+		for (int i = 0; i < 4; i += 2) {
+			__m128i pixels = selectPixels((mask >> (i * 4)) & 0xFF, colA, colB);
+			_mm_storel_epi64((__m128i *)d_dst, pixels);
+			_mm_storel_epi64((__m128i *)(d_dst + pitch), _mm_srli_si128(pixels, 8));
+			d_dst += pitch * 2;
+		}
+	}
+};
+
+#elif defined(BLOCKY16_NEON)
+
+struct SIMDBlockOps {
+	static inline void copyBlock8(byte *d_dst, int32 offset, int pitch) {
+		// A source overlapping the destination row has to be copied in
+		// the same order as the plain C version.
+		if (offset > -16 && offset < 16) {
+			ScalarBlockOps::copyBlock8(d_dst, offset, pitch);
+			return;
+		}
+		for (int i = 0; i < 8; i++) {
+			vst1q_u8(d_dst, vld1q_u8(d_dst + offset));
+			d_dst += pitch;
+		}
+	}
+
+	static inline void copyBlock4(byte *d_dst, int32 offset, int pitch) {
+		if (offset > -8 && offset < 8) {
+			ScalarBlockOps::copyBlock4(d_dst, offset, pitch);
+			return;
+		}
+		for (int i = 0; i < 4; i++) {
+			vst1_u8(d_dst, vld1_u8(d_dst + offset));
+			d_dst += pitch;
+		}
+	}
+
+	static inline void fillBlock8(byte *d_dst, uint32 t, int pitch) {
+		const uint8x16_t v = vreinterpretq_u8_u32(vdupq_n_u32(t));
+		for (int i = 0; i < 8; i++) {
+			vst1q_u8(d_dst, v);
+			d_dst += pitch;
+		}
+	}
+
+	static inline void fillBlock4(byte *d_dst, uint32 t, int pitch) {
+		const uint8x8_t v = vreinterpret_u8_u32(vdup_n_u32(t));
+		for (int i = 0; i < 4; i++) {
+			vst1_u8(d_dst, v);
+			d_dst += pitch;
+		}
+	}
+
+	// Expands eight mask bits into eight pixels of either colour.
+	static inline uint16x8_t selectPixels(uint32 bits, uint16x8_t colA, uint16x8_t colB) {
+		static const uint16 laneBits[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+		uint16x8_t sel = vtstq_u16(vdupq_n_u16((uint16)bits), vld1q_u16(laneBits));
+		return vbslq_u16(sel, colA, colB);
+	}
+
+	static inline void patternBlock8(byte *d_dst, const byte *tmp_ptr, const uint32 *mask, uint32 val, int pitch) {
+		const uint16x8_t colA = vdupq_n_u16((uint16)(val & 0xFFFF));
+		const uint16x8_t colB = vdupq_n_u16((uint16)(val >> 16));
+		for (int i = 0; i < 8; i++) {
+			uint32 bits = (mask[i >> 2] >> ((i & 3) * 8)) & 0xFF;
+			vst1q_u8(d_dst, vreinterpretq_u8_u16(selectPixels(bits, colA, colB)));
+			d_dst += pitch;
+		}
+	}
+
+	static inline void patternBlock4(byte *d_dst, const byte *tmp_ptr, uint16 mask, uint32 val, int pitch) {
+		const uint16x8_t colA = vdupq_n_u16((uint16)(val & 0xFFFF));
+		const uint16x8_t colB = vdupq_n_u16((uint16)(val >> 16));
+		// Two rows of four pixels per register.
+		for (int i = 0; i < 4; i += 2) {
+			uint8x16_t pixels = vreinterpretq_u8_u16(selectPixels((mask >> (i * 4)) & 0xFF, colA, colB));
+			vst1_u8(d_dst, vget_low_u8(pixels));
+			vst1_u8(d_dst + pitch, vget_high_u8(pixels));
+			d_dst += pitch * 2;
+		}
+	}
+};
+
+#endif
+
 void Blocky16::makeTablesInterpolation(int param) {
 	int32 variable1, variable2;
 	int32 b1, b2;
@@ -287,10 +523,13 @@ void Blocky16::makeTablesInterpolation(int param) {
 			}
 
 			if (param == 8) {
+				uint32 *mask = _patternMasksBig[s / 388];
+				mask[0] = mask[1] = 0;
 				for (i = 64 - 1; i >= 0; i--) {
 					if (tableSmallBig[i] != 0) {
 						_tableBig[256 + s + _tableBig[384 + s]] = (byte)i;
 						_tableBig[384 + s]++;
+						mask[i >> 5] |= 1U << (i & 31);
 					} else {
 						_tableBig[320 + s + _tableBig[385 + s]] = (byte)i;
 						_tableBig[385 + s]++;
@@ -299,10 +538,13 @@ void Blocky16::makeTablesInterpolation(int param) {
 				s += 388;
 			}
 			if (param == 4) {
+				uint16 &mask = _patternMasksSmall[s / 128];
+				mask = 0;
 				for (i = 16 - 1; i >= 0; i--) {
 					if (tableSmallBig[i] != 0) {
 						_tableSmall[64 + s + _tableSmall[96 + s]] = (byte)i;
 						_tableSmall[96 + s]++;
+						mask |= 1 << i;
 					} else {
 						_tableSmall[80 + s + _tableSmall[97 + s]] = (byte)i;
 						_tableSmall[97 + s]++;
@@ -427,11 +669,11 @@ void Blocky16::level3(byte *d_dst) {
 	}
 }
 
+template<class BlockOps>
 void Blocky16::level2(byte *d_dst) {
 	int32 tmp2;
 	uint32 t = 0, val;
 	byte code = *_d_src++;
-	int i;
 
 	if (code <= 0xF5) {
 		if (code == 0xF5) {
@@ -442,11 +684,7 @@ void Blocky16::level2(byte *d_dst) {
 			tmp2 = _table[code] * 2;
 		}
 		tmp2 += _offset1;
-		for (i = 0; i < 4; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			d_dst += _d_pitch;
-		}
+		BlockOps::copyBlock4(d_dst, tmp2, _d_pitch);
 	} else if (code == 0xFF) {
 		level3(d_dst);
 		d_dst += 4;
@@ -456,12 +694,7 @@ void Blocky16::level2(byte *d_dst) {
 		d_dst += 4;
 		level3(d_dst);
 	} else if (code == 0xF6) {
-		tmp2 = _offset2;
-		for (i = 0; i < 4; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			d_dst += _d_pitch;
-		}
+		BlockOps::copyBlock4(d_dst, _offset2, _d_pitch);
 	} else if ((code == 0xF7) || (code == 0xF8)) {
 		byte tmp = *_d_src++;
 		if (code == 0xF8) {
@@ -473,20 +706,7 @@ void Blocky16::level2(byte *d_dst) {
 			val |= READ_LE_UINT16(_param6_7Ptr + (byte)tmp2 * 2);
 			_d_src += 2;
 		}
-		byte *tmp_ptr = _tableSmall + (tmp * 128);
-		byte l = tmp_ptr[96];
-		int16 *tmp_ptr2 = (int16 *)tmp_ptr;
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
-		l = tmp_ptr[97];
-		val >>= 16;
-		tmp_ptr2 = (int16 *)(tmp_ptr + 32);
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
+		BlockOps::patternBlock4(d_dst, _tableSmall + (tmp * 128), _patternMasksSmall[tmp], val, _d_pitch);
 	} else if (code >= 0xF9) {
 		if (code == 0xFD) {
 			t = *_d_src++;
@@ -500,19 +720,15 @@ void Blocky16::level2(byte *d_dst) {
 			t = READ_LE_UINT16(_paramPtr + code * 2);
 			t = (t << 16) | t;
 		}
-		for (i = 0; i < 4; i++) {
-			WRITE_4X1_LINE(d_dst + 0, t);
-			WRITE_4X1_LINE(d_dst + 4, t);
-			d_dst += _d_pitch;
-		}
+		BlockOps::fillBlock4(d_dst, t, _d_pitch);
 	}
 }
 
+template<class BlockOps>
 void Blocky16::level1(byte *d_dst) {
 	int32 tmp2;
 	uint32 t = 0, val;
 	byte code = *_d_src++;
-	int i;
 
 	if (code <= 0xF5) {
 		if (code == 0xF5) {
@@ -523,30 +739,17 @@ void Blocky16::level1(byte *d_dst) {
 			tmp2 = _table[code] * 2;
 		}
 		tmp2 += _offset1;
-		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			COPY_4X1_LINE(d_dst +  8, d_dst + tmp2 +  8);
-			COPY_4X1_LINE(d_dst + 12, d_dst + tmp2 + 12);
-			d_dst += _d_pitch;
-		}
+		BlockOps::copyBlock8(d_dst, tmp2, _d_pitch);
 	} else if (code == 0xFF) {
-		level2(d_dst);
+		level2<BlockOps>(d_dst);
 		d_dst += 8;
-		level2(d_dst);
+		level2<BlockOps>(d_dst);
 		d_dst += _d_pitch * 4 - 8;
-		level2(d_dst);
+		level2<BlockOps>(d_dst);
 		d_dst += 8;
-		level2(d_dst);
+		level2<BlockOps>(d_dst);
 	} else if (code == 0xF6) {
-		tmp2 = _offset2;
-		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			COPY_4X1_LINE(d_dst +  8, d_dst + tmp2 +  8);
-			COPY_4X1_LINE(d_dst + 12, d_dst + tmp2 + 12);
-			d_dst += _d_pitch;
-		}
+		BlockOps::copyBlock8(d_dst, _offset2, _d_pitch);
 	} else if ((code == 0xF7) || (code == 0xF8)) {
 		byte tmp = *_d_src++;
 		if (code == 0xF8) {
@@ -558,20 +761,7 @@ void Blocky16::level1(byte *d_dst) {
 			val |= READ_LE_UINT16(_param6_7Ptr + (byte)tmp2 * 2);
 			_d_src += 2;
 		}
-		byte *tmp_ptr = _tableBig + (tmp * 388);
-		byte l = tmp_ptr[384];
-		int16 *tmp_ptr2 = (int16 *)tmp_ptr;
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
-		l = tmp_ptr[385];
-		val >>= 16;
-		tmp_ptr2 = (int16 *)(tmp_ptr + 128);
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
+		BlockOps::patternBlock8(d_dst, _tableBig + (tmp * 388), _patternMasksBig[tmp], val, _d_pitch);
 	} else if (code >= 0xF9) {
 		if (code == 0xFD) {
 			t = *_d_src++;
@@ -585,34 +775,48 @@ void Blocky16::level1(byte *d_dst) {
 			t = READ_LE_UINT16(_paramPtr + code * 2);
 			t = (t << 16) | t;
 		}
-		for (i = 0; i < 8; i++) {
-			WRITE_4X1_LINE(d_dst +  0, t);
-			WRITE_4X1_LINE(d_dst +  4, t);
-			WRITE_4X1_LINE(d_dst +  8, t);
-			WRITE_4X1_LINE(d_dst + 12, t);
-			d_dst += _d_pitch;
-		}
+		BlockOps::fillBlock8(d_dst, t, _d_pitch);
 	}
 }
 
-void Blocky16::decode2(byte *dst, const byte *src, int width, int height, const byte *param_ptr, const byte *param6_7_ptr) {
-	_d_src = src;
-	_paramPtr = param_ptr - 0xf9 - 0xf9;
-	_param6_7Ptr = param6_7_ptr;
+template<class BlockOps>
+void Blocky16::decodeBlocks(byte *dst, int width) {
 	int bh = _blocksHeight;
 	int next_line = width * 2 * 7;
-	_d_pitch = width * 2;
 
 	do {
 		int tmp_bw = _blocksWidth;
 		do {
-			level1(dst);
+			level1<BlockOps>(dst);
 			dst += 16;
 		} while (--tmp_bw);
 		dst += next_line;
 	} while (--bh);
 }
 
+void Blocky16::decode2(byte *dst, const byte *src, int width, int height, const byte *param_ptr, const byte *param6_7_ptr) {
+	_d_src = src;
+	_paramPtr = param_ptr - 0xf9 - 0xf9;
+	_param6_7Ptr = param6_7_ptr;
+	_d_pitch = width * 2;
+
+#if defined(BLOCKY16_SSE2) || defined(BLOCKY16_NEON)
+	if (_useSIMD) {
+		decodeBlocks<SIMDBlockOps>(dst, width);
+		return;
+	}
+#endif
+	decodeBlocks<ScalarBlockOps>(dst, width);
+}
+
+bool Blocky16::hasSIMD() {
+#if defined(BLOCKY16_SSE2) || defined(BLOCKY16_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
+
 void Blocky16::init(int width, int height) {
 	deinit();
 	_width = width;
@@ -644,6 +848,7 @@ Blocky16::Blocky16() {
 	memset(_tableBig, 0, 99328);
 	memset(_tableSmall, 0, 32768);
 	_deltaBuf = NULL;
+	_useSIMD = hasSIMD();
 }
 
 void Blocky16::deinit() {
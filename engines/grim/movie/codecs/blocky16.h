@@ -46,12 +46,19 @@ private:
 	int _offset;
 	int _width, _height;
 	int _blocksWidth, _blocksHeight;
+	// One bit per pixel of each two-colour pattern, set for pixels taking
+	// the first colour. Used by the vectorized block path instead of the
+	// width dependent offset lists.
+	uint32 _patternMasksBig[256][2];
+	uint16 _patternMasksSmall[256];
+	bool _useSIMD;
 
 	void makeTablesInterpolation(int param);
 	void makeTables47(int width);
-	void level1(byte *d_dst);
-	void level2(byte *d_dst);
+	template<class BlockOps> void level1(byte *d_dst);
+	template<class BlockOps> void level2(byte *d_dst);
 	void level3(byte *d_dst);
+	template<class BlockOps> void decodeBlocks(byte *dst, int width);
 	void decode2(byte *dst, const byte *src, int width, int height, const byte *param_ptr, const byte *param6_7_ptr);
 
 public:
@@ -60,6 +67,20 @@ public:
 	void init(int width, int height);
 	void deinit();
 	void decode(byte *dst, const byte *src);
+
+	/**
+	 * Returns true if this build has a vectorized implementation of the
+	 * block copy, fill and pattern operations.
+	 */
+	static bool hasSIMD();
+
+	/**
+	 * Select between the vectorized and the plain C block operations.
+	 * The vectorized ones are used by default when available; both
+	 * produce identical output.
+	 */
+	void setSIMD(bool enable) { _useSIMD = enable && hasSIMD(); }
+	bool isSIMD() const { return _useSIMD; }
 };
 
 } // end of namespace Grim
@@ -54,7 +54,8 @@ SmushDecoder::SmushDecoder() {
 
 	_videoLooping = false;
 	_startPos = 0;
-	_frames = NULL;
+	_frameIndex = &_ownFrameIndex;
+	_audioStart = 0;
 
 	_videoTrack = NULL;
 	_audioTrack = NULL;
@@ -64,7 +65,6 @@ SmushDecoder::SmushDecoder() {
 SmushDecoder::~SmushDecoder() {
 	delete _videoTrack;
 	delete _audioTrack;
-	delete[] _frames;
 }
 
 void SmushDecoder::init() {
@@ -72,15 +72,19 @@ void SmushDecoder::init() {
 	_audioTrack->init();
 }
 
+void SmushDecoder::setFrameIndex(SmushFrameIndex *frameIndex) {
+	_frameIndex = frameIndex ? frameIndex : &_ownFrameIndex;
+}
+
 void SmushDecoder::initFrames() {
-	delete[] _frames;
-	_frames = new Frame[_videoTrack->getFrameCount()];
+	Common::Array<SmushFrameIndex::Frame> &frames = _frameIndex->_frames;
+	frames.resize(_videoTrack->getFrameCount());
 
 	int seekPos = _file->pos();
 	int curFrame = -1;
 	_file->seek(_startPos, SEEK_SET);
 	while (curFrame < _videoTrack->getFrameCount() - 1) {
-		Frame &frame = _frames[++curFrame];
+		SmushFrameIndex::Frame &frame = frames[++curFrame];
 		frame.frame = curFrame;
 		frame.pos = _file->pos();
 		frame.keyframe = false;
@@ -122,8 +126,9 @@ void SmushDecoder::close() {
 	_videoTrack = NULL;
 	_videoLooping = false;
 	_startPos = 0;
-	delete[] _frames;
-	_frames = NULL;
+	_ownFrameIndex._frames.clear();
+	_frameIndex = &_ownFrameIndex;
+	_audioStart = 0;
 	if (_file) {
 		delete _file;
 		_file = NULL;
@@ -353,7 +358,9 @@ void SmushDecoder::handleFRME(Common::SeekableReadStream *stream, uint32 size) {
 			_videoTrack->handleBlocky16(memStream, subSize);
 			break;
 		case MKTAG('W', 'a', 'v', 'e'):
-			_audioTrack->handleVIMA(memStream, blockSize);
+			// While seeking, the audio of frames far before the target is thrown away anyway
+			if (_videoTrack->getCurFrame() + 1 >= _audioStart)
+				_audioTrack->handleVIMA(memStream, blockSize);
 			break;
 			// Demo only:
 		case MKTAG('F', 'O', 'B', 'J'):
@@ -390,14 +397,16 @@ bool SmushDecoder::seek(const Audio::Timestamp &time) {
 		return false;
 	}
 
-	if (!_frames) {
+	// The index is only built once per file, see setFrameIndex()
+	if (_frameIndex->_frames.empty()) {
 		initFrames();
 	}
+	const Common::Array<SmushFrameIndex::Frame> &frames = _frameIndex->_frames;
 
 	// Track down the keyframe
 	int keyframe = 0;
 	for (int i = wantedFrame; i >= 0; --i) {
-		if (_frames[i].keyframe) {
+		if (frames[i].keyframe) {
 			keyframe = i;
 			break;
 		}
@@ -405,31 +414,38 @@ bool SmushDecoder::seek(const Audio::Timestamp &time) {
 	_videoTrack->setFrameStart(keyframe);
 
 	// VIMA frames are 50 frames ahead of time, so we have to make sure we have 50 frames
-	// of audio before the wantedFrame. Here we use 51 to have a bit of safe margin
-	if (wantedFrame - keyframe < 51) {
-		keyframe = wantedFrame - 51;
-	}
-	if (keyframe < 0) {
-		keyframe = 0;
+	// of audio before the wantedFrame. Here we use 51 to have a bit of safe margin.
+	// Any audio before that is skipped below, so don't even decode it.
+	int audioStart = MAX(wantedFrame - 51, 0);
+	if (keyframe > audioStart) {
+		keyframe = audioStart;
 	}
 
-	_file->seek(_frames[keyframe].pos, SEEK_SET);
+	// Fast-forward to the frame before wantedFrame, without decoding audio that
+	// would be skipped and without converting frames that are never shown.
+	_audioStart = audioStart;
+	_videoTrack->setConvertStart(wantedFrame - 1);
+
+	_file->seek(frames[keyframe].pos, SEEK_SET);
 	_videoTrack->setCurFrame(keyframe - 1);
 
 	while (_videoTrack->getCurFrame() < wantedFrame - 1) {
 		decodeNextFrame();
 	}
 
+	_audioStart = 0;
+	_videoTrack->setConvertStart(0);
+
 	// As said, VIMA is 50 frames ahead of time. Every frame it pushes 1470 samples, and 50 * 1470 = 73500.
 	// The first frame, instead of 1470, it pushes 73500 samples to have this 50-frames-time.
-	// So if we have used frame 0 as keyframe we can remove safely time * rate samples, and we will
-	// still have the 50 frames margin. If we have used a later frame as keyframe we don't have the 73500
+	// So if we have decoded audio from frame 0 we can remove safely time * rate samples, and we will
+	// still have the 50 frames margin. If we have started the audio at a later frame we don't have the 73500
 	// samples pushed the first frame, so we have to be careful not to remove too much data,
 	// otherwise the audio will start at a later point. (72030 == 73500 - 1470)
-	int offset = (keyframe == 0 ? 0 : 72030);
+	int offset = (audioStart == 0 ? 0 : 72030);
 
-	// Skip decoded audio between the keyframe and the target frame
-	Audio::Timestamp delay = _videoTrack->getFrameTime(_videoTrack->getCurFrame()) - _videoTrack->getFrameTime(keyframe);
+	// Skip decoded audio between the first frame with audio and the target frame
+	Audio::Timestamp delay = _videoTrack->getFrameTime(_videoTrack->getCurFrame()) - _videoTrack->getFrameTime(audioStart);
 
 	int32 sampleCount = (delay.msecs() / 1000.f) * _audioTrack->getRate() - offset;
 	_audioTrack->skipSamples(sampleCount);
@@ -455,6 +471,7 @@ SmushDecoder::SmushVideoTrack::SmushVideoTrack(int width, int height, int fps, i
 	_height = height;
 	_nbframes = numFrames;
 	_is16Bit = is16Bit;
+	_convertStart = 0;
 	_x = 0;
 	_y = 0;
 	setMsPerFrame(fps);
@@ -481,7 +498,8 @@ void SmushDecoder::SmushVideoTrack::init() {
 }
 
 void SmushDecoder::SmushVideoTrack::finishFrame() {
-	if (!_is16Bit) {
+	// Blocky8 rewrites the whole frame, so frames skipped while seeking need no conversion
+	if (!_is16Bit && _curFrame + 1 >= _convertStart) {
 		convertDemoFrame();
 	}
 	_curFrame++;
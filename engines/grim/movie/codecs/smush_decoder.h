@@ -23,6 +23,8 @@
 #ifndef GRIM_SMUSH_DECODER_H
 #define GRIM_SMUSH_DECODER_H
 
+#include "common/array.h"
+
 #include "audio/audiostream.h"
 
 #include "video/video_decoder.h"
@@ -38,6 +40,19 @@ namespace Grim {
 class Blocky8;
 class Blocky16;
 
+/**
+ * The position and keyframe flag of every frame of a SMUSH movie,
+ * built on the first seek and shared between all loads of the file.
+ */
+struct SmushFrameIndex {
+	struct Frame {
+		int frame;
+		int pos;
+		bool keyframe;
+	};
+	Common::Array<Frame> _frames;
+};
+
 class SmushDecoder : public Video::VideoDecoder {
 public:
 	SmushDecoder();
@@ -52,6 +67,13 @@ public:
 	bool seek(const Audio::Timestamp &time);
 	bool loadStream(Common::SeekableReadStream *stream);
 
+	/**
+	 * Use a frame index that outlives this decoder, e.g. one cached by the
+	 * ResourceLoader. If it is still empty, it will be filled on the first
+	 * seek. This must be called after loadStream().
+	 */
+	void setFrameIndex(SmushFrameIndex *frameIndex);
+
 protected:
 	bool readHeader();
 	void handleFrameDemo();
@@ -79,6 +101,7 @@ protected:
 		bool isSeekable() const { return true; }
 		bool seek(const Audio::Timestamp &time) { return true; }
 		void setFrameStart(int frame);
+		void setConvertStart(int frame) { _convertStart = frame; }
 
 		void handleBlocky16(Common::SeekableReadStream *stream, uint32 size);
 		void handleFrameObject(Common::SeekableReadStream *stream, uint32 size);
@@ -102,6 +125,7 @@ protected:
 		Blocky16 *_blocky16;
 		int32 _nbframes;
 		int _frameStart;
+		int _convertStart;
 	};
 
 	class SmushAudioTrack : public AudioTrack {
@@ -138,12 +162,9 @@ private:
 
 	bool _videoPause;
 	bool _videoLooping;
-	struct Frame {
-		int frame;
-		int pos;
-		bool keyframe;
-	};
-	Frame *_frames;
+	SmushFrameIndex *_frameIndex;
+	SmushFrameIndex _ownFrameIndex;
+	int _audioStart;
 	static bool _demo;
 };
 
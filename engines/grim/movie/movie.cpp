@@ -22,6 +22,7 @@
 
 #include "graphics/surface.h"
 
+#include "common/profiler.h"
 #include "common/system.h"
 #include "common/timer.h"
 
@@ -40,14 +41,18 @@ MoviePlayer::MoviePlayer() {
 	_videoFinished = false;
 	_videoLooping = false;
 	_videoPause = true;
-	_updateNeeded = false;
 	_movieTime = 0;
 	_frame = -1;
 	_x = 0;
 	_y = 0;
 	_videoDecoder = NULL;
-	_internalSurface = NULL;
-	_externalSurface = new Graphics::Surface();
+	_writeBuffer = 0;
+	_readyBuffer = 1;
+	_readBuffer = 2;
+	for (int i = 0; i < 3; i++)
+		_heldFrames[i] = NULL;
+	_readyGeneration = 0;
+	_readGeneration = 0;
 	_timerStarted = false;
 }
 
@@ -58,8 +63,14 @@ MoviePlayer::~MoviePlayer() {
 		g_system->getTimerManager()->removeTimerProc(&timerCallback);
 
 	deinit();
+
+	for (int i = 0; i < 3; i++) {
+		if (_heldFrames[i])
+			_videoDecoder->releaseFrame(_heldFrames[i]);
+		_frameBuffers[i].free();
+	}
+
 	delete _videoDecoder;
-	delete _externalSurface;
 }
 
 void MoviePlayer::pause(bool p) {
@@ -75,6 +86,7 @@ void MoviePlayer::stop() {
 }
 
 void MoviePlayer::timerCallback(void *instance) {
+	PROFILE_SCOPE("MoviePlayer::timerCallback");
 	MoviePlayer *movie = static_cast<MoviePlayer *>(instance);
 	Common::StackLock lock(movie->_frameMutex);
 	if (movie->prepareFrame())
@@ -102,9 +114,9 @@ bool MoviePlayer::prepareFrame() {
 		return false;
 
 	handleFrame();
-	_internalSurface = _videoDecoder->decodeNextFrame();
-	if (_frame != _videoDecoder->getCurFrame()) {
-		_updateNeeded = true;
+	const Graphics::Surface *frame = _videoDecoder->decodeNextFrame();
+	if (frame && _frame != _videoDecoder->getCurFrame()) {
+		publishFrame(frame);
 	}
 
 	_movieTime = _videoDecoder->getTime();
@@ -113,24 +125,63 @@ bool MoviePlayer::prepareFrame() {
 	return true;
 }
 
+void MoviePlayer::publishFrame(const Graphics::Surface *frame) {
+	// The renderer never looks at the write buffer, so it can be filled
+	// without holding any lock.
+	if (_heldFrames[_writeBuffer]) {
+		_videoDecoder->releaseFrame(_heldFrames[_writeBuffer]);
+		_heldFrames[_writeBuffer] = NULL;
+	}
+
+	// The codecs reuse their surface for the next frame, so only the frames
+	// decoded ahead can be handed over without copying them
+	_heldFrames[_writeBuffer] = _videoDecoder->holdFrame(frame);
+	if (!_heldFrames[_writeBuffer]) {
+		Graphics::Surface &dst = _frameBuffers[_writeBuffer];
+		if (dst.w != frame->w || dst.h != frame->h || dst.format != frame->format) {
+			dst.free();
+			dst.create(frame->w, frame->h, frame->format);
+		}
+
+		if (dst.pitch == frame->pitch) {
+			memcpy(dst.pixels, frame->pixels, frame->h * frame->pitch);
+		} else {
+			for (int y = 0; y < frame->h; y++)
+				memcpy(dst.getBasePtr(0, y), frame->getBasePtr(0, y), frame->w * frame->format.bytesPerPixel);
+		}
+	}
+
+	Common::StackLock lock(_swapMutex);
+	SWAP(_writeBuffer, _readyBuffer);
+	_readyGeneration++;
+}
+
 Graphics::Surface *MoviePlayer::getDstSurface() {
-	Common::StackLock lock(_frameMutex);
-	if (_updateNeeded && _internalSurface) {
-		_externalSurface->copyFrom(*_internalSurface);
+	Common::StackLock lock(_swapMutex);
+	if (_readGeneration != _readyGeneration) {
+		SWAP(_readBuffer, _readyBuffer);
+		_readGeneration = _readyGeneration;
 	}
 
-	return _externalSurface;
+	if (_heldFrames[_readBuffer])
+		return _heldFrames[_readBuffer];
+
+	return &_frameBuffers[_readBuffer];
+}
+
+bool MoviePlayer::isUpdateNeeded() {
+	Common::StackLock lock(_swapMutex);
+	return _readyGeneration != _readGeneration;
 }
 
 void MoviePlayer::init() {
 	if (!_timerStarted) {
-		g_system->getTimerManager()->installTimerProc(&timerCallback, 10000, this, "movieLoop");
+		g_system->getTimerManager()->installIsolatedTimerProc(&timerCallback, 10000, this, "movieLoop");
 		_timerStarted = true;
 	}
 
 	_frame = -1;
 	_movieTime = 0;
-	_updateNeeded = false;
 	_videoFinished = false;
 }
 
@@ -140,10 +191,8 @@ void MoviePlayer::deinit() {
 	if (_videoDecoder)
 		_videoDecoder->close();
 
-	_internalSurface = NULL;
-
-	if (_externalSurface)
-		_externalSurface->free();
+	// The frame buffers are kept around, as the renderer may still be
+	// reading the last frame. They are reused by the next video.
 
 	_videoPause = false;
 	_videoFinished = true;
@@ -163,7 +212,6 @@ bool MoviePlayer::play(const Common::String &filename, bool looping, int x, int
 	Debug::debug(Debug::Movie, "Playing video '%s'.\n", filename.c_str());
 
 	init();
-	_internalSurface = NULL;
 
 	if (start) {
 		_videoDecoder->start();
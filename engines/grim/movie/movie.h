@@ -26,6 +26,8 @@
 #include "common/mutex.h"
 #include "common/system.h"
 
+#include "graphics/surface.h"
+
 #include "video/video_decoder.h"
 
 namespace Grim {
@@ -36,11 +38,16 @@ class MoviePlayer {
 protected:
 	Common::String _fname;
 	Common::Mutex _frameMutex;
+	Common::Mutex _swapMutex;               //< Only guards the buffer indices below, never held while copying
 	Video::VideoDecoder *_videoDecoder;     //< Initialize this to your needed subclass of VideoDecoder in the constructor
-	const Graphics::Surface *_internalSurface;
-	Graphics::Surface *_externalSurface;
+	Graphics::Surface _frameBuffers[3];     //< Triple buffer shared between the decoding timer and the renderer
+	Graphics::Surface *_heldFrames[3];      //< Frames of the decoder used in place of the frame buffers, or NULL
+	int _writeBuffer;                       //< Only touched by the decoding side
+	int _readyBuffer;                       //< Latest complete frame, exchanged by both sides
+	int _readBuffer;                        //< Only touched by the rendering side
+	uint32 _readyGeneration;
+	uint32 _readGeneration;
 	int32 _frame;
-	bool _updateNeeded;
 	float _movieTime;
 	int _channels;
 	int _freq;
@@ -70,12 +77,18 @@ public:
 	virtual void stop();
 	virtual void pause(bool p);
 	virtual bool isPlaying() { return !_videoFinished; }
-	virtual bool isUpdateNeeded() { return _updateNeeded; }
+	virtual bool isUpdateNeeded();
+
+	/**
+	 * Get the latest decoded frame for drawing.
+	 *
+	 * The returned surface is not written to by the decoder until the next
+	 * call of this function, so it can be read without holding any lock.
+	 */
 	virtual Graphics::Surface *getDstSurface();
 	virtual int getX() { return _x; }
 	virtual int getY() { return _y; }
 	virtual int getFrame() { return _frame; }
-	virtual void clearUpdateNeeded() { _updateNeeded = false; }
 	virtual int32 getMovieTime() { return (int32)_movieTime; }
 
 	/**
@@ -88,10 +101,10 @@ public:
 protected:
 	static void timerCallback(void *ptr);
 	/**
-	 * Handles basic stuff per frame, like copying the latest frame to
-	 * _externalBuffer, and updating the frame-counters.
+	 * Handles basic stuff per frame, like publishing the latest frame to
+	 * the frame buffers, and updating the frame-counters.
 	 *
-	 * @return false if a frame wasnt drawn to _externalBuffer, true otherwise.
+	 * @return false if no frame was decoded, true otherwise.
 	 * @see handleFrame
 	 */
 	virtual bool prepareFrame();
@@ -103,7 +116,6 @@ protected:
 	 * decodes the next frame.
 	 *
 	 * @see prepareFrame
-	 * @see clearUpdateNeeded
 	 * @see isUpdateNeeded
 	 */
 	virtual void handleFrame() {};
@@ -115,7 +127,6 @@ protected:
 	 * run, this function is called whenever prepareFrame returns true.
 	 *
 	 * @see prepareFrame
-	 * @see clearUpdateNeeded
 	 * @see isUpdateNeeded
 	 */
 	virtual void postHandleFrame() {};
@@ -165,6 +176,15 @@ protected:
 	 * @param state The state to restore from
 	 */
 	virtual void restore(SaveGame *state) {}
+
+	/**
+	 * Puts a decoded frame in the write buffer and swaps it with the ready
+	 * buffer, making it available to getDstSurface(). The frames decoded
+	 * ahead of time are taken over from the decoder, the others are copied.
+	 *
+	 * @param frame         The decoded frame.
+	 */
+	void publishFrame(const Graphics::Surface *frame);
 };
 
 
@@ -37,6 +37,8 @@ MoviePlayer *CreateMpegPlayer() {
 
 MpegPlayer::MpegPlayer() : MoviePlayer() {
 	_videoDecoder = new Video::MPEGPSDecoder();
+	// Demuxing and decoding then happen on the decode-ahead timer
+	_videoDecoder->setDecodeAhead(4);
 }
 
 bool MpegPlayer::loadFile(const Common::String &filename) {
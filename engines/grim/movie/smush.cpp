@@ -39,10 +39,15 @@ SmushPlayer::SmushPlayer(bool demo) : MoviePlayer(), _demo(demo) {
 }
 
 bool SmushPlayer::loadFile(const Common::String &filename) {
-	if (!_demo)
-		return _videoDecoder->loadStream(g_resourceloader->openNewStreamFile(filename.c_str()));
-	else
+	if (_demo)
 		return _videoDecoder->loadFile(filename);
+
+	if (!_videoDecoder->loadStream(g_resourceloader->openNewStreamFile(filename.c_str())))
+		return false;
+
+	// Keep the frame index around, so seeking on restore doesn't scan the file again
+	_smushDecoder->setFrameIndex(g_resourceloader->getSmushFrameIndex(filename));
+	return true;
 }
 
 void SmushPlayer::init() {
@@ -44,6 +44,7 @@
 #include "engines/grim/patchr.h"
 #include "engines/grim/md5check.h"
 #include "engines/grim/update/update.h"
+#include "engines/grim/movie/codecs/smush_decoder.h"
 
 #include "common/algorithm.h"
 #include "common/zlib.h"
@@ -220,6 +221,8 @@ void clearList(Common::List<T> &list) {
 }
 
 ResourceLoader::~ResourceLoader() {
+	releaseResources();
+
 	for (Common::Array<ResourceCache>::iterator i = _cache.begin(); i != _cache.end(); ++i) {
 		ResourceCache &r = *i;
 		delete[] r.fname;
@@ -229,6 +232,8 @@ ResourceLoader::~ResourceLoader() {
 	clearList(_colormaps);
 	clearList(_keyframeAnims);
 	clearList(_lipsyncs);
+	for (Common::HashMap<Common::String, SmushFrameIndex *>::iterator i = _smushFrameIndices.begin(); i != _smushFrameIndices.end(); ++i)
+		delete i->_value;
 	MD5Check::clear();
 }
 
@@ -320,6 +325,17 @@ CMap *ResourceLoader::loadColormap(const Common::String &filename) {
 	return result;
 }
 
+SmushFrameIndex *ResourceLoader::getSmushFrameIndex(const Common::String &fname) {
+	Common::String name(fname);
+	name.toLowercase();
+
+	SmushFrameIndex *&frameIndex = _smushFrameIndices[name];
+	if (!frameIndex)
+		frameIndex = new SmushFrameIndex();
+
+	return frameIndex;
+}
+
 Common::String ResourceLoader::fixFilename(const Common::String &filename, bool append) {
 	Common::String fname(filename);
 	if (g_grim->getGameType() == GType_MONKEY4) {
@@ -598,4 +614,35 @@ LipSyncPtr ResourceLoader::getLipSync(const Common::String &fname) {
 	return loadLipSync(fname);
 }
 
+void ResourceLoader::holdResources() {
+	for (Common::List<CMap *>::const_iterator i = _colormaps.begin(); i != _colormaps.end(); ++i)
+		_heldColormaps.push_back(*i);
+	for (Common::List<KeyframeAnim *>::const_iterator i = _keyframeAnims.begin(); i != _keyframeAnims.end(); ++i)
+		_heldKeyframeAnims.push_back(*i);
+	for (Common::List<LipSync *>::const_iterator i = _lipsyncs.begin(); i != _lipsyncs.end(); ++i)
+		_heldLipsyncs.push_back(*i);
+
+	// Bitmap data is shared by name and reference counted by hand
+	if (BitmapData::_bitmaps) {
+		Common::HashMap<Common::String, BitmapData *>::const_iterator i;
+		for (i = BitmapData::_bitmaps->begin(); i != BitmapData::_bitmaps->end(); ++i) {
+			++i->_value->_refCount;
+			_heldBitmaps.push_back(i->_value);
+		}
+	}
+}
+
+void ResourceLoader::releaseResources() {
+	_heldColormaps.clear();
+	_heldKeyframeAnims.clear();
+	_heldLipsyncs.clear();
+
+	for (uint i = 0; i < _heldBitmaps.size(); ++i) {
+		BitmapData *data = _heldBitmaps[i];
+		if (--data->_refCount < 1)
+			delete data;
+	}
+	_heldBitmaps.clear();
+}
+
 } // end of namespace Grim
@@ -25,12 +25,15 @@
 
 #include "common/archive.h"
 #include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 
 #include "engines/grim/object.h"
 
 namespace Grim {
 
 class AnimationEmi;
+class BitmapData;
 class CMap;
 class Costume;
 class Font;
@@ -45,6 +48,7 @@ class Skeleton;
 class Sprite;
 class EMICostume;
 class Lab;
+struct SmushFrameIndex;
 
 typedef ObjectPtr<Material> MaterialPtr;
 typedef ObjectPtr<Model> ModelPtr;
@@ -80,6 +84,22 @@ public:
 	void uncacheKeyframe(KeyframeAnim *kf);
 	void uncacheLipSync(LipSync *l);
 
+	/**
+	 * Keep the loaded colormaps, keyframes, lipsyncs and bitmaps alive until
+	 * releaseResources() is called, so that they are reused instead of being
+	 * loaded again if they are requested in between, e.g. while a savegame
+	 * is restored over the current game.
+	 */
+	void holdResources();
+	void releaseResources();
+
+	/**
+	 * Get the frame index of a SMUSH movie, to be passed to
+	 * SmushDecoder::setFrameIndex(). It is empty until the movie is first
+	 * seeked, and then kept for all the later loads of the movie.
+	 */
+	SmushFrameIndex *getSmushFrameIndex(const Common::String &fname);
+
 	struct ResourceCache {
 		char *fname;
 		byte *resPtr;
@@ -104,6 +124,12 @@ private:
 	Common::List<CMap *> _colormaps;
 	Common::List<KeyframeAnim *> _keyframeAnims;
 	Common::List<LipSync *> _lipsyncs;
+	Common::HashMap<Common::String, SmushFrameIndex *> _smushFrameIndices;
+
+	Common::Array<CMapPtr> _heldColormaps;
+	Common::Array<KeyframeAnimPtr> _heldKeyframeAnims;
+	Common::Array<LipSyncPtr> _heldLipsyncs;
+	Common::Array<BitmapData *> _heldBitmaps;
 };
 
 extern ResourceLoader *g_resourceloader;
@@ -21,8 +21,12 @@
  */
 
 #include "common/endian.h"
+#include "common/memstream.h"
 #include "common/savefile.h"
 #include "common/system.h"
+#include "common/timer.h"
+#include "common/util.h"
+#include "common/zlib.h"
 
 #include "math/vector3d.h"
 
@@ -35,7 +39,18 @@ namespace Grim {
 #define SAVEGAME_FOOTERTAG  'ESAV'
 
 uint SaveGame::SAVEGAME_MAJOR_VERSION = 22;
-uint SaveGame::SAVEGAME_MINOR_VERSION = 8;
+uint SaveGame::SAVEGAME_MINOR_VERSION = 9;
+
+// From this minor version on, the header is followed by an index of the
+// sections, which may be compressed
+#define SAVEGAME_INDEXED_VERSION 9
+
+// Sections smaller than this are not worth compressing
+#define SAVEGAME_MIN_COMPRESSED_SIZE 512
+
+enum {
+	kSectionCompressed = 1 << 0
+};
 
 SaveGame *SaveGame::openForLoading(const Common::String &filename) {
 	Common::InSaveFile *inSaveFile = g_system->getSavefileManager()->openForLoading(filename);
@@ -57,11 +72,31 @@ SaveGame *SaveGame::openForLoading(const Common::String &filename) {
 	save->_majorVersion = inSaveFile->readUint32BE();
 	save->_minorVersion = inSaveFile->readUint32BE();
 
+	if (save->isCompatible() && save->_minorVersion >= SAVEGAME_INDEXED_VERSION) {
+		uint32 count = inSaveFile->readUint32BE();
+		save->_sections.resize(count);
+		for (uint32 i = 0; i < count; ++i) {
+			Section &section = save->_sections[i];
+			section.tag = inSaveFile->readUint32BE();
+			section.offset = inSaveFile->readUint32BE();
+			section.size = inSaveFile->readUint32BE();
+			section.storedSize = inSaveFile->readUint32BE();
+			section.compressed = inSaveFile->readUint32BE() & kSectionCompressed;
+		}
+
+		if (inSaveFile->err() || inSaveFile->eos()) {
+			delete save;
+			return NULL;
+		}
+	}
+
 	return save;
 }
 
-SaveGame *SaveGame::openForSaving(const Common::String &filename) {
-	Common::OutSaveFile *outSaveFile =  g_system->getSavefileManager()->openForSaving(filename);
+SaveGame *SaveGame::openForSaving(const Common::String &filename, uint32 sizeHint) {
+	// The sections are compressed one by one, so that they can be loaded
+	// without inflating the whole file
+	Common::OutSaveFile *outSaveFile =  g_system->getSavefileManager()->openForSaving(filename, false);
 	if (!outSaveFile) {
 		warning("SaveGame::openForSaving() Error creating savegame file %s", filename.c_str());
 		return NULL;
@@ -72,9 +107,12 @@ SaveGame *SaveGame::openForSaving(const Common::String &filename) {
 	save->_saving = true;
 	save->_outSaveFile = outSaveFile;
 
-	outSaveFile->writeUint32BE(SAVEGAME_HEADERTAG);
-	outSaveFile->writeUint32BE(SAVEGAME_MAJOR_VERSION);
-	outSaveFile->writeUint32BE(SAVEGAME_MINOR_VERSION);
+	// The whole savegame is kept in memory until writeToFile() is called, so
+	// allocate all of it at once if we know how big it was the last time.
+	save->_sectionAlloc = MAX<uint32>(sizeHint, _allocAmmount);
+	save->_sectionBuffer = (byte *)malloc(save->_sectionAlloc);
+	if (!save->_sectionBuffer)
+		error("Failed to allocate space for buffer");
 
 	save->_majorVersion = SAVEGAME_MAJOR_VERSION;
 	save->_minorVersion = SAVEGAME_MINOR_VERSION;
@@ -83,23 +121,149 @@ SaveGame *SaveGame::openForSaving(const Common::String &filename) {
 }
 
 SaveGame::SaveGame() :
-	_currentSection(0), _sectionBuffer(0) {
+	_inSaveFile(0), _outSaveFile(0), _currentSection(0), _sectionSize(0), _sectionAlloc(0),
+	_sectionPtr(0), _sectionStart(0), _bufferSize(0), _sectionBuffer(0), _nextSection(0) {
 
 }
 
 SaveGame::~SaveGame() {
 	if (_saving) {
-		_outSaveFile->writeUint32BE(SAVEGAME_FOOTERTAG);
-		_outSaveFile->finalize();
-		if (_outSaveFile->err())
+		if (_outSaveFile && !writeToFile())
 			warning("SaveGame::~SaveGame() Can't write file. (Disk full?)");
-		delete _outSaveFile;
 	} else {
 		delete _inSaveFile;
 	}
 	free(_sectionBuffer);
 }
 
+bool SaveGame::writeToFile() {
+	assert(_saving && _outSaveFile);
+	if (_currentSection != 0)
+		error("Tried to write a savegame with a section still open");
+
+	// Compress the sections first, to know where they go in the file
+	Common::Array<byte *> compressedData;
+	compressedData.resize(_sections.size());
+	uint32 offset = 16 + _sections.size() * 20;
+
+	for (uint i = 0; i < _sections.size(); ++i) {
+		Section &section = _sections[i];
+		compressedData[i] = 0;
+		section.storedSize = section.size;
+		section.compressed = false;
+
+		if (section.size >= SAVEGAME_MIN_COMPRESSED_SIZE) {
+			uint32 compressedSize;
+			byte *data = compress(&_sectionBuffer[section.offset], section.size, compressedSize);
+			if (data && compressedSize < section.size) {
+				compressedData[i] = data;
+				section.storedSize = compressedSize;
+				section.compressed = true;
+			} else {
+				free(data);
+			}
+		}
+	}
+
+	_outSaveFile->writeUint32BE(SAVEGAME_HEADERTAG);
+	_outSaveFile->writeUint32BE(SAVEGAME_MAJOR_VERSION);
+	_outSaveFile->writeUint32BE(SAVEGAME_MINOR_VERSION);
+
+	_outSaveFile->writeUint32BE(_sections.size());
+	for (uint i = 0; i < _sections.size(); ++i) {
+		const Section &section = _sections[i];
+		_outSaveFile->writeUint32BE(section.tag);
+		_outSaveFile->writeUint32BE(offset);
+		_outSaveFile->writeUint32BE(section.size);
+		_outSaveFile->writeUint32BE(section.storedSize);
+		_outSaveFile->writeUint32BE(section.compressed ? kSectionCompressed : 0);
+		offset += section.storedSize;
+	}
+
+	for (uint i = 0; i < _sections.size(); ++i) {
+		const Section &section = _sections[i];
+		if (section.compressed) {
+			_outSaveFile->write(compressedData[i], section.storedSize);
+			free(compressedData[i]);
+		} else {
+			_outSaveFile->write(&_sectionBuffer[section.offset], section.size);
+		}
+	}
+
+	_outSaveFile->writeUint32BE(SAVEGAME_FOOTERTAG);
+	_outSaveFile->finalize();
+	bool success = !_outSaveFile->err();
+
+	delete _outSaveFile;
+	_outSaveFile = 0;
+
+	// The snapshot is not needed anymore
+	free(_sectionBuffer);
+	_sectionBuffer = 0;
+	_sectionAlloc = 0;
+
+	return success;
+}
+
+uint32 SaveGame::getSize() const {
+	return _bufferSize;
+}
+
+byte *SaveGame::compress(const byte *data, uint32 size, uint32 &compressedSize) {
+#ifdef USE_ZLIB
+	Common::MemoryWriteStreamDynamic *stream = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+	Common::WriteStream *zipStream = Common::wrapCompressedWriteStream(stream);
+
+	zipStream->write(data, size);
+	zipStream->finalize();
+	bool failed = zipStream->err();
+
+	// The compressed data outlives the streams
+	byte *compressed = stream->getData();
+	compressedSize = stream->size();
+	delete zipStream;
+
+	if (failed) {
+		free(compressed);
+		return 0;
+	}
+	return compressed;
+#else
+	return 0;
+#endif
+}
+
+const SaveGame::Section *SaveGame::findSection(uint32 sectionTag) {
+	// Look after the last section first, as they are usually read in order
+	for (uint i = 0; i < _sections.size(); ++i) {
+		uint index = (_nextSection + i) % _sections.size();
+		if (_sections[index].tag == sectionTag) {
+			_nextSection = index + 1;
+			return &_sections[index];
+		}
+	}
+	return 0;
+}
+
+void SaveGame::readSection(const Section &section) {
+	if (!_sectionBuffer || _sectionAlloc < section.size) {
+		_sectionAlloc = section.size;
+		_sectionBuffer = (byte *)realloc(_sectionBuffer, _sectionAlloc);
+	}
+
+	_inSaveFile->seek(section.offset, SEEK_SET);
+	if (!section.compressed) {
+		_inSaveFile->read(_sectionBuffer, section.size);
+		return;
+	}
+
+	Common::SeekableReadStream *stream = _inSaveFile->readStream(section.storedSize);
+	stream = Common::wrapCompressedReadStream(stream, section.size);
+	if (!stream || stream->read(_sectionBuffer, section.size) != section.size)
+		error("Unable to decompress section of savegame");
+	delete stream;
+}
+
 bool SaveGame::isCompatible() const {
 	return _majorVersion == SAVEGAME_MAJOR_VERSION && _minorVersion <= SAVEGAME_MINOR_VERSION;
 }
@@ -119,7 +283,15 @@ uint32 SaveGame::beginSection(uint32 sectionTag) {
 		error("Tried to begin a new save game section with ending old section");
 	_currentSection = sectionTag;
 	_sectionSize = 0;
-	if (!_saving) {
+	if (!_saving && !_sections.empty()) {
+		const Section *section = findSection(sectionTag);
+		if (!section)
+			error("Unable to find requested section of savegame");
+
+		// Only the requested section is read and decompressed
+		readSection(*section);
+		_sectionSize = section->size;
+	} else if (!_saving) {
 		uint32 tag = 0;
 
 		while (tag != sectionTag) {
@@ -138,10 +310,8 @@ uint32 SaveGame::beginSection(uint32 sectionTag) {
 		_inSaveFile->read(_sectionBuffer, _sectionSize);
 
 	} else {
-		if (!_sectionBuffer) {
-			_sectionAlloc = _allocAmmount;
-			_sectionBuffer = (byte *)malloc(_sectionAlloc);
-		}
+		// The section is written in place, after the previous one
+		_sectionStart = _bufferSize;
 	}
 	_sectionPtr = 0;
 	return _sectionSize;
@@ -151,9 +321,17 @@ void SaveGame::endSection() {
 	if (_currentSection == 0)
 		error("Tried to end a save game section without starting a section");
 	if (_saving) {
-		_outSaveFile->writeUint32BE(_currentSection);
-		_outSaveFile->writeUint32BE(_sectionSize);
-		_outSaveFile->write(_sectionBuffer, _sectionSize);
+		Section section;
+		section.tag = _currentSection;
+		section.offset = _sectionStart;
+		section.size = _sectionSize;
+		section.storedSize = _sectionSize;
+		section.compressed = false;
+		_sections.push_back(section);
+
+		_bufferSize = _sectionStart + _sectionSize;
+		_sectionStart = 0;
+		_sectionSize = 0;
 	}
 	_currentSection = 0;
 }
@@ -219,16 +397,18 @@ bool SaveGame::readBool() {
 }
 
 void SaveGame::checkAlloc(int size) {
-	if (_sectionSize + size > _sectionAlloc) {
-		while (_sectionSize + size > _sectionAlloc)
-			_sectionAlloc += _allocAmmount;
+	uint32 needed = _sectionStart + _sectionSize + size;
+	if (needed > _sectionAlloc) {
+		// Grow geometrically, since the whole savegame lives in this buffer
+		while (needed > _sectionAlloc)
+			_sectionAlloc = MAX<uint32>(_sectionAlloc * 2, _allocAmmount);
 		_sectionBuffer = (byte *)realloc(_sectionBuffer, _sectionAlloc);
 		if (!_sectionBuffer)
 			error("Failed to allocate space for buffer");
 	}
 }
 
-void SaveGame::write(const void *data, int size) {
+byte *SaveGame::reserve(int size) {
 	if (!_saving)
 		error("SaveGame::writeBlock called when restoring a savegame");
 	if (_currentSection == 0)
@@ -236,44 +416,25 @@ void SaveGame::write(const void *data, int size) {
 
 	checkAlloc(size);
 
-	memcpy(&_sectionBuffer[_sectionSize], data, size);
+	byte *ptr = &_sectionBuffer[_sectionStart + _sectionSize];
 	_sectionSize += size;
+	return ptr;
 }
 
-void SaveGame::writeLEUint32(uint32 data) {
-	if (!_saving)
-		error("SaveGame::writeBlock called when restoring a savegame");
-	if (_currentSection == 0)
-		error("Tried to write a block without starting a section");
-
-	checkAlloc(4);
+void SaveGame::write(const void *data, int size) {
+	memcpy(reserve(size), data, size);
+}
 
-	WRITE_LE_UINT32(&_sectionBuffer[_sectionSize], data);
-	_sectionSize += 4;
+void SaveGame::writeLEUint32(uint32 data) {
+	WRITE_LE_UINT32(reserve(4), data);
 }
 
 void SaveGame::writeLEUint16(uint16 data) {
-	if (!_saving)
-		error("SaveGame::writeBlock called when restoring a savegame");
-	if (_currentSection == 0)
-		error("Tried to write a block without starting a section");
-
-	checkAlloc(2);
-
-	WRITE_LE_UINT16(&_sectionBuffer[_sectionSize], data);
-	_sectionSize += 2;
+	WRITE_LE_UINT16(reserve(2), data);
 }
 
 void SaveGame::writeLESint32(int32 data) {
-	if (!_saving)
-		error("SaveGame::writeBlock called when restoring a savegame");
-	if (_currentSection == 0)
-		error("Tried to write a block without starting a section");
-
-	checkAlloc(4);
-
-	WRITE_LE_UINT32(&_sectionBuffer[_sectionSize], (uint32)data);
-	_sectionSize += 4;
+	WRITE_LE_UINT32(reserve(4), (uint32)data);
 }
 
 void SaveGame::writeBool(bool data) {
@@ -281,15 +442,7 @@ void SaveGame::writeBool(bool data) {
 }
 
 void SaveGame::writeByte(byte data) {
-	if (!_saving)
-		error("SaveGame::writeBlock called when restoring a savegame");
-	if (_currentSection == 0)
-		error("Tried to write a block without starting a section");
-
-	checkAlloc(1);
-
-	_sectionBuffer[_sectionSize] = data;
-	_sectionSize++;
+	*reserve(1) = data;
 }
 
 void SaveGame::writeVector3d(const Math::Vector3d &vec) {
@@ -347,4 +500,61 @@ Common::String SaveGame::readString() {
 	return s;
 }
 
+SaveGameWriter::SaveGameWriter(SaveGame *savedState, CompletionCallback *callback) :
+	_savedState(savedState), _callback(callback), _finished(false), _success(false) {
+
+	g_system->getTimerManager()->installIsolatedTimerProc(&timerCallback, 1000, this, "savegameWriter");
+}
+
+SaveGameWriter::~SaveGameWriter() {
+	// This waits for a write in progress
+	g_system->getTimerManager()->removeTimerProc(&timerCallback);
+
+	if (!_finished)
+		write();
+	delete _savedState;
+	delete _callback;
+}
+
+void SaveGameWriter::timerCallback(void *refCon) {
+	SaveGameWriter *writer = static_cast<SaveGameWriter *>(refCon);
+
+	{
+		Common::StackLock lock(writer->_mutex);
+		if (writer->_finished)
+			return;
+	}
+
+	writer->write();
+}
+
+void SaveGameWriter::write() {
+	// The savegame file is compressed while being written
+	bool success = _savedState->writeToFile();
+
+	Common::StackLock lock(_mutex);
+	_success = success;
+	_finished = true;
+}
+
+bool SaveGameWriter::poll() {
+	{
+		Common::StackLock lock(_mutex);
+		if (!_finished)
+			return false;
+	}
+
+	if (_callback) {
+		(*_callback)(_success);
+		delete _callback;
+		_callback = 0;
+	}
+	return true;
+}
+
+void SaveGameWriter::wait() {
+	while (!poll())
+		g_system->delayMillis(1);
+}
+
 } // end of namespace Grim
@@ -23,6 +23,10 @@
 #ifndef GRIM_SAVEGAME_H
 #define GRIM_SAVEGAME_H
 
+#include "common/array.h"
+#include "common/func.h"
+#include "common/mutex.h"
+
 #include "math/mathfwd.h"
 
 namespace Common {
@@ -40,7 +44,14 @@ class Color;
 class SaveGame {
 public:
 	static SaveGame *openForLoading(const Common::String &filename);
-	static SaveGame *openForSaving(const Common::String &filename);
+	/**
+	 * Open a savegame for saving. The savegame is serialized in memory, and
+	 * only written to the file by writeToFile() or when it is deleted.
+	 *
+	 * @param sizeHint	the expected size of the savegame, e.g. the size of
+	 *                  the previous one, so that the buffer is not regrown
+	 */
+	static SaveGame *openForSaving(const Common::String &filename, uint32 sizeHint = 0);
 	~SaveGame();
 
 	/**
@@ -59,6 +70,16 @@ public:
 
 	bool isCompatible() const;
 
+	/**
+	 * Write the serialized savegame to its file. This does not touch the
+	 * engine state, so it can be done on another thread.
+	 *
+	 * @return	false if the file could not be written
+	 */
+	bool writeToFile();
+	/** Return the size of the serialized savegame, in bytes. */
+	uint32 getSize() const;
+
 	uint saveMajorVersion() const;
 	uint saveMinorVersion() const;
 	uint32 beginSection(uint32 sectionTag);
@@ -89,8 +110,22 @@ public:
 	void checkAlloc(int size);
 
 protected:
+	/** A section of the savegame, as listed in the index at the start of the file. */
+	struct Section {
+		uint32 tag;
+		uint32 offset;     ///< Offset in the file, or in the buffer when saving
+		uint32 size;
+		uint32 storedSize; ///< Size in the file, which is smaller if compressed
+		bool compressed;
+	};
+
 	SaveGame();
 
+	byte *reserve(int size);
+	const Section *findSection(uint32 sectionTag);
+	void readSection(const Section &section);
+	static byte *compress(const byte *data, uint32 size, uint32 &compressedSize);
+
 	uint _majorVersion;
 	uint _minorVersion;
 	bool _saving;
@@ -100,11 +135,53 @@ protected:
 	uint32 _sectionSize;
 	uint32 _sectionAlloc;
 	uint32 _sectionPtr;
+	uint32 _sectionStart; ///< When saving, offset of the current section in the buffer
+	uint32 _bufferSize;   ///< When saving, size of the finished sections in the buffer
 	byte *_sectionBuffer;
 
+	Common::Array<Section> _sections; ///< Empty when loading a savegame without an index
+	uint _nextSection;                ///< Where to start looking for the next section to load
+
 	static const int _allocAmmount = 1048576;
 };
 
+/**
+ * Writes a savegame, which has been serialized in memory, to its file on
+ * a timer worker, so that the game does not stop while the file is
+ * compressed and written.
+ */
+class SaveGameWriter {
+public:
+	/** Invoked with whether the savegame was written successfully. */
+	typedef Common::Functor1<bool, void> CompletionCallback;
+
+	/**
+	 * Start writing the given savegame. The writer takes ownership of both
+	 * the savegame and the callback.
+	 */
+	SaveGameWriter(SaveGame *savedState, CompletionCallback *callback);
+	/** Finish writing the savegame, if it was not already. */
+	~SaveGameWriter();
+
+	/**
+	 * Check if the savegame has been written, and if so invoke the
+	 * completion callback. To be called from the engine thread.
+	 */
+	bool poll();
+	/** Wait for the savegame to be written, and invoke the completion callback. */
+	void wait();
+
+private:
+	static void timerCallback(void *refCon);
+	void write();
+
+	SaveGame *_savedState;
+	CompletionCallback *_callback;
+	Common::Mutex _mutex;
+	bool _finished;
+	bool _success;
+};
+
 } // end of namespace Grim
 
 #endif
@@ -26,6 +26,7 @@
 #include "engines/myst3/subtitles.h"
 
 #include "common/config-manager.h"
+#include "common/profiler.h"
 
 #include "graphics/colormasks.h"
 
@@ -145,6 +146,8 @@ void Movie::drawOverlay() {
 }
 
 void Movie::drawNextFrameToTexture() {
+	PROFILE_SCOPE("Movie::drawNextFrameToTexture");
+
 	const Graphics::Surface *frame = _bink.decodeNextFrame();
 
 	if (frame) {
@@ -25,6 +25,7 @@
 #include "common/error.h"
 #include "common/config-manager.h"
 #include "common/file.h"
+#include "common/profiler.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -395,6 +396,8 @@ void Myst3Engine::updateCursor() {
 }
 
 void Myst3Engine::processInput(bool lookOnly) {
+	PROFILE_SCOPE("processInput");
+
 	// Process events
 	Common::Event event;
 	while (getEventManager()->pollEvent(event)) {
@@ -561,7 +564,10 @@ void Myst3Engine::drawFrame() {
 	if (_cursor->isVisible())
 		_cursor->draw();
 
-	_system->updateScreen();
+	{
+		PROFILE_SCOPE("updateScreen");
+		_system->updateScreen();
+	}
 	_system->delayMillis(10);
 	_state->updateFrameCounters();
 }
@@ -685,6 +691,8 @@ void Myst3Engine::runNodeInitScripts() {
 }
 
 void Myst3Engine::runNodeBackgroundScripts() {
+	PROFILE_SCOPE("runNodeBackgroundScripts");
+
 	NodePtr nodeDataRoom = _db->getNodeData(32675, _state->getLocationRoom());
 
 	if (nodeDataRoom) {
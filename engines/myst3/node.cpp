@@ -26,6 +26,7 @@
 #include "engines/myst3/subtitles.h"
 
 #include "common/debug.h"
+#include "common/profiler.h"
 #include "common/rect.h"
 
 namespace Myst3 {
@@ -197,6 +198,8 @@ void Node::drawOverlay() {
 }
 
 void Node::update() {
+	PROFILE_SCOPE("Node::update");
+
 	// First undraw ...
 	for (uint i = 0; i < _spotItems.size(); i++) {
 		_spotItems[i]->updateUndraw();
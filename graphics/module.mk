@@ -41,6 +41,7 @@ MODULE_OBJS := \
 	tinygl/specbuf.o \
 	tinygl/texture.o \
 	tinygl/vertex.o \
+	tinygl/vertex_batch.o \
 	tinygl/zbuffer.o \
 	tinygl/zline.o \
 	tinygl/zmath.o \
@@ -8,67 +8,313 @@
 
 namespace TinyGL {
 
-void glopArrayElement(GLContext *c, GLParam *param) {
+// Load the enabled attributes of an array element, except the vertex
+// coordinates, into the current state.
+static void gl_fetch_attributes(GLContext *c, int idx) {
 	int i;
 	int states = c->client_states;
-	int idx = param[1].i;
 
 	if (states & COLOR_ARRAY) {
-		GLParam p[5];
-		int size = c->color_array_size; 
+		int size = c->color_array_size;
 		i = idx * (size + c->color_array_stride);
-		p[1].f = c->color_array[i];
-		p[2].f = c->color_array[i + 1];
-		p[3].f = c->color_array[i + 2];
-		p[4].f = size > 3 ? c->color_array[i + 3] : 1.0f;
-		glopColor(c, p);  
+		gl_set_current_color(c, c->color_array[i], c->color_array[i + 1], c->color_array[i + 2],
+							 size > 3 ? c->color_array[i + 3] : 1.0f);
 	}
 	if (states & NORMAL_ARRAY) {
 		i = idx * (3 + c->normal_array_stride);
 		c->current_normal.X = c->normal_array[i];
 		c->current_normal.Y = c->normal_array[i + 1];
 		c->current_normal.Z = c->normal_array[i + 2];
-		c->current_normal.Z = 0.0f;
+		c->current_normal.W = 0.0f;
 	}
-	if (states & TEXCOORD_ARRAY) {
+}
+
+static void gl_fetch_tex_coord(GLContext *c, int idx) {
+	if (c->client_states & TEXCOORD_ARRAY) {
 		int size = c->texcoord_array_size;
-		i = idx * (size + c->texcoord_array_stride);
+		int i = idx * (size + c->texcoord_array_stride);
 		c->current_tex_coord.X = c->texcoord_array[i];
 		c->current_tex_coord.Y = c->texcoord_array[i + 1];
 		c->current_tex_coord.Z = size > 2 ? c->texcoord_array[i + 2] : 0.0f;
 		c->current_tex_coord.W = size > 3 ? c->texcoord_array[i + 3] : 1.0f;
 	}
-	if (states & VERTEX_ARRAY) {
-		GLParam p[5];
-		int size = c->vertex_array_size;
-		i = idx * (size + c->vertex_array_stride);
-		p[1].f = c->vertex_array[i];
-		p[2].f = c->vertex_array[i + 1];
-		p[3].f = size > 2 ? c->vertex_array[i+2] : 0.0f;
-		p[4].f = size > 3 ? c->vertex_array[i+3] : 1.0f;
-		glopVertex(c, p);
+}
+
+// Make room in the vertex cache for count vertices starting at index first
+// and drop what it holds.
+static void gl_setup_vertex_cache(GLContext *c, int first, int count) {
+	if (count > c->vertex_cache_max) {
+		gl_free(c->vertex_cache);
+		gl_free(c->vertex_cache_stamp);
+		c->vertex_cache_max = count;
+		c->vertex_cache = (GLVertex *)gl_malloc(count * sizeof(GLVertex));
+		c->vertex_cache_stamp = (unsigned int *)gl_zalloc(count * sizeof(unsigned int));
 	}
+
+	c->vertex_cache_first = first;
+	c->vertex_cache_count = count;
+	gl_invalidate_vertex_cache(c);
 }
 
-void glArrayElement(TGLint i) {
-	GLParam p[2];
-	p[0].op = OP_ArrayElement;
-	p[1].i = i;
-	gl_add_op(p);
+// Emit the array element idx as a vertex. Elements in the cached range are
+// transformed and lit only once, until some state they depend on changes.
+static void gl_array_vertex(GLContext *c, int idx) {
+	GLVertex *v;
+	GLVertex *cached = NULL;
+	int slot = idx - c->vertex_cache_first;
+
+	// keep the order of the vertices given with glVertex
+	gl_flush_vertex_batch(c);
+	v = gl_alloc_vertex(c);
+
+	if (slot >= 0 && slot < c->vertex_cache_count) {
+		cached = &c->vertex_cache[slot];
+
+		if (c->vertex_cache_stamp[slot] == c->vertex_cache_epoch) {
+			*v = *cached;
+			gl_fetch_tex_coord(c, idx);
+			gl_reuse_vertex(c, v);
+			gl_assemble_vertex(c);
+			return;
+		}
+	}
+
+	int size = c->vertex_array_size;
+	int i = idx * (size + c->vertex_array_stride);
+
+	gl_fetch_attributes(c, idx);
+	gl_fetch_tex_coord(c, idx);
+	gl_load_vertex_attributes(c, v);
+
+	v->coord.X = c->vertex_array[i];
+	v->coord.Y = c->vertex_array[i + 1];
+	v->coord.Z = size > 2 ? c->vertex_array[i + 2] : 0.0f;
+	v->coord.W = size > 3 ? c->vertex_array[i + 3] : 1.0f;
+
+	gl_process_vertex(c, v);
+
+	if (cached) {
+		*cached = *v;
+		c->vertex_cache_stamp[slot] = c->vertex_cache_epoch;
+	}
+
+	gl_assemble_vertex(c);
+}
+
+void glopArrayElement(GLContext *c, GLParam *param) {
+	int idx = param[1].i;
+
+	if (c->client_states & VERTEX_ARRAY) {
+		gl_array_vertex(c, idx);
+	} else {
+		gl_fetch_attributes(c, idx);
+		gl_fetch_tex_coord(c, idx);
+	}
+}
+
+static inline int gl_get_index(int type, const void *indices, int i) {
+	switch (type) {
+	case TGL_UNSIGNED_BYTE:
+		return ((const unsigned char *)indices)[i];
+	case TGL_UNSIGNED_SHORT:
+		return ((const unsigned short *)indices)[i];
+	default:
+		return ((const unsigned int *)indices)[i];
+	}
+}
+
+// Transform and light the vertices of an indexed draw call that are not
+// in the cache yet, as batches, so that drawing only takes vertices from
+// the cache.
+static void gl_fill_vertex_cache(GLContext *c, int type, const void *indices, int count) {
+	GLVertex *batch[VERTEX_BATCH_SIZE];
+	int i, n = 0;
+	int states = c->client_states;
+
+	// Lighting with color material needs the material of each vertex
+	if (c->lighting_enabled && c->color_material_enabled && (states & COLOR_ARRAY))
+		return;
+
+	for (i = 0; i < count; i++) {
+		int idx = gl_get_index(type, indices, i);
+		int slot = idx - c->vertex_cache_first;
+		int j, size;
+		GLVertex *v;
+
+		if (slot < 0 || slot >= c->vertex_cache_count ||
+				c->vertex_cache_stamp[slot] == c->vertex_cache_epoch)
+			continue;
+
+		v = &c->vertex_cache[slot];
+		gl_load_vertex_attributes(c, v);
+
+		size = c->vertex_array_size;
+		j = idx * (size + c->vertex_array_stride);
+		v->coord.X = c->vertex_array[j];
+		v->coord.Y = c->vertex_array[j + 1];
+		v->coord.Z = size > 2 ? c->vertex_array[j + 2] : 0.0f;
+		v->coord.W = size > 3 ? c->vertex_array[j + 3] : 1.0f;
+
+		if (states & NORMAL_ARRAY) {
+			j = idx * (3 + c->normal_array_stride);
+			v->normal.X = c->normal_array[j];
+			v->normal.Y = c->normal_array[j + 1];
+			v->normal.Z = c->normal_array[j + 2];
+		}
+		if (states & COLOR_ARRAY) {
+			size = c->color_array_size;
+			j = idx * (size + c->color_array_stride);
+			v->color.X = c->color_array[j];
+			v->color.Y = c->color_array[j + 1];
+			v->color.Z = c->color_array[j + 2];
+			v->color.W = size > 3 ? c->color_array[j + 3] : 1.0f;
+		}
+
+		c->vertex_cache_stamp[slot] = c->vertex_cache_epoch;
+		batch[n++] = v;
+		if (n == VERTEX_BATCH_SIZE) {
+			gl_process_vertices(c, batch, n);
+			n = 0;
+		}
+	}
+
+	if (n > 0)
+		gl_process_vertices(c, batch, n);
+}
+
+void glopDrawElements(GLContext *c, GLParam *p) {
+	GLParam q[2];
+	int mode = p[1].i;
+	int count = p[2].i;
+	int type = p[3].i;
+	const void *indices = p[4].p;
+	int i;
+
+	if (!(c->client_states & VERTEX_ARRAY) || count <= 0)
+		return;
+
+	if (!c->arrays_locked) {
+		// Without locked arrays, vertices are only shared within this call
+		int minIndex = gl_get_index(type, indices, 0);
+		int maxIndex = minIndex;
+		for (i = 1; i < count; i++) {
+			int idx = gl_get_index(type, indices, i);
+			if (idx < minIndex)
+				minIndex = idx;
+			if (idx > maxIndex)
+				maxIndex = idx;
+		}
+		gl_setup_vertex_cache(c, minIndex, maxIndex - minIndex + 1);
+	}
+
+	q[1].i = mode;
+	glopBegin(c, q);
+
+	gl_fill_vertex_cache(c, type, indices, count);
+
+	for (i = 0; i < count; i++)
+		gl_array_vertex(c, gl_get_index(type, indices, i));
+
+	glopEnd(c, q);
+
+	if (!c->arrays_locked)
+		c->vertex_cache_count = 0;
+}
+
+void glopLockArrays(GLContext *c, GLParam *p) {
+	c->arrays_locked = 1;
+	gl_setup_vertex_cache(c, p[1].i, p[2].i);
+}
+
+void glopUnlockArrays(GLContext *c, GLParam *) {
+	c->arrays_locked = 0;
+	c->vertex_cache_count = 0;
+}
+
+// Texture coordinates are not part of the cached vertices, so toggling
+// their array alone does not invalidate the cache.
+static void gl_set_client_states(GLContext *c, int states) {
+	if ((c->client_states ^ states) & ~TEXCOORD_ARRAY)
+		gl_invalidate_vertex_cache(c);
+	c->client_states = states;
 }
 
 void glopEnableClientState(GLContext *c, GLParam *p) {
-	c->client_states |= p[1].i;
+	gl_set_client_states(c, c->client_states | p[1].i);
+}
+
+void glopDisableClientState(GLContext *c, GLParam *p) {
+	gl_set_client_states(c, c->client_states & p[1].i);
 }
 
-void glEnableClientState(TGLenum array) {
-	GLParam p[2];
-	p[0].op = OP_EnableClientState;
+void glopVertexPointer(GLContext *c, GLParam *p) {
+	c->vertex_array_size = p[1].i;
+	c->vertex_array_stride = p[2].i;
+	c->vertex_array = (float *)p[3].p;
+	gl_invalidate_vertex_cache(c);
+}
+
+void glopColorPointer(GLContext *c, GLParam *p) {
+	c->color_array_size = p[1].i;
+	c->color_array_stride = p[2].i;
+	c->color_array = (float *)p[3].p;
+	gl_invalidate_vertex_cache(c);
+}
+
+void glopNormalPointer(GLContext *c, GLParam *p) {
+	c->normal_array_stride = p[1].i;
+	c->normal_array = (float *)p[2].p;
+	gl_invalidate_vertex_cache(c);
+}
+
+void glopTexCoordPointer(GLContext *c, GLParam *p) {
+	c->texcoord_array_size = p[1].i;
+	c->texcoord_array_stride = p[2].i;
+	c->texcoord_array = (float *)p[3].p;
+}
+
+} // end of namespace TinyGL
+
+void tglArrayElement(TGLint i) {
+	TinyGL::GLParam p[2];
+	p[0].op = TinyGL::OP_ArrayElement;
+	p[1].i = i;
+	TinyGL::gl_add_op(p);
+}
+
+void tglDrawElements(TGLenum mode, TGLsizei count, TGLenum type, const TGLvoid *indices) {
+	TinyGL::GLParam p[5];
+	assert(type == TGL_UNSIGNED_BYTE || type == TGL_UNSIGNED_SHORT || type == TGL_UNSIGNED_INT);
+	p[0].op = TinyGL::OP_DrawElements;
+	p[1].i = mode;
+	p[2].i = count;
+	p[3].i = type;
+	p[4].p = const_cast<void *>(indices);
+	TinyGL::gl_add_op(p);
+}
+
+void tglLockArraysEXT(TGLint first, TGLsizei count) {
+	TinyGL::GLParam p[3];
+	p[0].op = TinyGL::OP_LockArrays;
+	p[1].i = first;
+	p[2].i = count;
+	TinyGL::gl_add_op(p);
+}
+
+void tglUnlockArraysEXT() {
+	TinyGL::GLParam p[1];
+	p[0].op = TinyGL::OP_UnlockArrays;
+	TinyGL::gl_add_op(p);
+}
+
+void tglEnableClientState(TGLenum array) {
+	TinyGL::GLParam p[2];
+	p[0].op = TinyGL::OP_EnableClientState;
 
 	switch(array) {
 	case TGL_VERTEX_ARRAY:
 		p[1].i = VERTEX_ARRAY;
-		break;  
+		break;
 	case TGL_NORMAL_ARRAY:
 		p[1].i = NORMAL_ARRAY;
 		break;
@@ -82,21 +328,17 @@ void glEnableClientState(TGLenum array) {
 		assert(0);
 		break;
 	}
-	gl_add_op(p);
+	TinyGL::gl_add_op(p);
 }
 
-void glopDisableClientState(GLContext *c, GLParam *p) {
-	c->client_states &= p[1].i;
-}
+void tglDisableClientState(TGLenum array) {
+	TinyGL::GLParam p[2];
+	p[0].op = TinyGL::OP_DisableClientState;
 
-void glDisableClientState(TGLenum array) {
-	GLParam p[2];
-	p[0].op = OP_DisableClientState;
-    
 	switch(array) {
 	case TGL_VERTEX_ARRAY:
 		p[1].i = ~VERTEX_ARRAY;
-		break;  
+		break;
 	case TGL_NORMAL_ARRAY:
 		p[1].i = ~NORMAL_ARRAY;
 		break;
@@ -110,69 +352,44 @@ void glDisableClientState(TGLenum array) {
 		assert(0);
 		break;
 	}
-	gl_add_op(p);
+	TinyGL::gl_add_op(p);
 }
 
-void glopVertexPointer(GLContext *c, GLParam *p) {
-	c->vertex_array_size = p[1].i;
-	c->vertex_array_stride = p[2].i;
-	c->vertex_array = (float *)p[3].p;
-}
-
-void  glVertexPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
-	GLParam p[4];
+void tglVertexPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
+	TinyGL::GLParam p[4];
 	assert(type == TGL_FLOAT);
-	p[0].op = OP_VertexPointer;
+	p[0].op = TinyGL::OP_VertexPointer;
 	p[1].i = size;
 	p[2].i = stride;
 	p[3].p = const_cast<void *>(pointer);
-	gl_add_op(p);
-}
-
-void glopColorPointer(GLContext *c, GLParam *p) {
-	c->color_array_size = p[1].i;
-	c->color_array_stride = p[2].i;
-	c->color_array = (float *)p[3].p;  
+	TinyGL::gl_add_op(p);
 }
 
-void  glColorPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
-	GLParam p[4];
+void tglColorPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
+	TinyGL::GLParam p[4];
 	assert(type == TGL_FLOAT);
-	p[0].op = OP_ColorPointer;
+	p[0].op = TinyGL::OP_ColorPointer;
 	p[1].i = size;
 	p[2].i = stride;
 	p[3].p = const_cast<void *>(pointer);
-	gl_add_op(p);
-}
-
-void glopNormalPointer(GLContext *c, GLParam *p) {
-	c->normal_array_stride = p[1].i;
-	c->normal_array = (float *)p[2].p;
+	TinyGL::gl_add_op(p);
 }
 
-void glNormalPointer(TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
-	GLParam p[3];
+void tglNormalPointer(TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
+	TinyGL::GLParam p[3];
 	assert(type == TGL_FLOAT);
-	p[0].op = OP_NormalPointer;
+	p[0].op = TinyGL::OP_NormalPointer;
 	p[1].i = stride;
 	p[2].p = const_cast<void *>(pointer);
-	gl_add_op(p);
+	TinyGL::gl_add_op(p);
 }
 
-void glopTexCoordPointer(GLContext *c, GLParam *p) {
-	c->texcoord_array_size = p[1].i;
-	c->texcoord_array_stride = p[2].i;
-	c->texcoord_array = (float *)p[3].p;
-}
-
-void glTexCoordPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
-	GLParam p[4];
+void tglTexCoordPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer) {
+	TinyGL::GLParam p[4];
 	assert(type == TGL_FLOAT);
-	p[0].op = OP_TexCoordPointer;
+	p[0].op = TinyGL::OP_TexCoordPointer;
 	p[1].i = size;
 	p[2].i = stride;
 	p[3].p = const_cast<void *>(pointer);
-	gl_add_op(p);
+	TinyGL::gl_add_op(p);
 }
-
-} // end of namespace TinyGL
@@ -746,6 +746,7 @@ int tglIsList(unsigned int list);
 void tglNewList(unsigned int list, int mode);
 void tglEndList();
 void tglCallList(unsigned int list);
+void tglDeleteLists(unsigned int list, int range);
 
 // clear
 void tglClear(int mask);
@@ -803,6 +804,12 @@ void tglVertexPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid
 void tglColorPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer);
 void tglNormalPointer(TGLenum type, TGLsizei stride, const TGLvoid *pointer);
 void tglTexCoordPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoid *pointer);
+void tglDrawElements(TGLenum mode, TGLsizei count, TGLenum type, const TGLvoid *indices);
+
+// EXT_compiled_vertex_array: while the arrays are locked, the transformed and
+// lit vertices are kept across glArrayElement and glDrawElements calls
+void tglLockArraysEXT(TGLint first, TGLsizei count);
+void tglUnlockArraysEXT();
 
 // opengl 1.2 polygon offset
 void tglPolygonOffset(TGLfloat factor, TGLfloat units);
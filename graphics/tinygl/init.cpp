@@ -40,6 +40,7 @@ void glInit(void *zbuffer1) {
 	// allocate GLVertex array
 	c->vertex_max = POLYGON_MAX_VERTEX;
 	c->vertex = (GLVertex *)gl_malloc(POLYGON_MAX_VERTEX * sizeof(GLVertex));
+	c->vertex_batch = (GLVertex *)gl_malloc(VERTEX_BATCH_SIZE * sizeof(GLVertex));
   
 	// viewport
 	v = &c->viewport;
@@ -163,6 +164,12 @@ void glInit(void *zbuffer1) {
 
 	// opengl 1.1 arrays
 	c->client_states = 0;
+	c->arrays_locked = 0;
+	c->vertex_cache_count = 0;
+	c->vertex_cache_max = 0;
+	c->vertex_cache_epoch = 1;
+	c->vertex_cache_stamp = NULL;
+	c->vertex_cache = NULL;
 
 	// opengl 1.1 polygon offset
 	c->offset_states = 0;
@@ -192,6 +199,9 @@ void glClose() {
 		gl_free(c->matrix_stack[i]);
 	endSharedState(c);
 	gl_free(c->vertex);
+	gl_free(c->vertex_batch);
+	gl_free(c->vertex_cache);
+	gl_free(c->vertex_cache_stamp);
 
 	gl_free(c);
 }
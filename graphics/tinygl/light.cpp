@@ -4,16 +4,22 @@
 namespace TinyGL {
 
 void glopMaterial(GLContext *c, GLParam *p) {
-	int mode = p[1].i;
-	int type = p[2].i;
 	float v[4] = { p[3].f, p[4].f, p[5].f, p[6].f };
+
+	// Vertices already given must be lit with the previous material
+	if (c->in_begin)
+		gl_flush_vertex_batch(c);
+	gl_invalidate_vertex_cache(c);
+	gl_set_material(c, p[1].i, p[2].i, v);
+}
+
+void gl_set_material(GLContext *c, int mode, int type, const float *v) {
 	int i;
 	GLMaterial *m;
 
 	if (mode == TGL_FRONT_AND_BACK) {
-		p[1].i=TGL_FRONT;
-		glopMaterial(c,p);
-		mode=TGL_BACK;
+		gl_set_material(c, TGL_FRONT, type, v);
+		mode = TGL_BACK;
 	}
 	if (mode == TGL_FRONT)
 		m = &c->materials[0];
@@ -58,6 +64,7 @@ void glopColorMaterial(GLContext *c, GLParam *p) {
 
 	c->current_color_material_mode = mode;
 	c->current_color_material_type = type;
+	gl_invalidate_vertex_cache(c);
 }
 
 void glopLight(GLContext *c, GLParam *p) {
@@ -70,6 +77,7 @@ void glopLight(GLContext *c, GLParam *p) {
 	assert(light >= TGL_LIGHT0 && light < TGL_LIGHT0 + T_MAX_LIGHTS);
 
 	l = &c->lights[light - TGL_LIGHT0];
+	gl_invalidate_vertex_cache(c);
 
 	for (i = 0; i < 4; i++)
 		v.v[i] = p[3 + i].f;
@@ -138,6 +146,8 @@ void glopLightModel(GLContext *c, GLParam *p) {
 	float v[4] = { p[2].f, p[3].f, p[4].f, p[5].f };
 	int i;
 
+	gl_invalidate_vertex_cache(c);
+
 	switch (pname) {
 	case TGL_LIGHT_MODEL_AMBIENT:
 		for (i = 0; i < 4; i++)
@@ -155,19 +165,10 @@ void glopLightModel(GLContext *c, GLParam *p) {
 	}
 }
 
-
-static inline float clampf(float a, float min, float max) {
-  if (a < min)
-	  return min;
-  else if (a > max)
-	  return max;
-  else
-	  return a;
-}
-
 void gl_enable_disable_light(GLContext *c, int light, int v) {
 	GLLight *l = &c->lights[light];
 	if (v && !l->enabled) {
+		gl_invalidate_vertex_cache(c);
 		l->enabled = 1;
 		if (c->first_light != l) {
 			l->next = c->first_light;
@@ -177,6 +178,7 @@ void gl_enable_disable_light(GLContext *c, int light, int v) {
 			l->prev = NULL;
 		}
 	} else if (!v && l->enabled) {
+		gl_invalidate_vertex_cache(c);
 		l->enabled = 0;
 		if (!l->prev)
 			c->first_light = l->next;
@@ -30,9 +30,18 @@ GLContext *gl_get_context() {
 }
 
 static GLList *find_list(GLContext *c, unsigned int list) {
+	if (list >= MAX_DISPLAY_LISTS)
+		return NULL;
 	return c->shared_state.lists[list];
 }
 
+static void free_compiled_list(GLCompiledList *cl) {
+	gl_free(cl->primitives);
+	gl_free(cl->vertices);
+	gl_free(cl->processed);
+	gl_free(cl);
+}
+
 static void delete_list(GLContext *c, int list) {
 	GLParamBuffer *pb, *pb1;
 	GLList *l;
@@ -47,6 +56,9 @@ static void delete_list(GLContext *c, int list) {
 		gl_free(pb);
 		pb = pb1;
 	}
+
+	if (l->compiled)
+		free_compiled_list(l->compiled);
   
 	gl_free(l);
 	c->shared_state.lists[list] = NULL;
@@ -154,6 +166,224 @@ void glopNextBuffer(GLContext *, GLParam *) {
 	assert(0);
 }
 
+static GLParam *next_op(GLParam *p) {
+	if (p[0].op == OP_NextBuffer)
+		return (GLParam *)p[1].p;
+	return p + op_table_size[p[0].op];
+}
+
+// Turn a list made only of primitives and vertex attributes into a vertex
+// buffer. Lists with any other op are left to be replayed op by op.
+static GLCompiledList *compile_list(GLList *l) {
+	GLCompiledList *cl;
+	GLParam *p;
+	GLParam *color = NULL, *normal = NULL, *tex_coord = NULL, *edge_flag = NULL;
+	int in_begin = 0, nb_primitives = 0, nb_vertices = 0;
+
+	for (p = l->first_op_buffer->ops; p[0].op != OP_EndList; p = next_op(p)) {
+		switch (p[0].op) {
+		case OP_NextBuffer:
+		case OP_Color:
+		case OP_Normal:
+		case OP_TexCoord:
+		case OP_EdgeFlag:
+			break;
+		case OP_Begin:
+			if (in_begin)
+				return NULL;
+			in_begin = 1;
+			nb_primitives++;
+			break;
+		case OP_End:
+			if (!in_begin)
+				return NULL;
+			in_begin = 0;
+			break;
+		case OP_Vertex:
+			if (!in_begin)
+				return NULL;
+			nb_vertices++;
+			break;
+		default:
+			return NULL;
+		}
+	}
+	if (in_begin || nb_vertices == 0)
+		return NULL;
+
+	cl = (GLCompiledList *)gl_zalloc(sizeof(GLCompiledList));
+	cl->primitives = (GLCompiledPrimitive *)gl_malloc(nb_primitives * sizeof(GLCompiledPrimitive));
+	cl->vertices = (GLVertex *)gl_zalloc(nb_vertices * sizeof(GLVertex));
+	cl->processed = (GLVertex *)gl_malloc(nb_vertices * sizeof(GLVertex));
+	cl->color_from = cl->tex_coord_from = cl->edge_flag_from = nb_vertices;
+
+	for (p = l->first_op_buffer->ops; p[0].op != OP_EndList; p = next_op(p)) {
+		GLCompiledPrimitive *prim = &cl->primitives[cl->primitive_count];
+		GLVertex *v = &cl->vertices[cl->vertex_count];
+
+		switch (p[0].op) {
+		case OP_Color:
+			if (!color)
+				cl->color_from = cl->vertex_count;
+			color = p;
+			break;
+		case OP_Normal:
+			normal = p;
+			break;
+		case OP_TexCoord:
+			if (!tex_coord)
+				cl->tex_coord_from = cl->vertex_count;
+			tex_coord = p;
+			break;
+		case OP_EdgeFlag:
+			if (!edge_flag)
+				cl->edge_flag_from = cl->vertex_count;
+			edge_flag = p;
+			break;
+		case OP_Begin:
+			prim->type = p[1].i;
+			prim->first = cl->vertex_count;
+			break;
+		case OP_End:
+			prim->count = cl->vertex_count - prim->first;
+			cl->primitive_count++;
+			break;
+		case OP_Vertex:
+			v->coord.X = p[1].f;
+			v->coord.Y = p[2].f;
+			v->coord.Z = p[3].f;
+			v->coord.W = p[4].f;
+			if (color) {
+				v->color.X = color[1].f;
+				v->color.Y = color[2].f;
+				v->color.Z = color[3].f;
+				v->color.W = color[4].f;
+			}
+			if (normal) {
+				v->normal.X = normal[1].f;
+				v->normal.Y = normal[2].f;
+				v->normal.Z = normal[3].f;
+			}
+			if (tex_coord) {
+				v->tex_coord.X = tex_coord[1].f;
+				v->tex_coord.Y = tex_coord[2].f;
+				v->tex_coord.Z = tex_coord[3].f;
+				v->tex_coord.W = tex_coord[4].f;
+			}
+			if (edge_flag)
+				v->edge_flag = edge_flag[1].i;
+			cl->vertex_count++;
+			break;
+		}
+	}
+
+	cl->last_color = color;
+	cl->last_normal = normal;
+	cl->last_tex_coord = tex_coord;
+	cl->last_edge_flag = edge_flag;
+	return cl;
+}
+
+// Checks if the processed vertices of a list are still valid. It must be
+// called after glopBegin(), which updates the viewport.
+static int is_compiled_list_current(GLContext *c, GLCompiledList *cl) {
+	if (!cl->processed_valid)
+		return 0;
+	if (memcmp(&cl->model_view, c->matrix_stack_ptr[0], sizeof(M4)) != 0 ||
+			memcmp(&cl->projection, c->matrix_stack_ptr[1], sizeof(M4)) != 0 ||
+			memcmp(&cl->viewport_scale, &c->viewport.scale, sizeof(V3)) != 0 ||
+			memcmp(&cl->viewport_trans, &c->viewport.trans, sizeof(V3)) != 0 ||
+			cl->texture_2d_enabled != c->texture_2d_enabled)
+		return 0;
+	if (c->texture_2d_enabled && c->apply_texture_matrix &&
+			memcmp(&cl->texture, c->matrix_stack_ptr[2], sizeof(M4)) != 0)
+		return 0;
+
+	// attributes taken from the current state
+	if (cl->color_from > 0 && memcmp(&cl->color, &c->current_color, sizeof(V4)) != 0)
+		return 0;
+	if (cl->tex_coord_from > 0 && c->texture_2d_enabled &&
+			memcmp(&cl->tex_coord, &c->current_tex_coord, sizeof(V4)) != 0)
+		return 0;
+	if (cl->edge_flag_from > 0 && cl->edge_flag != c->current_edge_flag)
+		return 0;
+	return 1;
+}
+
+static void process_compiled_list(GLContext *c, GLCompiledList *cl) {
+	GLVertex *batch[VERTEX_BATCH_SIZE];
+	int i, n = 0;
+
+	for (i = 0; i < cl->vertex_count; i++) {
+		GLVertex *v = &cl->processed[i];
+
+		*v = cl->vertices[i];
+		if (i < cl->color_from)
+			v->color = c->current_color;
+		if (i < cl->tex_coord_from)
+			v->tex_coord = c->current_tex_coord;
+		if (i < cl->edge_flag_from)
+			v->edge_flag = c->current_edge_flag;
+
+		batch[n++] = v;
+		if (n == VERTEX_BATCH_SIZE) {
+			gl_process_vertices(c, batch, n);
+			n = 0;
+		}
+	}
+	if (n > 0)
+		gl_process_vertices(c, batch, n);
+
+	cl->model_view = *c->matrix_stack_ptr[0];
+	cl->projection = *c->matrix_stack_ptr[1];
+	cl->texture = *c->matrix_stack_ptr[2];
+	cl->viewport_scale = c->viewport.scale;
+	cl->viewport_trans = c->viewport.trans;
+	cl->texture_2d_enabled = c->texture_2d_enabled;
+	cl->color = c->current_color;
+	cl->tex_coord = c->current_tex_coord;
+	cl->edge_flag = c->current_edge_flag;
+	cl->processed_valid = 1;
+}
+
+// Draw a compiled list from its processed vertices. Returns 0 when the
+// list has to be replayed op by op instead.
+static int call_compiled_list(GLContext *c, GLCompiledList *cl) {
+	GLParam p[2];
+	int i, j;
+
+	// the vertices are not lit; the list would be called from inside
+	// another primitive by mistake
+	if (c->lighting_enabled || c->in_begin)
+		return 0;
+
+	for (i = 0; i < cl->primitive_count; i++) {
+		const GLCompiledPrimitive *prim = &cl->primitives[i];
+
+		p[1].i = prim->type;
+		glopBegin(c, p);
+		if (i == 0 && !is_compiled_list_current(c, cl))
+			process_compiled_list(c, cl);
+
+		for (j = 0; j < prim->count; j++) {
+			*gl_alloc_vertex(c) = cl->processed[prim->first + j];
+			gl_assemble_vertex(c);
+		}
+		glopEnd(c, p);
+	}
+
+	// leave the current attributes as the list sets them
+	if (cl->last_color)
+		glopColor(c, cl->last_color);
+	if (cl->last_normal)
+		glopNormal(c, cl->last_normal);
+	if (cl->last_tex_coord)
+		glopTexCoord(c, cl->last_tex_coord);
+	if (cl->last_edge_flag)
+		glopEdgeFlag(c, cl->last_edge_flag);
+	return 1;
+}
+
 void glopCallList(GLContext *c, GLParam *p) {
 	GLList *l;
 	int list, op;
@@ -162,6 +392,8 @@ void glopCallList(GLContext *c, GLParam *p) {
 	l = find_list(c, list);
 	if (!l)
 		error("list %d not defined", list);
+	if (l->compiled && call_compiled_list(c, l->compiled))
+		return;
 	p = l->first_op_buffer->ops;
 
 	while (1) {
@@ -177,60 +409,66 @@ void glopCallList(GLContext *c, GLParam *p) {
 	}
 }
 
-void glNewList(unsigned int list, int mode) {
-	GLList *l;
-	GLContext *c = gl_get_context();
+} // end of namespace TinyGL
+
+void tglNewList(unsigned int list, int mode) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	TinyGL::GLList *l;
 
 	assert(mode == TGL_COMPILE || mode == TGL_COMPILE_AND_EXECUTE);
 	assert(c->compile_flag == 0);
 
-	l = find_list(c, list);
+	l = TinyGL::find_list(c, list);
 	if (l)
-		delete_list(c, list);
-	l = alloc_list(c, list);
+		TinyGL::delete_list(c, list);
+	l = TinyGL::alloc_list(c, list);
 
 	c->current_op_buffer = l->first_op_buffer;
 	c->current_op_buffer_index = 0;
+	c->current_list = l;
   
 	c->compile_flag = 1;
 	c->exec_flag = (mode == TGL_COMPILE_AND_EXECUTE);
 }
 
-void glEndList() {
-	GLContext *c = gl_get_context();
-	GLParam p[1];
+void tglEndList() {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	TinyGL::GLParam p[1];
 
 	assert(c->compile_flag == 1);
   
 	// end of list
-	p[0].op = OP_EndList;
-	gl_compile_op(c, p);
+	p[0].op = TinyGL::OP_EndList;
+	TinyGL::gl_compile_op(c, p);
+	c->current_list->compiled = TinyGL::compile_list(c->current_list);
+	c->current_list = NULL;
   
 	c->compile_flag = 0;
 	c->exec_flag = 1;
 }
 
-int glIsList(unsigned int list) {
-	GLContext *c = gl_get_context();
-	GLList *l;
-	l = find_list(c, list);
+int tglIsList(unsigned int list) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	TinyGL::GLList *l;
+	l = TinyGL::find_list(c, list);
 	return (l != NULL);
 }
 
-unsigned int glGenLists(int range) {
-	GLContext *c = gl_get_context();
+unsigned int tglGenLists(int range) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	int count, i, list;
-	GLList **lists;
+	TinyGL::GLList **lists;
 
 	lists = c->shared_state.lists;
 	count = 0;
-	for (i = 0; i < MAX_DISPLAY_LISTS; i++) {
+	// 0 is not a valid list, it reports a failure
+	for (i = 1; i < MAX_DISPLAY_LISTS; i++) {
 		if (!lists[i]) {
 			count++;
 			if (count == range) {
 				list = i - range + 1;
 				for (i = 0; i < range; i++) {
-					alloc_list(c, list + i);
+					TinyGL::alloc_list(c, list + i);
 				}
 				return list;
 			}
@@ -241,4 +479,11 @@ unsigned int glGenLists(int range) {
 	return 0;
 }
 
-} // end of namespace TinyGL
+void tglDeleteLists(unsigned int list, int range) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+
+	for (unsigned int i = list; i < list + range; i++) {
+		if (TinyGL::find_list(c, i))
+			TinyGL::delete_list(c, i);
+	}
+}
@@ -15,6 +15,8 @@ void gl_print_matrix(const float *m) {
 
 static inline void gl_matrix_update(GLContext *c) {
 	c->matrix_model_projection_updated = (c->matrix_mode <= 1);
+	if (c->matrix_model_projection_updated)
+		gl_invalidate_vertex_cache(c);
 }
 
 void glopMatrixMode(GLContext *c, GLParam *p) {
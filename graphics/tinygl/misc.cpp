@@ -35,6 +35,7 @@ void glopViewport(GLContext *c, GLParam *p) {
 		c->viewport.ysize = ysize;
 
 		c->viewport.updated = 1;
+		gl_invalidate_vertex_cache(c);
 	}
 }
 
@@ -47,15 +48,21 @@ void glopEnableDisable(GLContext *c, GLParam *p) {
 		c->cull_face_enabled = v;
 		break;
 	case TGL_LIGHTING:
+		if (c->lighting_enabled != v)
+			gl_invalidate_vertex_cache(c);
 		c->lighting_enabled = v;
 		break;
 	case TGL_COLOR_MATERIAL:
+		if (c->color_material_enabled != v)
+			gl_invalidate_vertex_cache(c);
 		c->color_material_enabled = v;
 		break;
 	case TGL_TEXTURE_2D:
 		c->texture_2d_enabled=v;
 		break;
 	case TGL_NORMALIZE:
+		if (c->normalize_enabled != v)
+			gl_invalidate_vertex_cache(c);
 		c->normalize_enabled=v;
 		break;
 	case TGL_DEPTH_TEST:
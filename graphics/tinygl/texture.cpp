@@ -55,10 +55,108 @@ GLTexture *alloc_texture(GLContext *c, int h) {
 	*ht = t;
 
 	t->handle = h;
+	// Unlike OpenGL, sample the base level with no filtering by default
+	t->min_filter = TGL_NEAREST;
+	t->mag_filter = TGL_NEAREST;
 
 	return t;
 }
 
+// Build the missing levels of the mip chain, down to 1x1, each from the
+// previous one. Only opaque texels are drawn, so the alpha of a texel is
+// whether most of its four source texels are opaque, and its color the
+// average of the opaque ones. Averaging the alpha instead would make
+// holes grow with each level.
+static void gl_build_mipmaps(GLTexture *t) {
+	const Graphics::PixelFormat &format = t->images[0].pixmap.getFormat();
+
+	for (int level = MAX(t->levels, 1); level <= ZB_TEXTURE_SIZE_SHIFT; level++) {
+		int shift = ZB_TEXTURE_SIZE_SHIFT - level;
+		int size = 1 << shift;
+		GLImage *src = &t->images[level - 1];
+		GLImage *dst = &t->images[level];
+
+		if (dst->pixmap)
+			dst->pixmap.free();
+		dst->pixmap = Graphics::PixelBuffer(format, size * size, DisposeAfterUse::NO);
+		dst->xsize = size;
+		dst->ysize = size;
+
+		for (int v = 0; v < size; v++) {
+			for (int u = 0; u < size; u++) {
+				unsigned int sum[3] = { 0, 0, 0 }, opaqueSum[3] = { 0, 0, 0 };
+				int opaque = 0;
+
+				for (int i = 0; i < 4; i++) {
+					int index = ((v * 2 + (i >> 1)) << (shift + 1)) | (u * 2 + (i & 1));
+					uint8 a, r, g, b;
+					src->pixmap.getARGBAt(index, a, r, g, b);
+					sum[0] += r;
+					sum[1] += g;
+					sum[2] += b;
+					if (a == 0xFF) {
+						opaqueSum[0] += r;
+						opaqueSum[1] += g;
+						opaqueSum[2] += b;
+						opaque++;
+					}
+				}
+
+				int index = (v << shift) | u;
+				if (opaque >= 2) {
+					dst->pixmap.setPixelAt(index, 0xFF, opaqueSum[0] / opaque,
+										   opaqueSum[1] / opaque, opaqueSum[2] / opaque);
+				} else {
+					dst->pixmap.setPixelAt(index, 0, sum[0] / 4, sum[1] / 4, sum[2] / 4);
+				}
+			}
+		}
+	}
+
+	t->levels = ZB_TEXTURE_SIZE_SHIFT + 1;
+}
+
+static inline bool gl_is_mipmap_filter(int filter) {
+	return filter != TGL_NEAREST && filter != TGL_LINEAR;
+}
+
+// Choose the level of the mip chain and the filtering for a triangle, from
+// the ratio between its area in texels and its area on screen. The same
+// level is used for the whole triangle, and the *_MIPMAP_LINEAR filters
+// work like *_MIPMAP_NEAREST.
+void gl_select_texture_level(GLContext *c, ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
+	GLTexture *t = c->current_texture;
+	int filter = t->mag_filter;
+	int level = 0;
+
+	float area = (float)(p1->x - p0->x) * (float)(p2->y - p0->y) -
+				 (float)(p2->x - p0->x) * (float)(p1->y - p0->y);
+	// s and t have 14 fractional bits
+	float texelArea = ((float)(p1->s - p0->s) * (float)(p2->t - p0->t) -
+					   (float)(p2->s - p0->s) * (float)(p1->t - p0->t)) / (float)(1 << 28);
+	float ratio = area != 0 ? fabs(texelArea / area) : 0.0f;
+
+	if (ratio > 1.0f) {
+		filter = t->min_filter;
+		if (gl_is_mipmap_filter(filter)) {
+			// level n is used from a ratio of 4^n / 2
+			float threshold = 2.0f;
+			while (ratio >= threshold && level < ZB_TEXTURE_SIZE_SHIFT) {
+				level++;
+				threshold *= 4.0f;
+			}
+			if (t->levels == 0)
+				level = 0;
+			else if (level >= t->levels)
+				gl_build_mipmaps(t);
+		}
+	}
+
+	bool bilinear = filter == TGL_LINEAR || filter == TGL_LINEAR_MIPMAP_NEAREST ||
+					filter == TGL_LINEAR_MIPMAP_LINEAR;
+	ZB_setTexture(c->zb, t->images[level].pixmap, level, bilinear);
+}
+
 void glInitTextures(GLContext *c) {
 	// textures
 	c->texture_2d_enabled = 0;
@@ -167,13 +265,17 @@ void glopTexImage2D(GLContext *c, GLParam *p) {
 		memcpy(pixels1, pixels, 256 * 256 * bytes);
 	}
 
-	im = &c->current_texture->images[level];
+	GLTexture *t = c->current_texture;
+	im = &t->images[level];
 	im->xsize = width;
 	im->ysize = height;
 	if (im->pixmap)
 		im->pixmap.free();
 	im->pixmap = Graphics::PixelBuffer(pf, pixels1);
 
+	// the rest of the mip chain is built again when needed
+	t->levels = 1;
+
 	if (do_free_after_rgb2rgba)
 		gl_free(pixels);
 }
@@ -197,10 +299,11 @@ error:
 }
 
 // TODO: not all tests are done
-void glopTexParameter(GLContext *, GLParam *p) {
+void glopTexParameter(GLContext *c, GLParam *p) {
 	int target = p[1].i;
 	int pname = p[2].i;
 	int param = p[3].i;
+	GLTexture *t = c->current_texture;
 
 	if (target != TGL_TEXTURE_2D) {
 error:
@@ -213,6 +316,25 @@ error:
 		if (param != TGL_REPEAT)
 			goto error;
 		break;
+	case TGL_TEXTURE_MIN_FILTER:
+		switch (param) {
+		case TGL_NEAREST:
+		case TGL_LINEAR:
+		case TGL_NEAREST_MIPMAP_NEAREST:
+		case TGL_NEAREST_MIPMAP_LINEAR:
+		case TGL_LINEAR_MIPMAP_NEAREST:
+		case TGL_LINEAR_MIPMAP_LINEAR:
+			t->min_filter = param;
+			break;
+		default:
+			goto error;
+		}
+		break;
+	case TGL_TEXTURE_MAG_FILTER:
+		if (param != TGL_NEAREST && param != TGL_LINEAR)
+			goto error;
+		t->mag_filter = param;
+		break;
 	default:
 		;
 	}
@@ -14,6 +14,8 @@ void glopNormal(GLContext *c, GLParam *p) {
 	c->current_normal.Y = v.Y;
 	c->current_normal.Z = v.Z;
 	c->current_normal.W = 0;
+
+	gl_invalidate_vertex_cache(c);
 }
 
 void glopTexCoord(GLContext *c, GLParam *p) {
@@ -36,16 +38,37 @@ void glopColor(GLContext *c, GLParam *p){
 	c->longcurrent_color[1] = p[6].ui;
 	c->longcurrent_color[2] = p[7].ui;
 
-	if (c->color_material_enabled) {
-		GLParam q[7];
-		q[0].op = OP_Material;
-		q[1].i = c->current_color_material_mode;
-		q[2].i = c->current_color_material_type;
-		q[3].f = p[1].f;
-		q[4].f = p[2].f;
-		q[5].f = p[3].f;
-		q[6].f = p[4].f;
-		glopMaterial(c, q);
+	if (c->color_material_enabled)
+		gl_set_material(c, c->current_color_material_mode, c->current_color_material_type, c->current_color.v);
+
+	gl_invalidate_vertex_cache(c);
+}
+
+// Used for colors coming from a color array. Unlike glopColor() this does
+// not invalidate the vertex cache, since the color is part of the vertex.
+void gl_set_current_color(GLContext *c, float r, float g, float b, float a) {
+	c->current_color.X = r;
+	c->current_color.Y = g;
+	c->current_color.Z = b;
+	c->current_color.W = a;
+	c->longcurrent_color[0] = (unsigned int)(r * (ZB_POINT_RED_MAX - ZB_POINT_RED_MIN) + ZB_POINT_RED_MIN);
+	c->longcurrent_color[1] = (unsigned int)(g * (ZB_POINT_GREEN_MAX - ZB_POINT_GREEN_MIN) + ZB_POINT_GREEN_MIN);
+	c->longcurrent_color[2] = (unsigned int)(b * (ZB_POINT_BLUE_MAX - ZB_POINT_BLUE_MIN) + ZB_POINT_BLUE_MIN);
+
+	if (c->color_material_enabled)
+		gl_set_material(c, c->current_color_material_mode, c->current_color_material_type, c->current_color.v);
+}
+
+// Called whenever state used by gl_process_vertex changes, so that
+// vertices in the post-transform cache get processed again.
+void gl_invalidate_vertex_cache(GLContext *c) {
+	c->vertex_cache_epoch++;
+
+	if (c->vertex_cache_epoch == 0) {
+		// Wrapped around: old stamps could match again
+		if (c->vertex_cache_stamp)
+			memset(c->vertex_cache_stamp, 0, c->vertex_cache_max * sizeof(unsigned int));
+		c->vertex_cache_epoch = 1;
 	}
 }
 
@@ -76,6 +99,11 @@ void glopBegin(GLContext *c, GLParam *p) {
 	c->vertex_n = 0;
 	c->vertex_cnt = 0;
 
+	// with color material the lighting of each vertex depends on its own
+	// color, which the batched path does not handle
+	c->vertex_batching = !(c->lighting_enabled && c->color_material_enabled);
+	c->vertex_batch_n = 0;
+
 	if (c->matrix_model_projection_updated) {
 		if (c->lighting_enabled) {
 			// precompute inverse modelview
@@ -138,7 +166,7 @@ void glopBegin(GLContext *c, GLParam *p) {
 // TODO : handle all cases
 static inline void gl_vertex_transform(GLContext *c, GLVertex *v) {
 	float *m;
-	V4 *n;
+	V3 n;
 
 	if (c->lighting_enabled) {
 		// eye coordinates needed for lighting 
@@ -161,11 +189,11 @@ static inline void gl_vertex_transform(GLContext *c, GLVertex *v) {
 		v->pc.W = (v->ec.X * m[12] + v->ec.Y * m[13] + v->ec.Z * m[14] + v->ec.W * m[15]);
 
 		m = &c->matrix_model_view_inv.m[0][0];
-		n = &c->current_normal;
+		n = v->normal;
 
-		v->normal.X = (n->X * m[0] + n->Y * m[1] + n->Z * m[2]);
-		v->normal.Y = (n->X * m[4] + n->Y * m[5] + n->Z * m[6]);
-		v->normal.Z = (n->X * m[8] + n->Y * m[9] + n->Z * m[10]);
+		v->normal.X = (n.X * m[0] + n.Y * m[1] + n.Z * m[2]);
+		v->normal.Y = (n.X * m[4] + n.Y * m[5] + n.Z * m[6]);
+		v->normal.Z = (n.X * m[8] + n.Y * m[9] + n.Z * m[10]);
 
 		if (c->normalize_enabled) {
 			gl_V3_Norm(&v->normal);
@@ -188,16 +216,8 @@ static inline void gl_vertex_transform(GLContext *c, GLVertex *v) {
 	v->clip_code = gl_clipcode(v->pc.X, v->pc.Y, v->pc.Z, v->pc.W);
 }
 
-void glopVertex(GLContext *c, GLParam *p) {
-	GLVertex *v;
-	int n, i, cnt;
-
-	assert(c->in_begin != 0);
-
-	n = c->vertex_n;
-	cnt = c->vertex_cnt;
-	cnt++;
-	c->vertex_cnt = cnt;
+GLVertex *gl_alloc_vertex(GLContext *c) {
+	int n = c->vertex_n;
 
 	// quick fix to avoid crashes on large polygons
 	if (n >= c->vertex_max) {
@@ -211,41 +231,120 @@ void glopVertex(GLContext *c, GLParam *p) {
 		gl_free(c->vertex);
 		c->vertex = newarray;
 	}
+
+	return &c->vertex[n];
+}
+
+// Give a new vertex the current normal, color, texture coordinates and
+// edge flag.
+void gl_load_vertex_attributes(GLContext *c, GLVertex *v) {
+	v->normal.X = c->current_normal.X;
+	v->normal.Y = c->current_normal.Y;
+	v->normal.Z = c->current_normal.Z;
+	v->color = c->current_color;
+	v->tex_coord = c->current_tex_coord;
+	v->edge_flag = c->current_edge_flag;
+}
+
+static inline void gl_vertex_tex_coord(GLContext *c, GLVertex *v) {
+	if (c->texture_2d_enabled && c->apply_texture_matrix) {
+		V4 t = v->tex_coord;
+		gl_M4_MulV4(&v->tex_coord, c->matrix_stack_ptr[2], &t);
+	}
+}
+
+// Transform, light and project a vertex whose coordinates and attributes
+// are set.
+void gl_process_vertex(GLContext *c, GLVertex *v) {
+	gl_vertex_transform(c, v);
+
+	// color
+
+	if (c->lighting_enabled)
+		gl_shade_vertex(c, v);
+
+	gl_finish_vertex(c, v);
+}
+
+// Last step of the processing of a transformed and lit vertex: texture
+// coordinates and mapping to the viewport.
+void gl_finish_vertex(GLContext *c, GLVertex *v) {
+	gl_vertex_tex_coord(c, v);
+
+	// precompute the mapping to the viewport
+	if (v->clip_code == 0)
+		gl_transform_to_viewport(c, v);
+}
+
+// Texture coordinates and the edge flag are not part of what the vertex
+// cache stores: apply the current ones to a vertex taken from it.
+void gl_reuse_vertex(GLContext *c, GLVertex *v) {
+	v->tex_coord = c->current_tex_coord;
+	gl_vertex_tex_coord(c, v);
+
+	if (v->clip_code == 0)
+		gl_transform_texcoord_to_viewport(c, v);
+
+	v->edge_flag = c->current_edge_flag;
+}
+
+void glopVertex(GLContext *c, GLParam *p) {
+	GLVertex *v;
+
+	assert(c->in_begin != 0);
+
 	// new vertex entry
-	v = &c->vertex[n];
-	n++;
+	if (c->vertex_batching)
+		v = &c->vertex_batch[c->vertex_batch_n++];
+	else
+		v = gl_alloc_vertex(c);
 
 	v->coord.X = p[1].f;
 	v->coord.Y = p[2].f;
 	v->coord.Z = p[3].f;
 	v->coord.W = p[4].f;
 
-	gl_vertex_transform(c, v);
-
-	// color
+	gl_load_vertex_attributes(c, v);
 
-	if (c->lighting_enabled) {
-		gl_shade_vertex(c, v);
+	if (c->vertex_batching) {
+		if (c->vertex_batch_n == VERTEX_BATCH_SIZE)
+			gl_flush_vertex_batch(c);
 	} else {
-		v->color = c->current_color;
+		gl_process_vertex(c, v);
+		gl_assemble_vertex(c);
 	}
+}
 
-	// tex coords
+// Process the vertices collected since glBegin or the last flush together
+// and add them to the current primitive.
+void gl_flush_vertex_batch(GLContext *c) {
+	GLVertex *batch[VERTEX_BATCH_SIZE];
+	int i, n = c->vertex_batch_n;
 
-	if (c->texture_2d_enabled) {
-		if (c->apply_texture_matrix) {
-			gl_M4_MulV4(&v->tex_coord, c->matrix_stack_ptr[2], &c->current_tex_coord);
-		} else {
-			v->tex_coord = c->current_tex_coord;
-		}
+	if (n == 0)
+		return;
+
+	for (i = 0; i < n; i++)
+		batch[i] = &c->vertex_batch[i];
+	gl_process_vertices(c, batch, n);
+
+	for (i = 0; i < n; i++) {
+		*gl_alloc_vertex(c) = c->vertex_batch[i];
+		gl_assemble_vertex(c);
 	}
-    // precompute the mapping to the viewport
-	if (v->clip_code == 0)
-		gl_transform_to_viewport(c, v);
 
-    // edge flag
+	c->vertex_batch_n = 0;
+}
 
-	v->edge_flag = c->current_edge_flag;
+// Add the vertex at c->vertex[c->vertex_n] to the current primitive and
+// draw what it completes.
+void gl_assemble_vertex(GLContext *c) {
+	int n, i, cnt;
+
+	n = c->vertex_n + 1;
+	cnt = c->vertex_cnt;
+	cnt++;
+	c->vertex_cnt = cnt;
 
 	switch (c->begin_type) {
 	case TGL_POINTS:
@@ -328,6 +427,8 @@ void glopVertex(GLContext *c, GLParam *p) {
 void glopEnd(GLContext *c, GLParam *) {
 	assert(c->in_begin == 1);
 
+	gl_flush_vertex_batch(c);
+
 	if (c->begin_type == TGL_LINE_LOOP) {
 		if (c->vertex_cnt >= 3) {
 			gl_draw_line(c, &c->vertex[0], &c->vertex[2]);
@@ -0,0 +1,500 @@
+
+#include "graphics/tinygl/zgl.h"
+
+// Batched version of gl_process_vertex(): the vertices are transformed,
+// clip coded and lit four at a time, in structure of arrays form, with SSE
+// or NEON when available. The results match the ones of the per-vertex
+// path.
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define TINYGL_SSE
+#elif defined(__aarch64__) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#define TINYGL_NEON
+#endif
+
+namespace TinyGL {
+
+// One component of four vertices, and the result of comparing them
+
+#if defined(TINYGL_SSE)
+
+typedef __m128 Vec4;
+typedef __m128 Mask4;
+
+static inline Vec4 v4Load(const float *p) { return _mm_loadu_ps(p); }
+static inline void v4Store(float *p, Vec4 a) { _mm_storeu_ps(p, a); }
+static inline Vec4 v4Set(float f) { return _mm_set1_ps(f); }
+static inline Vec4 v4Add(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+static inline Vec4 v4Sub(Vec4 a, Vec4 b) { return _mm_sub_ps(a, b); }
+static inline Vec4 v4Mul(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+static inline Vec4 v4Div(Vec4 a, Vec4 b) { return _mm_div_ps(a, b); }
+static inline Vec4 v4Sqrt(Vec4 a) { return _mm_sqrt_ps(a); }
+static inline Vec4 v4Abs(Vec4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline Mask4 v4Greater(Vec4 a, Vec4 b) { return _mm_cmpgt_ps(a, b); }
+static inline Mask4 v4Less(Vec4 a, Vec4 b) { return _mm_cmplt_ps(a, b); }
+static inline Mask4 v4NotEqual(Vec4 a, Vec4 b) { return _mm_cmpneq_ps(a, b); }
+static inline Mask4 v4And(Mask4 a, Mask4 b) { return _mm_and_ps(a, b); }
+static inline Vec4 v4Select(Mask4 m, Vec4 a, Vec4 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline int v4Bits(Mask4 m) { return _mm_movemask_ps(m); }
+
+#elif defined(TINYGL_NEON)
+
+typedef float32x4_t Vec4;
+typedef uint32x4_t Mask4;
+
+static inline Vec4 v4Load(const float *p) { return vld1q_f32(p); }
+static inline void v4Store(float *p, Vec4 a) { vst1q_f32(p, a); }
+static inline Vec4 v4Set(float f) { return vdupq_n_f32(f); }
+static inline Vec4 v4Add(Vec4 a, Vec4 b) { return vaddq_f32(a, b); }
+static inline Vec4 v4Sub(Vec4 a, Vec4 b) { return vsubq_f32(a, b); }
+static inline Vec4 v4Mul(Vec4 a, Vec4 b) { return vmulq_f32(a, b); }
+static inline Vec4 v4Div(Vec4 a, Vec4 b) { return vdivq_f32(a, b); }
+static inline Vec4 v4Sqrt(Vec4 a) { return vsqrtq_f32(a); }
+static inline Vec4 v4Abs(Vec4 a) { return vabsq_f32(a); }
+static inline Mask4 v4Greater(Vec4 a, Vec4 b) { return vcgtq_f32(a, b); }
+static inline Mask4 v4Less(Vec4 a, Vec4 b) { return vcltq_f32(a, b); }
+static inline Mask4 v4NotEqual(Vec4 a, Vec4 b) { return vmvnq_u32(vceqq_f32(a, b)); }
+static inline Mask4 v4And(Mask4 a, Mask4 b) { return vandq_u32(a, b); }
+static inline Vec4 v4Select(Mask4 m, Vec4 a, Vec4 b) { return vbslq_f32(m, a, b); }
+static inline int v4Bits(Mask4 m) {
+	uint32x4_t b = vshrq_n_u32(m, 31);
+	return vgetq_lane_u32(b, 0) | (vgetq_lane_u32(b, 1) << 1) |
+		(vgetq_lane_u32(b, 2) << 2) | (vgetq_lane_u32(b, 3) << 3);
+}
+
+#else
+
+struct Vec4 {
+	float v[4];
+};
+
+struct Mask4 {
+	bool m[4];
+};
+
+static inline Vec4 v4Load(const float *p) {
+	Vec4 r;
+	for (int i = 0; i < 4; i++)
+		r.v[i] = p[i];
+	return r;
+}
+
+static inline void v4Store(float *p, Vec4 a) {
+	for (int i = 0; i < 4; i++)
+		p[i] = a.v[i];
+}
+
+static inline Vec4 v4Set(float f) {
+	Vec4 r;
+	for (int i = 0; i < 4; i++)
+		r.v[i] = f;
+	return r;
+}
+
+#define TINYGL_VEC4_OP(name, expr) \
+	static inline Vec4 name(Vec4 a, Vec4 b) { \
+		Vec4 r; \
+		for (int i = 0; i < 4; i++) \
+			r.v[i] = expr; \
+		return r; \
+	}
+
+TINYGL_VEC4_OP(v4Add, a.v[i] + b.v[i])
+TINYGL_VEC4_OP(v4Sub, a.v[i] - b.v[i])
+TINYGL_VEC4_OP(v4Mul, a.v[i] * b.v[i])
+TINYGL_VEC4_OP(v4Div, a.v[i] / b.v[i])
+
+#undef TINYGL_VEC4_OP
+
+#define TINYGL_MASK4_OP(name, expr) \
+	static inline Mask4 name(Vec4 a, Vec4 b) { \
+		Mask4 r; \
+		for (int i = 0; i < 4; i++) \
+			r.m[i] = expr; \
+		return r; \
+	}
+
+TINYGL_MASK4_OP(v4Greater, a.v[i] > b.v[i])
+TINYGL_MASK4_OP(v4Less, a.v[i] < b.v[i])
+TINYGL_MASK4_OP(v4NotEqual, a.v[i] != b.v[i])
+
+#undef TINYGL_MASK4_OP
+
+static inline Vec4 v4Sqrt(Vec4 a) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] = sqrt(a.v[i]);
+	return a;
+}
+
+static inline Vec4 v4Abs(Vec4 a) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] = fabs(a.v[i]);
+	return a;
+}
+
+static inline Mask4 v4And(Mask4 a, Mask4 b) {
+	for (int i = 0; i < 4; i++)
+		a.m[i] = a.m[i] && b.m[i];
+	return a;
+}
+
+static inline Vec4 v4Select(Mask4 m, Vec4 a, Vec4 b) {
+	for (int i = 0; i < 4; i++)
+		a.v[i] = m.m[i] ? a.v[i] : b.v[i];
+	return a;
+}
+
+static inline int v4Bits(Mask4 m) {
+	return m.m[0] | (m.m[1] << 1) | (m.m[2] << 2) | (m.m[3] << 3);
+}
+
+#endif
+
+// x * m[0] + y * m[1] + z * m[2] + m[3], with m[] already splatted
+static inline Vec4 v4Transform3(Vec4 x, Vec4 y, Vec4 z, const Vec4 *m) {
+	return v4Add(v4Add(v4Add(v4Mul(x, m[0]), v4Mul(y, m[1])), v4Mul(z, m[2])), m[3]);
+}
+
+static inline Vec4 v4Transform4(Vec4 x, Vec4 y, Vec4 z, Vec4 w, const Vec4 *m) {
+	return v4Add(v4Add(v4Add(v4Mul(x, m[0]), v4Mul(y, m[1])), v4Mul(z, m[2])), v4Mul(w, m[3]));
+}
+
+static inline Vec4 v4Dot3(Vec4 x1, Vec4 y1, Vec4 z1, Vec4 x2, Vec4 y2, Vec4 z2) {
+	return v4Add(v4Add(v4Mul(x1, x2), v4Mul(y1, y2)), v4Mul(z1, z2));
+}
+
+static void v4SetMatrix(Vec4 *dst, const M4 *m) {
+	const float *f = &m->m[0][0];
+	for (int i = 0; i < 16; i++)
+		dst[i] = v4Set(f[i]);
+}
+
+// Structure of arrays copy of a batch of vertices
+struct VertexBatch {
+	float x[VERTEX_BATCH_SIZE], y[VERTEX_BATCH_SIZE], z[VERTEX_BATCH_SIZE];
+	float nx[VERTEX_BATCH_SIZE], ny[VERTEX_BATCH_SIZE], nz[VERTEX_BATCH_SIZE];
+	float ex[VERTEX_BATCH_SIZE], ey[VERTEX_BATCH_SIZE], ez[VERTEX_BATCH_SIZE], ew[VERTEX_BATCH_SIZE];
+	float px[VERTEX_BATCH_SIZE], py[VERTEX_BATCH_SIZE], pz[VERTEX_BATCH_SIZE], pw[VERTEX_BATCH_SIZE];
+	float r[VERTEX_BATCH_SIZE], g[VERTEX_BATCH_SIZE], b[VERTEX_BATCH_SIZE];
+	int clipCode[VERTEX_BATCH_SIZE];
+};
+
+static void gl_batch_transform(GLContext *c, VertexBatch *b, int lanes) {
+	Vec4 m[16], p[16], n[16];
+	int i;
+
+	if (c->lighting_enabled) {
+		// eye coordinates and normals needed for lighting
+		v4SetMatrix(m, c->matrix_stack_ptr[0]);
+		v4SetMatrix(p, c->matrix_stack_ptr[1]);
+		v4SetMatrix(n, &c->matrix_model_view_inv);
+
+		for (i = 0; i < lanes; i += 4) {
+			Vec4 x = v4Load(b->x + i);
+			Vec4 y = v4Load(b->y + i);
+			Vec4 z = v4Load(b->z + i);
+
+			Vec4 ex = v4Transform3(x, y, z, m);
+			Vec4 ey = v4Transform3(x, y, z, m + 4);
+			Vec4 ez = v4Transform3(x, y, z, m + 8);
+			Vec4 ew = v4Transform3(x, y, z, m + 12);
+			v4Store(b->ex + i, ex);
+			v4Store(b->ey + i, ey);
+			v4Store(b->ez + i, ez);
+			v4Store(b->ew + i, ew);
+
+			v4Store(b->px + i, v4Transform4(ex, ey, ez, ew, p));
+			v4Store(b->py + i, v4Transform4(ex, ey, ez, ew, p + 4));
+			v4Store(b->pz + i, v4Transform4(ex, ey, ez, ew, p + 8));
+			v4Store(b->pw + i, v4Transform4(ex, ey, ez, ew, p + 12));
+
+			x = v4Load(b->nx + i);
+			y = v4Load(b->ny + i);
+			z = v4Load(b->nz + i);
+			Vec4 nx = v4Dot3(x, y, z, n[0], n[1], n[2]);
+			Vec4 ny = v4Dot3(x, y, z, n[4], n[5], n[6]);
+			Vec4 nz = v4Dot3(x, y, z, n[8], n[9], n[10]);
+
+			if (c->normalize_enabled) {
+				Vec4 len = v4Sqrt(v4Dot3(nx, ny, nz, nx, ny, nz));
+				Mask4 nonZero = v4NotEqual(len, v4Set(0.0f));
+				nx = v4Select(nonZero, v4Div(nx, len), nx);
+				ny = v4Select(nonZero, v4Div(ny, len), ny);
+				nz = v4Select(nonZero, v4Div(nz, len), nz);
+			}
+			v4Store(b->nx + i, nx);
+			v4Store(b->ny + i, ny);
+			v4Store(b->nz + i, nz);
+		}
+	} else {
+		// no eye coordinates needed, no normal
+		// NOTE: W = 1 is assumed
+		v4SetMatrix(m, &c->matrix_model_projection);
+		if (c->matrix_model_projection_no_w_transform)
+			m[12] = m[13] = m[14] = v4Set(0.0f);
+
+		for (i = 0; i < lanes; i += 4) {
+			Vec4 x = v4Load(b->x + i);
+			Vec4 y = v4Load(b->y + i);
+			Vec4 z = v4Load(b->z + i);
+
+			v4Store(b->px + i, v4Transform3(x, y, z, m));
+			v4Store(b->py + i, v4Transform3(x, y, z, m + 4));
+			v4Store(b->pz + i, v4Transform3(x, y, z, m + 8));
+			v4Store(b->pw + i, v4Transform3(x, y, z, m + 12));
+		}
+	}
+
+	// clip codes, as computed by gl_clipcode()
+	Vec4 epsilon = v4Set((float)(1.0 + CLIP_EPSILON));
+	Vec4 zero = v4Set(0.0f);
+	for (i = 0; i < lanes; i += 4) {
+		Vec4 x = v4Load(b->px + i);
+		Vec4 y = v4Load(b->py + i);
+		Vec4 z = v4Load(b->pz + i);
+		Vec4 w = v4Mul(v4Load(b->pw + i), epsilon);
+		Vec4 nw = v4Sub(zero, w);
+		int bits[6] = {
+			v4Bits(v4Less(x, nw)), v4Bits(v4Greater(x, w)),
+			v4Bits(v4Less(y, nw)), v4Bits(v4Greater(y, w)),
+			v4Bits(v4Less(z, nw)), v4Bits(v4Greater(z, w))
+		};
+
+		for (int j = 0; j < 4; j++) {
+			int code = 0;
+			for (int k = 0; k < 6; k++)
+				code |= ((bits[k] >> j) & 1) << k;
+			b->clipCode[i + j] = code;
+		}
+	}
+}
+
+// Same computation as gl_shade_vertex(). The parts that need a table
+// lookup or pow() are done per vertex.
+static void gl_batch_shade(GLContext *c, VertexBatch *b, int lanes, int count) {
+	GLMaterial *m = &c->materials[0];
+	GLSpecBuf *specbuf = NULL;
+	int twoside = c->light_model_two_side;
+	Vec4 zero = v4Set(0.0f);
+	Vec4 one = v4Set(1.0f);
+	Vec4 baseR = v4Set(m->emission.v[0] + m->ambient.v[0] * c->ambient_light_model.v[0]);
+	Vec4 baseG = v4Set(m->emission.v[1] + m->ambient.v[1] * c->ambient_light_model.v[1]);
+	Vec4 baseB = v4Set(m->emission.v[2] + m->ambient.v[2] * c->ambient_light_model.v[2]);
+
+	for (int i = 0; i < lanes; i += 4) {
+		Vec4 nX = v4Load(b->nx + i);
+		Vec4 nY = v4Load(b->ny + i);
+		Vec4 nZ = v4Load(b->nz + i);
+		Vec4 eX = v4Load(b->ex + i);
+		Vec4 eY = v4Load(b->ey + i);
+		Vec4 eZ = v4Load(b->ez + i);
+		Vec4 R = baseR, G = baseG, B = baseB;
+		int valid = count - i;
+
+		for (GLLight *l = c->first_light; l != NULL; l = l->next) {
+			Vec4 lR = v4Set(l->ambient.v[0] * m->ambient.v[0]);
+			Vec4 lG = v4Set(l->ambient.v[1] * m->ambient.v[1]);
+			Vec4 lB = v4Set(l->ambient.v[2] * m->ambient.v[2]);
+			Vec4 dX, dY, dZ, att;
+			int skip = 0;
+
+			if (l->position.v[3] == 0) {
+				// light at infinity
+				dX = v4Set(l->position.v[0]);
+				dY = v4Set(l->position.v[1]);
+				dZ = v4Set(l->position.v[2]);
+				att = one;
+			} else {
+				// distance attenuation
+				dX = v4Sub(v4Set(l->position.v[0]), eX);
+				dY = v4Sub(v4Set(l->position.v[1]), eY);
+				dZ = v4Sub(v4Set(l->position.v[2]), eZ);
+				Vec4 dist = v4Sqrt(v4Dot3(dX, dY, dZ, dX, dY, dZ));
+				Mask4 far = v4Greater(dist, v4Set((float)1E-3));
+				Vec4 tmp = v4Div(one, dist);
+				dX = v4Select(far, v4Mul(dX, tmp), dX);
+				dY = v4Select(far, v4Mul(dY, tmp), dY);
+				dZ = v4Select(far, v4Mul(dZ, tmp), dZ);
+				att = v4Div(one, v4Add(v4Set(l->attenuation[0]), v4Mul(dist,
+						v4Add(v4Set(l->attenuation[1]), v4Mul(dist, v4Set(l->attenuation[2]))))));
+			}
+
+			Vec4 dot = v4Dot3(dX, dY, dZ, nX, nY, nZ);
+			if (twoside)
+				dot = v4Abs(dot);
+			Mask4 lit = v4Greater(dot, zero);
+			int litBits = v4Bits(lit);
+
+			if (litBits) {
+				// diffuse light
+				lR = v4Add(lR, v4Select(lit, v4Mul(v4Mul(dot, v4Set(l->diffuse.v[0])), v4Set(m->diffuse.v[0])), zero));
+				lG = v4Add(lG, v4Select(lit, v4Mul(v4Mul(dot, v4Set(l->diffuse.v[1])), v4Set(m->diffuse.v[1])), zero));
+				lB = v4Add(lB, v4Select(lit, v4Mul(v4Mul(dot, v4Set(l->diffuse.v[2])), v4Set(m->diffuse.v[2])), zero));
+
+				// spot light
+				if (l->spot_cutoff != 180) {
+					Vec4 dotSpot = v4Sub(zero, v4Dot3(dX, dY, dZ, v4Set(l->norm_spot_direction.v[0]),
+							v4Set(l->norm_spot_direction.v[1]), v4Set(l->norm_spot_direction.v[2])));
+					if (twoside)
+						dotSpot = v4Abs(dotSpot);
+					// no contribution at all outside of the cone
+					skip = v4Bits(v4And(lit, v4Less(dotSpot, v4Set(l->cos_spot_cutoff))));
+					litBits &= ~skip;
+
+					if (l->spot_exponent > 0 && litBits) {
+						float spot[4], a[4];
+						v4Store(spot, dotSpot);
+						v4Store(a, att);
+						for (int j = 0; j < 4 && j < valid; j++) {
+							if (litBits & (1 << j))
+								a[j] = a[j] * pow(spot[j], l->spot_exponent);
+						}
+						att = v4Load(a);
+					}
+				}
+
+				// specular light, skipped when it can only add zeroes
+				if (litBits &&
+						((l->specular.v[0] != 0 && m->specular.v[0] != 0) ||
+						 (l->specular.v[1] != 0 && m->specular.v[1] != 0) ||
+						 (l->specular.v[2] != 0 && m->specular.v[2] != 0))) {
+					Vec4 sX, sY, sZ;
+					if (c->local_light_model) {
+						Vec4 len = v4Sqrt(v4Dot3(eX, eY, eZ, eX, eY, eZ));
+						Mask4 nonZero = v4NotEqual(len, zero);
+						Vec4 vX = v4Select(nonZero, v4Div(eX, len), eX);
+						// same as gl_shade_vertex(), which only uses X
+						sX = v4Sub(dX, vX);
+						sY = v4Sub(dY, vX);
+						sZ = v4Sub(dZ, vX);
+					} else {
+						sX = dX;
+						sY = dY;
+						sZ = v4Add(dZ, one);
+					}
+					Vec4 dotSpec = v4Dot3(nX, nY, nZ, sX, sY, sZ);
+					if (twoside)
+						dotSpec = v4Abs(dotSpec);
+
+					float spec[4], len[4], r[4], g[4], bl[4];
+					v4Store(spec, dotSpec);
+					v4Store(len, v4Sqrt(v4Dot3(sX, sY, sZ, sX, sY, sZ)));
+					v4Store(r, lR);
+					v4Store(g, lG);
+					v4Store(bl, lB);
+					for (int j = 0; j < 4 && j < valid; j++) {
+						float dotSpecJ = spec[j];
+						int idx;
+
+						if (!(litBits & (1 << j)) || !(dotSpecJ > 0))
+							continue;
+						if (len[j] > 1E-3)
+							dotSpecJ = dotSpecJ / len[j];
+
+						if (!specbuf)
+							specbuf = specbuf_get_buffer(c, m->shininess_i, m->shininess);
+						float tmp = dotSpecJ * SPECULAR_BUFFER_SIZE;
+						if (tmp > SPECULAR_BUFFER_SIZE)
+							idx = SPECULAR_BUFFER_SIZE;
+						else
+							idx = (int)tmp;
+
+						dotSpecJ = specbuf->buf[idx];
+						r[j] += dotSpecJ * l->specular.v[0] * m->specular.v[0];
+						g[j] += dotSpecJ * l->specular.v[1] * m->specular.v[1];
+						bl[j] += dotSpecJ * l->specular.v[2] * m->specular.v[2];
+					}
+					lR = v4Load(r);
+					lG = v4Load(g);
+					lB = v4Load(bl);
+				}
+			}
+
+			if (skip) {
+				float keep[4];
+				for (int j = 0; j < 4; j++)
+					keep[j] = (skip & (1 << j)) ? 0.0f : 1.0f;
+				Mask4 add = v4Greater(v4Load(keep), zero);
+				R = v4Select(add, v4Add(R, v4Mul(att, lR)), R);
+				G = v4Select(add, v4Add(G, v4Mul(att, lG)), G);
+				B = v4Select(add, v4Add(B, v4Mul(att, lB)), B);
+			} else {
+				R = v4Add(R, v4Mul(att, lR));
+				G = v4Add(G, v4Mul(att, lG));
+				B = v4Add(B, v4Mul(att, lB));
+			}
+		}
+
+		v4Store(b->r + i, R);
+		v4Store(b->g + i, G);
+		v4Store(b->b + i, B);
+	}
+}
+
+static void gl_process_batch(GLContext *c, GLVertex **v, int count) {
+	VertexBatch b;
+	int lanes = (count + 3) & ~3;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		b.x[i] = v[i]->coord.X;
+		b.y[i] = v[i]->coord.Y;
+		b.z[i] = v[i]->coord.Z;
+		b.nx[i] = v[i]->normal.X;
+		b.ny[i] = v[i]->normal.Y;
+		b.nz[i] = v[i]->normal.Z;
+	}
+	// the unused lanes of the last group are computed and dropped
+	for (; i < lanes; i++) {
+		b.x[i] = b.y[i] = b.z[i] = 0.0f;
+		b.nx[i] = b.ny[i] = b.nz[i] = 0.0f;
+	}
+
+	gl_batch_transform(c, &b, lanes);
+
+	if (c->lighting_enabled) {
+		float A = clampf(c->materials[0].diffuse.v[3], 0, 1);
+
+		gl_batch_shade(c, &b, lanes, count);
+
+		for (i = 0; i < count; i++) {
+			GLVertex *vx = v[i];
+			vx->ec.X = b.ex[i];
+			vx->ec.Y = b.ey[i];
+			vx->ec.Z = b.ez[i];
+			vx->ec.W = b.ew[i];
+			vx->normal.X = b.nx[i];
+			vx->normal.Y = b.ny[i];
+			vx->normal.Z = b.nz[i];
+			vx->color.v[0] = clampf(b.r[i], 0, 1);
+			vx->color.v[1] = clampf(b.g[i], 0, 1);
+			vx->color.v[2] = clampf(b.b[i], 0, 1);
+			vx->color.v[3] = A;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		GLVertex *vx = v[i];
+		vx->pc.X = b.px[i];
+		vx->pc.Y = b.py[i];
+		vx->pc.Z = b.pz[i];
+		vx->pc.W = b.pw[i];
+		vx->clip_code = b.clipCode[i];
+		gl_finish_vertex(c, vx);
+	}
+}
+
+// Process count vertices whose coordinates and attributes are set, like
+// gl_process_vertex() does for one.
+void gl_process_vertices(GLContext *c, GLVertex **v, int count) {
+	while (count > 0) {
+		int n = MIN(count, VERTEX_BATCH_SIZE);
+		gl_process_batch(c, v, n);
+		v += n;
+		count -= n;
+	}
+}
+
+} // end of namespace TinyGL
@@ -48,6 +48,8 @@ ZBuffer *ZB_open(int xsize, int ysize, const Graphics::PixelBuffer &frame_buffer
 	}
 
 	zb->current_texture = NULL;
+	zb->current_texture_level = 0;
+	zb->current_texture_bilinear = 0;
 	zb->shadow_mask_buf = NULL;
 
 	zb->buffer.pbuf = zb->pbuf.getRawBuffer();
@@ -59,6 +59,8 @@ typedef struct {
 	unsigned char *dctable;
 	int *ctable;
 	Graphics::PixelBuffer current_texture;
+	int current_texture_level;
+	int current_texture_bilinear;
 } ZBuffer;
 
 typedef struct {
@@ -97,7 +99,10 @@ void ZB_line_z(ZBuffer * zb, ZBufferPoint * p1, ZBufferPoint * p2);
 
 // ztriangle.c */
 
-void ZB_setTexture(ZBuffer *zb, const Graphics::PixelBuffer &texture);
+// Textures are 256x256, level n of their mip chain is (256 >> n) wide
+#define ZB_TEXTURE_SIZE_SHIFT 8
+
+void ZB_setTexture(ZBuffer *zb, const Graphics::PixelBuffer &texture, int level, bool bilinear);
 void ZB_fillTriangleDepthOnly(ZBuffer *zb, ZBufferPoint *p1,
 						 ZBufferPoint *p2, ZBufferPoint *p3);
 void ZB_fillTriangleFlat(ZBuffer *zb, ZBufferPoint *p1,
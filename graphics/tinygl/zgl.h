@@ -22,6 +22,10 @@ enum {
 // initially # of allocated GLVertexes (will grow when necessary)
 #define POLYGON_MAX_VERTEX 16
 
+// # of vertices transformed and lit together between glBegin and glEnd
+// (must be a multiple of 4)
+#define VERTEX_BATCH_SIZE 64
+
 // Max # of specular light pow buffers
 #define MAX_SPECULAR_BUFFERS 8
 // # of entries in specular buffer
@@ -104,8 +108,11 @@ typedef struct GLParamBuffer {
 	struct GLParamBuffer *next;
 } GLParamBuffer;
 
+struct GLCompiledList;
+
 typedef struct GLList {
 	GLParamBuffer *first_op_buffer;
+	struct GLCompiledList *compiled;
 	// TODO: extensions for an hash table or a better allocating scheme
 } GLList;
 
@@ -123,6 +130,36 @@ typedef struct GLVertex {
 	ZBufferPoint zp;      // integer coordinates for the rasterization
 } GLVertex;
 
+typedef struct GLCompiledPrimitive {
+	int type;
+	int first, count;     // range of vertices
+} GLCompiledPrimitive;
+
+// A display list made only of primitives, decoded once into a vertex
+// buffer. The processed vertices are kept for as long as the state they
+// were computed with does not change.
+typedef struct GLCompiledList {
+	GLCompiledPrimitive *primitives;
+	int primitive_count;
+	GLVertex *vertices;   // coordinates and attributes
+	GLVertex *processed;
+	int vertex_count;
+
+	// The first vertices before any Color, TexCoord or EdgeFlag op in the
+	// list take the attribute from the state at call time
+	int color_from, tex_coord_from, edge_flag_from;
+	// last attribute ops, which set the current state after a call
+	GLParam *last_color, *last_normal, *last_tex_coord, *last_edge_flag;
+
+	// state the processed vertices were computed with
+	int processed_valid;
+	M4 model_view, projection, texture;
+	V3 viewport_scale, viewport_trans;
+	int texture_2d_enabled;
+	V4 color, tex_coord;
+	int edge_flag;
+} GLCompiledList;
+
 typedef struct GLImage {
 	Graphics::PixelBuffer pixmap;
 	int xsize, ysize;
@@ -134,6 +171,8 @@ typedef struct GLImage {
 
 typedef struct GLTexture {
 	GLImage images[MAX_TEXTURE_LEVELS];
+	int levels;           // # of levels of the mip chain already built
+	int min_filter, mag_filter;
 	int handle;
 	struct GLTexture *next, *prev;
 } GLTexture;
@@ -178,6 +217,7 @@ typedef struct GLContext {
 	GLSharedState shared_state;
 
 	// current list
+	GLList *current_list;
 	GLParamBuffer *current_op_buffer;
 	int current_op_buffer_index;
 	int exec_flag, compile_flag, print_flag;
@@ -238,6 +278,11 @@ typedef struct GLContext {
 	int vertex_max;
 	GLVertex *vertex;
 
+	// vertices waiting to be processed as a batch
+	int vertex_batching;
+	int vertex_batch_n;
+	GLVertex *vertex_batch;
+
 	// opengl 1.1 arrays
 	float *vertex_array;
 	int vertex_array_size;
@@ -252,6 +297,16 @@ typedef struct GLContext {
 	int texcoord_array_stride;
 	int client_states;
 
+	// post-transform vertex cache, used by glDrawElements and by
+	// glArrayElement while the arrays are locked
+	int arrays_locked;
+	int vertex_cache_first;
+	int vertex_cache_count;
+	int vertex_cache_max;
+	unsigned int vertex_cache_epoch;
+	unsigned int *vertex_cache_stamp;
+	GLVertex *vertex_cache;
+
 	// opengl 1.1 polygon offset
 	float offset_factor;
 	float offset_units;
@@ -282,6 +337,7 @@ void gl_add_op(GLParam *p);
 
 // clip.c
 void gl_transform_to_viewport(GLContext *c, GLVertex *v);
+void gl_transform_texcoord_to_viewport(GLContext *c, GLVertex *v);
 void gl_draw_triangle(GLContext *c, GLVertex *p0, GLVertex *p1, GLVertex *p2);
 void gl_draw_line(GLContext *c, GLVertex *p0, GLVertex *p1);
 void gl_draw_point(GLContext *c, GLVertex *p0);
@@ -298,11 +354,27 @@ void gl_print_matrix(const float *m);
 void gl_add_select(GLContext *c, unsigned int zmin, unsigned int zmax);
 void gl_enable_disable_light(GLContext *c, int light, int v);
 void gl_shade_vertex(GLContext *c, GLVertex *v);
+void gl_set_material(GLContext *c, int mode, int type, const float *v);
+
+// vertex.c
+GLVertex *gl_alloc_vertex(GLContext *c);
+void gl_load_vertex_attributes(GLContext *c, GLVertex *v);
+void gl_process_vertex(GLContext *c, GLVertex *v);
+void gl_finish_vertex(GLContext *c, GLVertex *v);
+void gl_flush_vertex_batch(GLContext *c);
+void gl_reuse_vertex(GLContext *c, GLVertex *v);
+void gl_assemble_vertex(GLContext *c);
+void gl_set_current_color(GLContext *c, float r, float g, float b, float a);
+void gl_invalidate_vertex_cache(GLContext *c);
+
+// vertex_batch.c
+void gl_process_vertices(GLContext *c, GLVertex **v, int count);
 
 void glInitTextures(GLContext *c);
 void glEndTextures(GLContext *c);
 GLTexture *alloc_texture(GLContext *c, int h);
 void free_texture(GLContext *c, int h);
+void gl_select_texture_level(GLContext *c, ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2);
 
 // image_util.c
 void gl_resizeImage(unsigned char *dest, int xsize_dest, int ysize_dest,
@@ -346,6 +418,15 @@ static inline int gl_clipcode(float x, float y, float z, float w1) {
 	return (x < -w) | ((x > w) << 1) | ((y < -w) << 2) | ((y > w) << 3) | ((z < -w) << 4) | ((z > w) << 5);
 }
 
+static inline float clampf(float a, float min, float max) {
+	if (a < min)
+		return min;
+	else if (a > max)
+		return max;
+	else
+		return a;
+}
+
 } // end of namespace TinyGL
 
 #endif
@@ -104,8 +104,10 @@ void ZB_fillTriangleSmooth(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoint *p1, ZBuf
 #include "graphics/tinygl/ztriangle.h"
 }
 
-void ZB_setTexture(ZBuffer *zb, const Graphics::PixelBuffer &texture) {
-	zb->current_texture=texture;
+void ZB_setTexture(ZBuffer *zb, const Graphics::PixelBuffer &texture, int level, bool bilinear) {
+	zb->current_texture = texture;
+	zb->current_texture_level = level;
+	zb->current_texture_bilinear = bilinear;
 }
 
 void ZB_fillTriangleMapping(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
@@ -131,8 +133,92 @@ void ZB_fillTriangleMapping(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoint *p1, ZBu
 #include "graphics/tinygl/ztriangle.h"
 }
 
-void ZB_fillTriangleMappingPerspective(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
-	Graphics::PixelBuffer texture;
+// Texel fetching for the perspective correct mapping. fetch() returns the
+// color of the texture at the fixed point coordinates s and t, or false
+// when it is not opaque enough to be drawn.
+
+class TextureSampler {
+public:
+	TextureSampler(const Graphics::PixelBuffer &texture, int level) {
+		const Graphics::PixelFormat &format = texture.getFormat();
+
+		_texels = (const uint32 *)texture.getRawBuffer();
+		_shift = ZB_TEXTURE_SIZE_SHIFT - level;
+		_mask = (1 << _shift) - 1;
+		// s and t have 14 fractional bits for the texels of level 0
+		_fracBits = 14 + level;
+		_aShift = format.aShift;
+		_rShift = format.rShift;
+		_gShift = format.gShift;
+		_bShift = format.bShift;
+	}
+
+protected:
+	const uint32 *_texels;
+	int _shift, _mask, _fracBits;
+	int _aShift, _rShift, _gShift, _bShift;
+};
+
+class NearestSampler : public TextureSampler {
+public:
+	NearestSampler(const Graphics::PixelBuffer &texture, int level) : TextureSampler(texture, level) { }
+
+	inline bool fetch(unsigned int s, unsigned int t, uint8 &r, uint8 &g, uint8 &b) const {
+		int u = (s >> _fracBits) & _mask;
+		int v = (t >> _fracBits) & _mask;
+		uint32 texel = _texels[(v << _shift) | u];
+
+		if (((texel >> _aShift) & 0xFF) != 0xFF)
+			return false;
+		r = (texel >> _rShift) & 0xFF;
+		g = (texel >> _gShift) & 0xFF;
+		b = (texel >> _bShift) & 0xFF;
+		return true;
+	}
+};
+
+class BilinearSampler : public TextureSampler {
+public:
+	BilinearSampler(const Graphics::PixelBuffer &texture, int level) : TextureSampler(texture, level) { }
+
+	inline bool fetch(unsigned int s, unsigned int t, uint8 &r, uint8 &g, uint8 &b) const {
+		// filter around the texel centers
+		s -= 1 << (_fracBits - 1);
+		t -= 1 << (_fracBits - 1);
+
+		int u0 = (s >> _fracBits) & _mask;
+		int v0 = (t >> _fracBits) & _mask;
+		int u1 = (u0 + 1) & _mask;
+		int v1 = (v0 + 1) & _mask;
+		unsigned int fu = (s >> (_fracBits - 8)) & 0xFF;
+		unsigned int fv = (t >> (_fracBits - 8)) & 0xFF;
+
+		uint32 t00 = _texels[(v0 << _shift) | u0];
+		uint32 t10 = _texels[(v0 << _shift) | u1];
+		uint32 t01 = _texels[(v1 << _shift) | u0];
+		uint32 t11 = _texels[(v1 << _shift) | u1];
+
+		// like an alpha test at 0.5, since blending is not done here
+		if (blend(t00, t10, t01, t11, _aShift, fu, fv) < 0x80)
+			return false;
+		r = blend(t00, t10, t01, t11, _rShift, fu, fv);
+		g = blend(t00, t10, t01, t11, _gShift, fu, fv);
+		b = blend(t00, t10, t01, t11, _bShift, fu, fv);
+		return true;
+	}
+
+private:
+	static inline unsigned int blend(uint32 t00, uint32 t10, uint32 t01, uint32 t11, int shift,
+									 unsigned int fu, unsigned int fv) {
+		unsigned int top = ((t00 >> shift) & 0xFF) * (256 - fu) + ((t10 >> shift) & 0xFF) * fu;
+		unsigned int bottom = ((t01 >> shift) & 0xFF) * (256 - fu) + ((t11 >> shift) & 0xFF) * fu;
+		return (top * (256 - fv) + bottom * fv) >> 16;
+	}
+};
+
+template <class Sampler>
+static void fillTriangleMappingPerspective(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2,
+										   const Sampler &texture) {
 	float fdzdx, fndzdx, ndszdx, ndtzdx;
 	int _drgbdx;
 
@@ -242,7 +328,6 @@ void ZB_fillTriangleMappingPerspective(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoi
 	byte *pp1 = zb->pbuf.getRawBuffer() + zb->linesize * p0->y;
 	pz1 = zb->zbuf + p0->y * zb->xsize;
 
-	texture = zb->current_texture;
 	fdzdx = (float)dzdx;
 	fndzdx = NB_INTERP * fdzdx;
 	ndszdx = NB_INTERP * dszdx;
@@ -375,13 +460,8 @@ void ZB_fillTriangleMappingPerspective(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoi
 					}
 					for (int _a = 0; _a < 8; _a++) {
 						if (ZCMP(z, pz[_a])) {
-							unsigned ttt = (t & 0x003FC000) >> (9 - PSZSH);
-							unsigned sss = (s & 0x003FC000) >> (17 - PSZSH);
-							int pixel = ((ttt | sss) >> 1) ;
-
-							uint8 alpha, c_r, c_g, c_b;
-							texture.getARGBAt(pixel, alpha, c_r, c_g, c_b);
-							if (alpha == 0xFF) {
+							uint8 c_r, c_g, c_b;
+							if (texture.fetch(s, t, c_r, c_g, c_b)) {
 								tmp = rgb & 0xF81F07E0;
 								unsigned int light = tmp | (tmp >> 16);
 								unsigned int l_r = (light & 0xF800) >> 8;
@@ -420,13 +500,8 @@ void ZB_fillTriangleMappingPerspective(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoi
 				while (n >= 0) {
 					{
 						if (ZCMP(z, pz[0])) {
-							unsigned ttt = (t & 0x003FC000) >> (9 - PSZSH);
-							unsigned sss = (s & 0x003FC000) >> (17 - PSZSH);
-							int pixel = ((ttt | sss) >> 1) ;
-
-							uint8 alpha, c_r, c_g, c_b;
-							texture.getARGBAt(pixel, alpha, c_r, c_g, c_b);
-							if (alpha == 0xFF) {
+							uint8 c_r, c_g, c_b;
+							if (texture.fetch(s, t, c_r, c_g, c_b)) {
 								tmp = rgb & 0xF81F07E0;
 								unsigned int light = tmp | (tmp >> 16);
 								unsigned int l_r = (light & 0xF800) >> 8;
@@ -487,4 +562,14 @@ void ZB_fillTriangleMappingPerspective(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoi
 	}
 }
 
+void ZB_fillTriangleMappingPerspective(ZBuffer *zb, ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
+	const Graphics::PixelBuffer &texture = zb->current_texture;
+	int level = zb->current_texture_level;
+
+	if (zb->current_texture_bilinear)
+		fillTriangleMappingPerspective(zb, p0, p1, p2, BilinearSampler(texture, level));
+	else
+		fillTriangleMappingPerspective(zb, p0, p1, p2, NearestSampler(texture, level));
+}
+
 } // end of namespace TinyGL
@@ -24,6 +24,8 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/debug-channels.h"
+#include "common/file.h"
+#include "common/profiler.h"
 #include "common/system.h"
 
 #include "engines/engine.h"
@@ -64,6 +66,8 @@ Debugger::Debugger() {
 	DCmd_Register("debugflag_list",		WRAP_METHOD(Debugger, Cmd_DebugFlagsList));
 	DCmd_Register("debugflag_enable",	WRAP_METHOD(Debugger, Cmd_DebugFlagEnable));
 	DCmd_Register("debugflag_disable",	WRAP_METHOD(Debugger, Cmd_DebugFlagDisable));
+
+	DCmd_Register("profile",			WRAP_METHOD(Debugger, Cmd_Profile));
 }
 
 Debugger::~Debugger() {
@@ -537,6 +541,42 @@ bool Debugger::Cmd_DebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::Cmd_Profile(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "on")) {
+		ProfileMan.setEnabled(true);
+		DebugPrintf("Profiler enabled\n");
+	} else if (argc == 2 && !strcmp(argv[1], "off")) {
+		ProfileMan.setEnabled(false);
+		DebugPrintf("Profiler disabled\n");
+	} else if (argc == 2 && !strcmp(argv[1], "reset")) {
+		ProfileMan.reset();
+		DebugPrintf("Profiler statistics cleared\n");
+	} else if (argc == 3 && !strcmp(argv[1], "export")) {
+		Common::DumpFile file;
+		if (!file.open(argv[2])) {
+			DebugPrintf("Could not open '%s'\n", argv[2]);
+			return true;
+		}
+		ProfileMan.writeChromeTrace(file);
+		DebugPrintf("Trace written to '%s'\n", argv[2]);
+	} else if (argc == 1) {
+		const Common::Array<Common::ProfileZoneStats> zones = ProfileMan.getZoneStats();
+
+		DebugPrintf("Profiler is %s, times in microseconds:\n", ProfileMan.isEnabled() ? "enabled" : "disabled");
+		DebugPrintf("%-24s %8s %8s %8s %8s\n", "Zone", "Count", "Min", "Avg", "Max");
+		for (uint i = 0; i < zones.size(); i++) {
+			const Common::ProfileZoneStats &zone = zones[i];
+			if (zone.count == 0)
+				continue;
+			DebugPrintf("%-24s %8u %8u %8u %8u\n", zone.name.c_str(), zone.count, zone.min,
+			            zone.getAverage(), zone.max);
+		}
+	} else {
+		DebugPrintf("Usage: profile [on|off|reset|export <file>]\n");
+	}
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
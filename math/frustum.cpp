@@ -0,0 +1,70 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "math/frustum.h"
+
+namespace Math {
+
+Frustum::Frustum() {
+	for (int i = 0; i < kNumPlanes; i++)
+		_distances[i] = 0.f;
+}
+
+void Frustum::setup(const float *projection, const float *modelView) {
+	float m[16];
+	for (int col = 0; col < 4; col++) {
+		for (int row = 0; row < 4; row++) {
+			m[col * 4 + row] = projection[row] * modelView[col * 4] +
+			                   projection[4 + row] * modelView[col * 4 + 1] +
+			                   projection[8 + row] * modelView[col * 4 + 2] +
+			                   projection[12 + row] * modelView[col * 4 + 3];
+		}
+	}
+
+	// A point is inside when -w <= x, y, z <= w in clip space, so each
+	// plane is the last row of the matrix plus or minus one of the others.
+	for (int i = 0; i < kNumPlanes; i++) {
+		int row = i / 2;
+		float sign = (i % 2 == 0) ? 1.f : -1.f;
+		Vector3d normal(m[3] + sign * m[row], m[7] + sign * m[4 + row], m[11] + sign * m[8 + row]);
+		float distance = m[15] + sign * m[12 + row];
+
+		float length = normal.getMagnitude();
+		if (length > 0.f) {
+			normal /= length;
+			distance /= length;
+		}
+		_normals[i] = normal;
+		_distances[i] = distance;
+	}
+}
+
+bool Frustum::isSphereInside(const Vector3d &center, float radius) const {
+	for (int i = 0; i < kNumPlanes; i++) {
+		if (Vector3d::dotProduct(_normals[i], center) + _distances[i] < -radius)
+			return false;
+	}
+	return true;
+}
+
+} // end of namespace Math
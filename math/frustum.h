@@ -0,0 +1,63 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef MATH_FRUSTUM_H
+#define MATH_FRUSTUM_H
+
+#include "math/vector3d.h"
+
+namespace Math {
+
+/**
+ * The six clipping planes of a view volume, used to reject geometry
+ * that cannot be seen before it is sent to the renderer.
+ */
+class Frustum {
+public:
+	Frustum();
+
+	/**
+	 * Extract the planes from OpenGL style column-major projection and
+	 * modelview matrices. The planes are then in the coordinates the
+	 * modelview matrix transforms from.
+	 */
+	void setup(const float *projection, const float *modelView);
+
+	/**
+	 * Returns false if the sphere is entirely outside of the frustum.
+	 * Spheres near a corner may pass while being outside.
+	 */
+	bool isSphereInside(const Vector3d &center, float radius) const;
+
+private:
+	enum {
+		kNumPlanes = 6
+	};
+
+	Vector3d _normals[kNumPlanes];
+	float _distances[kNumPlanes];
+};
+
+} // end of namespace Math
+
+#endif
@@ -457,7 +457,7 @@ bool operator==(const Matrix<r, c> &m1, const Matrix<r, c> &m2) {
 			}
 		}
 	}
-	return false;
+	return true;
 }
 
 
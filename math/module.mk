@@ -2,6 +2,7 @@ MODULE := math
 
 MODULE_OBJS := \
 	angle.o \
+	frustum.o \
 	matrix3.o \
 	matrix4.o \
 	line3d.o \
@@ -0,0 +1,47 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/memstream.h"
+
+#include "test/audio/helper.h"
+#include "test/benchmark/timer.h"
+
+class AudioBenchmarkSuite : public CxxTest::TestSuite {
+	// Convert a sine of the given rate in mixer sized chunks, as the mixer
+	// does for every channel
+	void benchmarkRate(const char *name, int inRate, int outRate, bool stereo) {
+		const int seconds = 8;
+		const int chunkSize = 2048;
+
+		Audio::SeekableAudioStream *input = createSineStream<int16>(inRate, seconds, 0, true, stereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo);
+		int16 output[chunkSize * 2];
+
+		int frames = 0;
+		BenchmarkTimer timer;
+		for (;;) {
+			memset(output, 0, sizeof(output));
+			int converted = converter->flow(*input, output, chunkSize, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			frames += converted;
+			if (converted < chunkSize)
+				break;
+		}
+		TS_TRACE(BenchmarkTimer::report(name, timer.elapsedMillis(), frames).c_str());
+
+		// The whole input was converted
+		TS_ASSERT_LESS_THAN_EQUALS(seconds * outRate - 2, frames);
+
+		delete converter;
+		delete input;
+	}
+
+public:
+	void test_linear_rate_converter() {
+		benchmarkRate("LinearRateConverter mono 22050 to 44100", 22050, 44100, false);
+		benchmarkRate("LinearRateConverter stereo 22050 to 44100", 22050, 44100, true);
+		benchmarkRate("LinearRateConverter stereo 44100 to 48000", 44100, 48000, true);
+	}
+};
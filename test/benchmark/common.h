@@ -0,0 +1,181 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/bitstream.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/huffman.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "test/benchmark/timer.h"
+#include "test/random.h"
+
+class CommonBenchmarkSuite : public CxxTest::TestSuite {
+	template<class MAP>
+	static void benchmarkIntLookups(const char *hitName, const char *missName) {
+		// Scattered ids, as handed out to pool objects over a game
+		const int count = 1 << 16;
+		const int rounds = 16;
+
+		MAP map;
+		for (int i = 0; i < count; i++)
+			map[i * 37] = i;
+
+		uint32 sum = 0;
+		BenchmarkTimer timer;
+		for (int r = 0; r < rounds; r++)
+			for (int i = 0; i < count; i++)
+				sum += map.getVal(i * 37, 0);
+		TS_TRACE(BenchmarkTimer::report(hitName, timer.elapsedMillis(), count * rounds).c_str());
+
+		timer.restart();
+		for (int r = 0; r < rounds; r++)
+			for (int i = 0; i < count; i++)
+				sum += map.getVal(i * 37 + 1, 0);
+		TS_TRACE(BenchmarkTimer::report(missName, timer.elapsedMillis(), count * rounds).c_str());
+
+		TS_ASSERT_EQUALS(sum, (uint32)count * (count - 1) / 2 * rounds);
+	}
+
+	template<class MAP>
+	static void benchmarkStringLookups(const char *hitName, const char *missName) {
+		// File names, as looked up in the archives
+		const int count = 4096;
+		const int rounds = 32;
+
+		Common::Array<Common::String> names, missing;
+		MAP map;
+		for (int i = 0; i < count; i++) {
+			names.push_back(Common::String::format("data%04d.bm", i));
+			missing.push_back(Common::String::format("data%04d.zbm", i));
+			map[names.back()] = i;
+		}
+
+		int sum = 0;
+		BenchmarkTimer timer;
+		for (int r = 0; r < rounds; r++)
+			for (int i = 0; i < count; i++)
+				sum += map.getVal(names[i], 0);
+		TS_TRACE(BenchmarkTimer::report(hitName, timer.elapsedMillis(), count * rounds).c_str());
+
+		timer.restart();
+		for (int r = 0; r < rounds; r++)
+			for (int i = 0; i < count; i++)
+				sum += map.getVal(missing[i], 0);
+		TS_TRACE(BenchmarkTimer::report(missName, timer.elapsedMillis(), count * rounds).c_str());
+
+		TS_ASSERT_EQUALS(sum, count * (count - 1) / 2 * rounds);
+	}
+
+	static Common::Array<byte> randomBytes(uint32 size) {
+		Common::Array<byte> contents;
+		contents.resize(size);
+		TestRandom rnd;
+		for (uint32 i = 0; i < size; i++)
+			contents[i] = rnd.nextByte();
+		return contents;
+	}
+
+public:
+	void test_hashmap_int_lookup() {
+		benchmarkIntLookups<Common::HashMap<int, int> >("HashMap<int> hit", "HashMap<int> miss");
+	}
+
+	void test_hashmap_string_lookup() {
+		typedef Common::HashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> StringMap;
+		benchmarkStringLookups<StringMap>("HashMap<String> hit", "HashMap<String> miss");
+	}
+
+	void test_bitstream_reads() {
+		const uint32 size = 1 << 20;
+		Common::Array<byte> contents = randomBytes(size);
+
+		// Bink style reads: single flags and small fields
+		const uint32 reads = (size * 8) / 6;
+
+		Common::MemoryReadStream ms(contents.begin(), size);
+		Common::BitStream32LELSB streamBits(ms);
+		Common::BitStream &bs = streamBits;
+
+		uint32 sum = 0;
+		BenchmarkTimer timer;
+		for (uint32 i = 0; i < reads; i += 2)
+			sum += bs.getBit() + bs.getBits(4);
+		TS_TRACE(BenchmarkTimer::report("BitStream32LELSB", timer.elapsedMillis(), reads).c_str());
+
+		Common::BitStreamMemory32LELSB mbs(contents.begin(), size);
+
+		uint32 memorySum = 0;
+		timer.restart();
+		for (uint32 i = 0; i < reads; i += 2)
+			memorySum += mbs.getBit() + mbs.getBits(4);
+		TS_TRACE(BenchmarkTimer::report("BitStreamMemory32LELSB", timer.elapsedMillis(), reads).c_str());
+
+		TS_ASSERT_EQUALS(sum, memorySum);
+	}
+
+	void test_huffman_decoding() {
+		const uint8 lengths[] = { 2, 3, 3, 4, 4, 4, 5, 5, 5, 6, 6, 7, 8, 9, 10, 10 };
+		const uint32 codeCount = ARRAYSIZE(lengths);
+		const uint32 count = 200000;
+
+		// Canonical codes, with their bits reversed for an LSB first stream
+		uint32 codes[codeCount];
+		uint32 code = 0;
+		for (uint32 i = 0; i < codeCount; i++) {
+			if (i > 0)
+				code = (code + 1) << (lengths[i] - lengths[i - 1]);
+			codes[i] = 0;
+			for (uint32 j = 0; j < lengths[i]; j++)
+				if (code & (1 << (lengths[i] - 1 - j)))
+					codes[i] |= 1 << j;
+		}
+
+		// Random symbols favouring the short codes, as a real stream would
+		Common::Array<byte> data;
+		TestRandom rnd;
+		uint32 bit = 0;
+		for (uint32 i = 0; i < count; i++) {
+			uint32 value = rnd.next();
+			uint32 s = (value >> 16) % codeCount;
+			if (value & 0x100)
+				s /= 4;
+
+			for (uint32 j = 0; j < lengths[s]; j++, bit++) {
+				// Keep the size a multiple of 32 bits
+				if ((bit >> 3) >= data.size())
+					data.resize(data.size() + 4);
+				if ((codes[s] >> j) & 1)
+					data[bit >> 3] |= 1 << (bit & 7);
+			}
+		}
+
+		Common::Huffman huffman(0, codeCount, codes, lengths);
+		Common::MemoryReadStream ms(data.begin(), data.size());
+		Common::BitStream32LELSB bs(ms);
+
+		uint32 sum = 0;
+		BenchmarkTimer timer;
+		for (uint32 i = 0; i < count; i++)
+			sum += huffman.getSymbol(static_cast<Common::BitStream &>(bs));
+		TS_TRACE(BenchmarkTimer::report("Huffman list search", timer.elapsedMillis(), count).c_str());
+
+		bs.rewind();
+		uint32 tableSum = 0;
+		timer.restart();
+		for (uint32 i = 0; i < count; i++)
+			tableSum += huffman.getSymbol(bs);
+		TS_TRACE(BenchmarkTimer::report("Huffman table lookup", timer.elapsedMillis(), count).c_str());
+
+		Common::BitStreamMemory32LELSB mbs(data.begin(), data.size());
+		uint32 memorySum = 0;
+		timer.restart();
+		for (uint32 i = 0; i < count; i++)
+			memorySum += huffman.getSymbol(mbs);
+		TS_TRACE(BenchmarkTimer::report("Huffman table lookup from memory", timer.elapsedMillis(), count).c_str());
+
+		TS_ASSERT_EQUALS(sum, tableSum);
+		TS_ASSERT_EQUALS(sum, memorySum);
+	}
+};
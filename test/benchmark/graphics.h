@@ -0,0 +1,420 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/memstream.h"
+
+#include "graphics/pixelbuffer.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/decoders/jpeg.h"
+#include "graphics/tinygl/zbuffer.h"
+#include "graphics/tinygl/zgl.h"
+
+#include "test/benchmark/timer.h"
+#include "test/random.h"
+
+class GraphicsBenchmarkSuite : public CxxTest::TestSuite {
+	TestRandom _random;
+
+	// Triangles of about the size of the faces of a character close to the
+	// camera, with random colors, depths and texture coordinates
+	void createTriangles(Common::Array<TinyGL::ZBufferPoint> &points, int screenWidth, int screenHeight, int count) {
+		for (int i = 0; i < count; i++) {
+			int x = _random.nextNumber(screenWidth - 64);
+			int y = _random.nextNumber(screenHeight - 64);
+
+			for (int j = 0; j < 3; j++) {
+				TinyGL::ZBufferPoint p;
+				p.x = x + _random.nextNumber(64);
+				p.y = y + _random.nextNumber(64);
+				p.z = _random.nextNumber(1 << 16) << ZB_POINT_Z_FRAC_BITS;
+				p.s = ZB_POINT_S_MIN + _random.nextNumber(1 << 12) * ((ZB_POINT_S_MAX - ZB_POINT_S_MIN) >> 12);
+				p.t = ZB_POINT_S_MIN + _random.nextNumber(1 << 12) * ((ZB_POINT_S_MAX - ZB_POINT_S_MIN) >> 12);
+				p.r = ZB_POINT_RED_MIN + _random.nextNumber(ZB_POINT_RED_MAX - ZB_POINT_RED_MIN);
+				p.g = ZB_POINT_GREEN_MIN + _random.nextNumber(ZB_POINT_GREEN_MAX - ZB_POINT_GREEN_MIN);
+				p.b = ZB_POINT_BLUE_MIN + _random.nextNumber(ZB_POINT_BLUE_MAX - ZB_POINT_BLUE_MIN);
+				p.sz = p.tz = 0.0f;
+				points.push_back(p);
+			}
+		}
+	}
+
+	static int getArea(const TinyGL::ZBufferPoint *p) {
+		return ABS((p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y)) / 2;
+	}
+
+	// Covers the screen with squares of quadSize pixels, each showing a
+	// whole texture turned by 90 degrees.
+	static void drawQuads(const Common::Array<unsigned int> &textures, int screenSize, int quadSize) {
+		int n = screenSize / quadSize;
+		float step = 2.0f / n;
+
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		for (int y = 0; y < n; y++) {
+			for (int x = 0; x < n; x++) {
+				float x0 = -1.0f + x * step, y0 = -1.0f + y * step;
+
+				tglBindTexture(TGL_TEXTURE_2D, textures[(y * n + x) % textures.size()]);
+				tglBegin(TGL_QUADS);
+				tglTexCoord2f(0.0f, 1.0f);
+				tglVertex3f(x0, y0, 0.0f);
+				tglTexCoord2f(0.0f, 0.0f);
+				tglVertex3f(x0 + step, y0, 0.0f);
+				tglTexCoord2f(1.0f, 0.0f);
+				tglVertex3f(x0 + step, y0 + step, 0.0f);
+				tglTexCoord2f(1.0f, 1.0f);
+				tglVertex3f(x0, y0 + step, 0.0f);
+				tglEnd();
+			}
+		}
+	}
+
+	// JPEG stream writing, MSB first with the 0xFF bytes stuffed
+	Common::Array<byte> _jpeg;
+	uint32 _bitBuffer;
+	int _bitCount;
+
+	void putBits(uint32 value, int count) {
+		for (int i = count - 1; i >= 0; i--) {
+			_bitBuffer = (_bitBuffer << 1) | ((value >> i) & 1);
+			if (++_bitCount == 8) {
+				_jpeg.push_back(_bitBuffer);
+				if (_bitBuffer == 0xFF)
+					_jpeg.push_back(0);
+				_bitBuffer = 0;
+				_bitCount = 0;
+			}
+		}
+	}
+
+	void putMarker(byte marker, int length) {
+		_jpeg.push_back(0xFF);
+		_jpeg.push_back(marker);
+		if (length > 0) {
+			_jpeg.push_back(length >> 8);
+			_jpeg.push_back(length & 0xFF);
+		}
+	}
+
+	struct JPEGHuffman {
+		uint16 codes[256];
+		uint8 sizes[256];
+	};
+
+	// Write the table, and assign the codes the way the decoder does
+	void putHuffmanTable(JPEGHuffman &huffman, byte id, const byte *counts, const byte *symbols) {
+		int count = 0;
+		for (int i = 0; i < 16; i++)
+			count += counts[i];
+
+		putMarker(0xC4, 2 + 1 + 16 + count);
+		_jpeg.push_back(id);
+		for (int i = 0; i < 16; i++)
+			_jpeg.push_back(counts[i]);
+
+		uint16 code = 0;
+		int cur = 0;
+		for (int i = 0; i < 16; i++) {
+			for (int j = 0; j < counts[i]; j++, cur++) {
+				_jpeg.push_back(symbols[cur]);
+				huffman.codes[symbols[cur]] = code++;
+				huffman.sizes[symbols[cur]] = i + 1;
+			}
+			code <<= 1;
+		}
+	}
+
+	void putSymbol(const JPEGHuffman &huffman, byte symbol) {
+		putBits(huffman.codes[symbol], huffman.sizes[symbol]);
+	}
+
+	// A data unit of random coefficients, mostly low frequency ones
+	void putDataUnit(const JPEGHuffman &dc, const JPEGHuffman &ac) {
+		int size = 1 + _random.nextNumber(5);
+		putSymbol(dc, size);
+		putBits(_random.nextNumber(1 << size), size);
+
+		int cur = 1;
+		int coefficients = _random.nextNumber(12);
+		while (coefficients-- > 0) {
+			int run = _random.nextNumber(4);
+			if (cur + run > 63)
+				break;
+
+			size = 1 + _random.nextNumber(4);
+			putSymbol(ac, (run << 4) | size);
+			putBits(_random.nextNumber(1 << size), size);
+			cur += run + 1;
+		}
+
+		if (cur < 64)
+			putSymbol(ac, 0x00);
+	}
+
+	/**
+	 * Builds a baseline JPEG of random coefficients with 4:2:0 chroma. The
+	 * Huffman tables use the code lengths of the usual tables.
+	 */
+	void buildJPEG(int width, int height) {
+		static const byte dcCounts[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+		static const byte acCounts[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+
+		byte dcSymbols[12];
+		for (int i = 0; i < 12; i++)
+			dcSymbols[i] = i;
+
+		// The end of block first, and the shortest runs of the smallest
+		// values next
+		byte acSymbols[162];
+		int count = 0;
+		acSymbols[count++] = 0x00;
+		for (int size = 1; size <= 10; size++)
+			for (int run = 0; run < 16; run++)
+				acSymbols[count++] = (run << 4) | size;
+		acSymbols[count++] = 0xF0;
+
+		_jpeg.clear();
+		_bitBuffer = 0;
+		_bitCount = 0;
+
+		putMarker(0xD8, 0);
+
+		putMarker(0xDB, 2 + 1 + 64);
+		_jpeg.push_back(0);
+		for (int i = 0; i < 64; i++)
+			_jpeg.push_back(2 + i / 2);
+
+		putMarker(0xC0, 8 + 3 * 3);
+		_jpeg.push_back(8);
+		_jpeg.push_back(height >> 8);
+		_jpeg.push_back(height & 0xFF);
+		_jpeg.push_back(width >> 8);
+		_jpeg.push_back(width & 0xFF);
+		_jpeg.push_back(3);
+		for (int c = 1; c <= 3; c++) {
+			_jpeg.push_back(c);
+			_jpeg.push_back(c == 1 ? 0x22 : 0x11);
+			_jpeg.push_back(0);
+		}
+
+		JPEGHuffman dc, ac;
+		putHuffmanTable(dc, 0x00, dcCounts, dcSymbols);
+		putHuffmanTable(ac, 0x10, acCounts, acSymbols);
+
+		putMarker(0xDA, 6 + 2 * 3);
+		_jpeg.push_back(3);
+		for (int c = 1; c <= 3; c++) {
+			_jpeg.push_back(c);
+			_jpeg.push_back(0x00);
+		}
+		_jpeg.push_back(0);
+		_jpeg.push_back(63);
+		_jpeg.push_back(0);
+
+		int mcus = ((width + 15) / 16) * ((height + 15) / 16);
+		for (int i = 0; i < mcus; i++) {
+			// Four luminance data units, and one for each chroma plane
+			for (int j = 0; j < 6; j++)
+				putDataUnit(dc, ac);
+		}
+		if (_bitCount > 0)
+			putBits(0xFF, 8 - _bitCount);
+
+		putMarker(0xD9, 0);
+	}
+
+	void benchmarkYUV(const char *name, const Graphics::PixelFormat &format, int shift, bool is410) {
+		const int width = 640, height = 480, rounds = 20;
+
+		Common::Array<byte> y, u, v;
+		int uvWidth = width >> shift, uvHeight = height >> shift;
+		// The 4:1:0 conversion reads the next chroma line
+		y.resize(width * height);
+		u.resize(uvWidth * (uvHeight + 1));
+		v.resize(uvWidth * (uvHeight + 1));
+		for (uint i = 0; i < y.size(); i++)
+			y[i] = _random.nextNumber(256);
+		for (uint i = 0; i < u.size(); i++) {
+			u[i] = _random.nextNumber(256);
+			v[i] = _random.nextNumber(256);
+		}
+
+		Graphics::Surface surface;
+		surface.create(width, height, format);
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < rounds; i++) {
+			if (shift == 0)
+				YUVToRGBMan.convert444(&surface, Graphics::YUVToRGBManager::kScaleFull, &y[0], &u[0], &v[0], width, height, width, uvWidth);
+			else if (!is410)
+				YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, &y[0], &u[0], &v[0], width, height, width, uvWidth);
+			else
+				YUVToRGBMan.convert410(&surface, Graphics::YUVToRGBManager::kScaleITU, &y[0], &u[0], &v[0], width, height, width, uvWidth);
+		}
+		TS_TRACE(BenchmarkTimer::report(name, timer.elapsedMillis(), rounds * width * height).c_str());
+
+		surface.free();
+	}
+
+public:
+	void test_tinygl_fillers() {
+		const int width = 640, height = 480, triangles = 2048, rounds = 8;
+		static const struct {
+			const char *name;
+			TinyGL::ZB_fillTriangleFunc fill;
+			bool bilinear;
+		} fillers[] = {
+			{ "TinyGL fill depth only", TinyGL::ZB_fillTriangleDepthOnly, false },
+			{ "TinyGL fill flat", TinyGL::ZB_fillTriangleFlat, false },
+			{ "TinyGL fill flat shadow mask", TinyGL::ZB_fillTriangleFlatShadowMask, false },
+			{ "TinyGL fill flat shadow", TinyGL::ZB_fillTriangleFlatShadow, false },
+			{ "TinyGL fill smooth", TinyGL::ZB_fillTriangleSmooth, false },
+			{ "TinyGL fill mapping", TinyGL::ZB_fillTriangleMapping, false },
+			{ "TinyGL fill perspective, nearest", TinyGL::ZB_fillTriangleMappingPerspective, false },
+			{ "TinyGL fill perspective, bilinear", TinyGL::ZB_fillTriangleMappingPerspective, true }
+		};
+
+		Graphics::PixelBuffer buffer(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), width * height, DisposeAfterUse::YES);
+		TinyGL::ZBuffer *zb = TinyGL::ZB_open(width, height, buffer);
+
+		// Every other line of the shadow mask is set
+		Common::Array<byte> shadowMask;
+		shadowMask.resize(width * height);
+		for (int i = 0; i < width * height; i++)
+			shadowMask[i] = (i / width) & 1;
+		zb->shadow_mask_buf = &shadowMask[0];
+		zb->shadow_color_r = 0x40;
+		zb->shadow_color_g = 0x40;
+		zb->shadow_color_b = 0x40;
+
+		Graphics::PixelBuffer texture(Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24), 256 * 256, DisposeAfterUse::YES);
+		_random.setSeed(1);
+		for (int i = 0; i < 256 * 256; i++)
+			texture.setPixelAt(i, 0xFF, _random.nextNumber(256), _random.nextNumber(256), _random.nextNumber(256));
+
+		Common::Array<TinyGL::ZBufferPoint> points;
+		createTriangles(points, width, height, triangles);
+		int pixels = 0;
+		for (int i = 0; i < triangles; i++)
+			pixels += getArea(&points[i * 3]);
+
+		for (uint i = 0; i < ARRAYSIZE(fillers); i++) {
+			TinyGL::ZB_setTexture(zb, texture, 0, fillers[i].bilinear);
+
+			// The texture coordinates of the affine mapping use their own range
+			Common::Array<TinyGL::ZBufferPoint> drawn = points;
+			if (fillers[i].fill == TinyGL::ZB_fillTriangleMapping) {
+				for (uint j = 0; j < drawn.size(); j++)
+					drawn[j].t = ZB_POINT_T_MIN + ((drawn[j].t - ZB_POINT_S_MIN) >> 14 << 22);
+			}
+
+			double millis = 0.0;
+			for (int j = 0; j < rounds; j++) {
+				TinyGL::ZB_clear(zb, 1, 0, 1, 0, 0, 0);
+
+				BenchmarkTimer timer;
+				for (int k = 0; k < triangles; k++)
+					fillers[i].fill(zb, &drawn[k * 3], &drawn[k * 3 + 1], &drawn[k * 3 + 2]);
+				millis += timer.elapsedMillis();
+			}
+			TS_TRACE(BenchmarkTimer::report(fillers[i].name, millis, rounds * pixels).c_str());
+		}
+
+		zb->shadow_mask_buf = NULL;
+		TinyGL::ZB_close(zb);
+	}
+
+	void test_tinygl_minified_textures() {
+		const int screenSize = 256, textureSize = 256, frames = 4;
+		// Small quads are dominated by the triangle setup, large ones by the
+		// texel reads
+		static const int quadSizes[] = { 8, 64 };
+		static const struct {
+			const char *name;
+			int minFilter;
+		} modes[] = {
+			{ "nearest", TGL_NEAREST },
+			{ "nearest mipmaps", TGL_NEAREST_MIPMAP_NEAREST },
+			{ "bilinear", TGL_LINEAR },
+			{ "bilinear mipmaps", TGL_LINEAR_MIPMAP_NEAREST }
+		};
+
+		Graphics::PixelBuffer buffer(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), screenSize * screenSize, DisposeAfterUse::YES);
+		TinyGL::ZBuffer *zb = TinyGL::ZB_open(screenSize, screenSize, buffer);
+		TinyGL::glInit(zb);
+		tglViewport(0, 0, screenSize, screenSize);
+		tglEnable(TGL_TEXTURE_2D);
+
+		// 8MB of texels, many more than the caches hold
+		Common::Array<unsigned int> textures;
+		Common::Array<byte> texels;
+		texels.resize(textureSize * textureSize * 4);
+		_random.setSeed(7);
+		for (int i = 0; i < 32; i++) {
+			for (uint j = 0; j < texels.size(); j++)
+				texels[j] = (j & 3) == 3 ? 0xFF : _random.nextNumber(256);
+
+			unsigned int texture;
+			tglGenTextures(1, &texture);
+			tglBindTexture(TGL_TEXTURE_2D, texture);
+			tglTexImage2D(TGL_TEXTURE_2D, 0, 3, textureSize, textureSize, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, &texels[0]);
+			textures.push_back(texture);
+		}
+
+		for (uint i = 0; i < ARRAYSIZE(modes); i++) {
+			for (uint j = 0; j < textures.size(); j++) {
+				tglBindTexture(TGL_TEXTURE_2D, textures[j]);
+				tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, modes[i].minFilter);
+				tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+			}
+
+			for (uint k = 0; k < ARRAYSIZE(quadSizes); k++) {
+				Common::String name = Common::String::format("TinyGL minified textures, %d pixel quads, %s", quadSizes[k], modes[i].name);
+
+				// builds the mip chains
+				drawQuads(textures, screenSize, quadSizes[k]);
+
+				BenchmarkTimer timer;
+				for (int j = 0; j < frames; j++)
+					drawQuads(textures, screenSize, quadSizes[k]);
+				TS_TRACE(BenchmarkTimer::report(name.c_str(), timer.elapsedMillis(), frames * screenSize * screenSize).c_str());
+			}
+		}
+
+		TinyGL::glClose();
+		TinyGL::ZB_close(zb);
+	}
+
+	void test_yuv_to_rgb() {
+		const Graphics::PixelFormat format16(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat format32(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+		_random.setSeed(2);
+		benchmarkYUV("YUV444 to RGB565", format16, 0, false);
+		benchmarkYUV("YUV444 to RGBA8888", format32, 0, false);
+		benchmarkYUV("YUV420 to RGB565", format16, 1, false);
+		benchmarkYUV("YUV420 to RGBA8888", format32, 1, false);
+		benchmarkYUV("YUV410 to RGB565", format16, 2, true);
+		benchmarkYUV("YUV410 to RGBA8888", format32, 2, true);
+	}
+
+	void test_jpeg_load_stream() {
+		const int width = 640, height = 480, rounds = 8;
+
+		_random.setSeed(3);
+		buildJPEG(width, height);
+
+		Graphics::JPEGDecoder jpeg;
+		bool loaded = true;
+		BenchmarkTimer timer;
+		for (int i = 0; i < rounds; i++) {
+			Common::MemoryReadStream stream(&_jpeg[0], _jpeg.size());
+			loaded = jpeg.loadStream(stream) && loaded;
+		}
+		TS_TRACE(BenchmarkTimer::report("JPEGDecoder::loadStream 4:2:0", timer.elapsedMillis(), rounds * width * height).c_str());
+
+		TS_ASSERT(loaded);
+		TS_ASSERT_EQUALS(jpeg.getWidth(), width);
+		TS_ASSERT_EQUALS(jpeg.getHeight(), height);
+	}
+};
@@ -0,0 +1,125 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+
+#include "graphics/pixelbuffer.h"
+
+#include "engines/grim/blitimage.h"
+#include "engines/grim/movie/codecs/blocky16.h"
+#include "engines/grim/movie/codecs/vima.h"
+
+#include "test/benchmark/timer.h"
+#include "test/random.h"
+#include "test/engines/grim/helper.h"
+
+class GrimBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kScreenWidth = 640,
+		kScreenHeight = 480
+	};
+
+	TestRandom _random;
+
+	void benchmarkBlit(const char *name, Grim::BlitImage *image, byte *dst, byte *src, int rounds, bool trans) {
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < rounds; i++)
+			Grim::blitImage(format, image, dst, kScreenWidth, kScreenHeight, src, 0, 0, 0, 0,
+			                kScreenWidth, kScreenHeight, kScreenWidth, kScreenHeight, trans);
+		TS_TRACE(BenchmarkTimer::report(name, timer.elapsedMillis(), rounds * kScreenWidth * kScreenHeight).c_str());
+	}
+
+	void benchmarkVima(const char *name, int channels) {
+		const int samples = 22050 * channels, rounds = 40;
+
+		uint16 *destTable = new uint16[5786];
+		Grim::vimaInit(destTable);
+
+		// Headers starting from the first step size, then random codes, with
+		// room for the escaped samples
+		Common::Array<byte> src;
+		src.push_back(channels == 2 ? 0xFF : 0x00);
+		src.push_back(0);
+		src.push_back(0);
+		if (channels == 2) {
+			src.push_back(0);
+			src.push_back(0);
+			src.push_back(0);
+		}
+		for (int i = 0; i < samples * 3 + 16; i++)
+			src.push_back(_random.nextNumber(256));
+
+		int16 *dest = new int16[samples];
+		BenchmarkTimer timer;
+		for (int i = 0; i < rounds; i++)
+			Grim::decompressVima(&src[0], dest, samples * 2, destTable);
+		TS_TRACE(BenchmarkTimer::report(name, timer.elapsedMillis(), rounds * samples).c_str());
+
+		delete[] dest;
+		delete[] destTable;
+	}
+
+public:
+	void test_blit() {
+		Graphics::PixelBuffer screen(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), kScreenWidth * kScreenHeight, DisposeAfterUse::YES);
+		Graphics::PixelBuffer bitmap(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), kScreenWidth * kScreenHeight, DisposeAfterUse::YES);
+
+		// Runs of opaque and transparent pixels, as around the objects
+		// drawn over the backgrounds
+		_random.setSeed(1);
+		int pixel = 0;
+		bool opaque = true;
+		while (pixel < kScreenWidth * kScreenHeight) {
+			int run = MIN<int>(1 + _random.nextNumber(64), kScreenWidth * kScreenHeight - pixel);
+			for (int i = 0; i < run; i++, pixel++)
+				bitmap.setPixelAt(pixel, opaque ? _random.nextNumber(0xf81f) : 0xf81f);
+			opaque = !opaque;
+		}
+
+		Grim::BlitImage image;
+		image.create(bitmap, 0xf81f, 0, 0, kScreenWidth, kScreenHeight);
+
+		benchmarkBlit("GfxTinyGL::blit opaque", NULL, screen.getRawBuffer(), bitmap.getRawBuffer(), 1000, false);
+		benchmarkBlit("GfxTinyGL::blit transparent lines", &image, screen.getRawBuffer(), bitmap.getRawBuffer(), 1000, true);
+		benchmarkBlit("GfxTinyGL::blit transparent pixels", NULL, screen.getRawBuffer(), bitmap.getRawBuffer(), 20, true);
+	}
+
+	void test_blocky16_decode() {
+		const int frames = 16, rounds = 4;
+
+		Common::Array<byte> stream;
+		Common::Array<uint32> offsets;
+		Blocky16StreamBuilder builder(kScreenWidth, kScreenHeight, 2);
+		for (int i = 0; i < frames; i++) {
+			const byte *frame = builder.buildFrame(i);
+			offsets.push_back(stream.size());
+			for (uint32 j = 0; j < builder.getFrameSize(); j++)
+				stream.push_back(frame[j]);
+		}
+
+		byte *dst = new byte[kScreenWidth * kScreenHeight * 2];
+		for (int simd = 0; simd < 2; simd++) {
+			if (simd && !Grim::Blocky16::hasSIMD())
+				break;
+
+			Grim::Blocky16 blocky16;
+			blocky16.init(kScreenWidth, kScreenHeight);
+			blocky16.setSIMD(simd);
+
+			BenchmarkTimer timer;
+			for (int i = 0; i < rounds; i++)
+				for (int j = 0; j < frames; j++)
+					blocky16.decode(dst, &stream[offsets[j]]);
+			TS_TRACE(BenchmarkTimer::report(simd ? "Blocky16 decode, vectorized" : "Blocky16 decode",
+			                                timer.elapsedMillis(), rounds * frames * kScreenWidth * kScreenHeight).c_str());
+		}
+		delete[] dst;
+	}
+
+	void test_vima_decompress() {
+		_random.setSeed(3);
+		benchmarkVima("VIMA decompress mono", 1);
+		benchmarkVima("VIMA decompress stereo", 2);
+	}
+};
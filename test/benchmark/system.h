@@ -0,0 +1,84 @@
+#ifndef TEST_BENCHMARK_SYSTEM_H
+#define TEST_BENCHMARK_SYSTEM_H
+
+#include <stdio.h>
+
+#include "common/system.h"
+
+#include "graphics/pixelbuffer.h"
+
+/*
+ * The least of a backend for the code that needs g_system, such as the
+ * video decoders with their mutex and screen format. It has no screen nor
+ * mixer, and its mutexes do nothing, as the benchmarks run on one thread.
+ * The warnings and errors still go to stderr.
+ */
+class BenchmarkSystem : public OSystem {
+public:
+	BenchmarkSystem() : _previous(g_system) {
+		g_system = this;
+	}
+
+	~BenchmarkSystem() {
+		g_system = _previous;
+	}
+
+	const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	int getDefaultGraphicsMode() const { return 0; }
+	bool setGraphicsMode(int mode) { return true; }
+	int getGraphicsMode() const { return 0; }
+	Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0); }
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const {
+		Common::List<Graphics::PixelFormat> formats;
+		formats.push_back(getScreenFormat());
+		return formats;
+	}
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format) { }
+	void launcherInitSize(uint width, uint height) { }
+	Graphics::PixelBuffer setupScreen(int screenW, int screenH, bool fullscreen, bool accel3d) { return Graphics::PixelBuffer(); }
+	int16 getHeight() { return 0; }
+	int16 getWidth() { return 0; }
+	PaletteManager *getPaletteManager() { return 0; }
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) { }
+	Graphics::Surface *lockScreen() { return 0; }
+	void unlockScreen() { }
+	void fillScreen(uint32 col) { }
+	void updateScreen() { }
+	void setShakePos(int shakeOffset) { }
+
+	void showOverlay() { }
+	void hideOverlay() { }
+	Graphics::PixelFormat getOverlayFormat() const { return getScreenFormat(); }
+	void clearOverlay() { }
+	void grabOverlay(void *buf, int pitch) { }
+	void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) { }
+	int16 getOverlayHeight() { return 0; }
+	int16 getOverlayWidth() { return 0; }
+
+	bool showMouse(bool visible) { return false; }
+	bool lockMouse(bool lock) { return false; }
+	void warpMouse(int x, int y) { }
+	void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) { }
+
+	uint32 getMillis(bool skipRecord = false) { return 0; }
+	void delayMillis(uint msecs) { }
+	void getTimeAndDate(TimeDate &t) const { memset(&t, 0, sizeof(t)); }
+
+	MutexRef createMutex() { return 0; }
+	void lockMutex(MutexRef mutex) { }
+	void unlockMutex(MutexRef mutex) { }
+	void deleteMutex(MutexRef mutex) { }
+
+	Audio::Mixer *getMixer() { return 0; }
+	void quit() { }
+	void displayMessageOnOSD(const char *msg) { }
+	void logMessage(LogMessageType::Type type, const char *message) {
+		if (type != LogMessageType::kInfo && type != LogMessageType::kDebug)
+			fputs(message, stderr);
+	}
+
+private:
+	OSystem *_previous;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TEST_BENCHMARK_TIMER_H
+#define TEST_BENCHMARK_TIMER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common/str.h"
+
+/*
+ * Timing helper for the benchmarks that run along with the tests. It
+ * measures processor time, so that other processes have less influence on
+ * the results. The results are reported with TS_TRACE, since they depend
+ * on the machine and cannot be checked. The benchmark suites also append
+ * them as CSV lines to the file named by BENCHMARK_OUTPUT, if set.
+ */
+class BenchmarkTimer {
+public:
+	BenchmarkTimer() : _start(clock()) { }
+
+	void restart() {
+		_start = clock();
+	}
+
+	double elapsedMillis() const {
+		return (clock() - _start) * 1000.0 / CLOCKS_PER_SEC;
+	}
+
+	static Common::String format(const char *name, double millis, int count) {
+		return Common::String::format("%s: %.3f ms (%.1f ns/op)", name, millis,
+									  count > 0 ? millis * 1000000.0 / count : 0.0);
+	}
+
+	/**
+	 * Format the result like format(), and append it to the output file
+	 * as "name,ops,ms,ns_per_op".
+	 */
+	static Common::String report(const char *name, double millis, int count) {
+		const char *path = getenv("BENCHMARK_OUTPUT");
+		if (path && *path) {
+			FILE *file = fopen(path, "a");
+			if (file) {
+				fprintf(file, "\"%s\",%d,%.3f,%.3f\n", name, count, millis,
+						count > 0 ? millis * 1000000.0 / count : 0.0);
+				fclose(file);
+			}
+		}
+
+		return format(name, millis, count);
+	}
+
+private:
+	clock_t _start;
+};
+
+#endif
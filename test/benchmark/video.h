@@ -0,0 +1,477 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/math.h"
+#include "common/memstream.h"
+
+#include "video/bink_decoder.h"
+#include "video/binkdata.h"
+
+#include "test/benchmark/system.h"
+#include "test/benchmark/timer.h"
+#include "test/random.h"
+
+/*
+ * Encodes a Bink video of random blocks, mirroring what the decoder reads:
+ * the bundles of values are sent at the start of the rows of blocks, the
+ * DCT coefficients and run flags inline with the blocks. The frames mix
+ * fill, pattern, run, raw and intra blocks, plus skipped and motion
+ * compensated ones after the key frame.
+ */
+class VideoBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 640,
+		kHeight = 480,
+		kFrames = 8
+	};
+
+	// The bundles, in the order the decoder reads them
+	enum Source {
+		kSourceBlockTypes = 0,
+		kSourceSubBlockTypes,
+		kSourceColors,
+		kSourcePattern,
+		kSourceXOff,
+		kSourceYOff,
+		kSourceIntraDC,
+		kSourceInterDC,
+		kSourceRun,
+		kSourceMAX
+	};
+
+	enum BlockType {
+		kBlockSkip = 0,
+		kBlockMotion = 2,
+		kBlockRun = 3,
+		kBlockIntra = 5,
+		kBlockFill = 6,
+		kBlockPattern = 8,
+		kBlockRaw = 9
+	};
+
+	// Bits to send later, LSB first
+	struct BitList {
+		Common::Array<uint32> values;
+		Common::Array<byte> counts;
+
+		void put(uint32 value, int count) {
+			values.push_back(value);
+			counts.push_back(count);
+		}
+	};
+
+	TestRandom _random;
+	Common::Array<byte> _data;
+	uint32 _bitPos;
+
+	// Values of each bundle for the current plane, and the row they are used in
+	Common::Array<int> _values[kSourceMAX];
+	Common::Array<int> _valueRows[kSourceMAX];
+	Common::Array<BitList> _inlineBits;
+
+	void putBits(uint32 value, int count) {
+		for (int i = 0; i < count; i++, _bitPos++) {
+			if ((_bitPos >> 3) >= _data.size())
+				_data.push_back(0);
+			if ((value >> i) & 1)
+				_data[_bitPos >> 3] |= 1 << (_bitPos & 7);
+		}
+	}
+
+	// All the bundles use the same Huffman tree, with the symbols in order
+	static int getTree(int source) {
+		static const int trees[kSourceMAX] = { 4, 1, 7, 10, 2, 2, 0, 0, 5 };
+		return trees[source];
+	}
+
+	void putSymbol(int source, int symbol) {
+		int tree = getTree(source);
+		putBits(Video::binkHuffmanCodes[tree][symbol], Video::binkHuffmanLengths[tree][symbol]);
+	}
+
+	void putHuffman(int tree) {
+		putBits(tree, 4);
+		if (tree != 0) {
+			// Symbol selection of symbol 0 only: the others follow in order
+			putBits(1, 1);
+			putBits(0, 3);
+			putBits(0, 4);
+		}
+	}
+
+	void addValue(Source source, int row, int value) {
+		_values[source].push_back(value);
+		_valueRows[source].push_back(row);
+	}
+
+	void addColors(int row, int count) {
+		while (count--)
+			addValue(kSourceColors, row, _random.nextNumber(256));
+	}
+
+	void putCoefficient(BitList &bits, int magnitudeBits) {
+		if (!magnitudeBits) {
+			bits.put(_random.nextNumber(2), 1);
+		} else {
+			bits.put(_random.nextNumber(1 << magnitudeBits), magnitudeBits);
+			bits.put(_random.nextNumber(2), 1);
+		}
+	}
+
+	// Random DCT coefficients, following the lists the decoder walks
+	void putDCTCoeffs(BitList &bits) {
+		int listStart = 64;
+		int listEnd   = 64;
+
+		int coefList[128];      int modeList[128];
+		coefList[listEnd] = 4;  modeList[listEnd++] = 0;
+		coefList[listEnd] = 24; modeList[listEnd++] = 0;
+		coefList[listEnd] = 44; modeList[listEnd++] = 0;
+		coefList[listEnd] = 1;  modeList[listEnd++] = 3;
+		coefList[listEnd] = 2;  modeList[listEnd++] = 3;
+		coefList[listEnd] = 3;  modeList[listEnd++] = 3;
+
+		int magnitudeBits = 1 + _random.nextNumber(4);
+		bits.put(magnitudeBits, 4);
+		for (int b = magnitudeBits - 1; b >= 0; b--) {
+			int listPos = listStart;
+
+			while (listPos < listEnd) {
+				if (!(modeList[listPos] | coefList[listPos])) {
+					listPos++;
+					continue;
+				}
+
+				bool coded = _random.nextNumber(3) == 0;
+				bits.put(coded, 1);
+				if (!coded) {
+					listPos++;
+					continue;
+				}
+
+				int ccoef = coefList[listPos];
+				int mode  = modeList[listPos];
+
+				if (mode == 0 || mode == 2) {
+					if (mode == 0) {
+						coefList[listPos] = ccoef + 4;
+						modeList[listPos] = 1;
+					} else {
+						coefList[listPos]   = 0;
+						modeList[listPos++] = 0;
+					}
+					for (int i = 0; i < 4; i++, ccoef++) {
+						bool split = _random.nextNumber(2);
+						bits.put(split, 1);
+						if (split) {
+							coefList[--listStart] = ccoef;
+							modeList[  listStart] = 3;
+						} else {
+							putCoefficient(bits, b);
+						}
+					}
+				} else if (mode == 1) {
+					modeList[listPos] = 2;
+					for (int i = 0; i < 3; i++) {
+						ccoef += 4;
+						coefList[listEnd]   = ccoef;
+						modeList[listEnd++] = 2;
+					}
+				} else {
+					putCoefficient(bits, b);
+					coefList[listPos]   = 0;
+					modeList[listPos++] = 0;
+				}
+			}
+		}
+
+		// Quantizer
+		bits.put(_random.nextNumber(16), 4);
+	}
+
+	void addBlock(int row, int x, int y, int width, int height, bool keyFrame) {
+		static const BlockType keyTypes[] = {
+			kBlockIntra, kBlockIntra, kBlockIntra, kBlockIntra, kBlockFill,
+			kBlockFill, kBlockPattern, kBlockPattern, kBlockRun, kBlockRaw
+		};
+		static const BlockType interTypes[] = {
+			kBlockSkip, kBlockSkip, kBlockSkip, kBlockMotion, kBlockMotion,
+			kBlockMotion, kBlockIntra, kBlockFill, kBlockPattern, kBlockRun
+		};
+		BlockType type = keyFrame ? keyTypes[_random.nextNumber(ARRAYSIZE(keyTypes))] : interTypes[_random.nextNumber(ARRAYSIZE(interTypes))];
+		BitList &bits = _inlineBits[row];
+
+		addValue(kSourceBlockTypes, row, type);
+
+		switch (type) {
+		case kBlockMotion: {
+			// Stay in the plane
+			int minX = -MIN(15, x), maxX = MIN(15, width - 8 - x);
+			int minY = -MIN(15, y), maxY = MIN(15, height - 8 - y);
+			addValue(kSourceXOff, row, minX + (int)_random.nextNumber(maxX - minX + 1));
+			addValue(kSourceYOff, row, minY + (int)_random.nextNumber(maxY - minY + 1));
+			break;
+		}
+		case kBlockRun: {
+			bits.put(_random.nextNumber(16), 4);
+			int i = 0;
+			do {
+				int run = 1 + _random.nextNumber(MIN(16, 64 - i));
+				addValue(kSourceRun, row, run - 1);
+				i += run;
+
+				bool fill = _random.nextNumber(2);
+				bits.put(fill, 1);
+				addColors(row, fill ? 1 : run);
+			} while (i < 63);
+			if (i == 63)
+				addColors(row, 1);
+			break;
+		}
+		case kBlockIntra:
+			addValue(kSourceIntraDC, row, 256 + _random.nextNumber(1536));
+			putDCTCoeffs(bits);
+			break;
+		case kBlockFill:
+			addColors(row, 1);
+			break;
+		case kBlockPattern:
+			addColors(row, 2);
+			for (int i = 0; i < 8; i++)
+				addValue(kSourcePattern, row, _random.nextNumber(256));
+			break;
+		case kBlockRaw:
+			addColors(row, 64);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void putValues(Source source, uint32 start, uint32 count) {
+		const int *values = &_values[source][start];
+
+		switch (source) {
+		case kSourceBlockTypes:
+		case kSourceSubBlockTypes:
+		case kSourceRun:
+			// Not all the same
+			putBits(0, 1);
+			for (uint32 i = 0; i < count; i++)
+				putSymbol(source, values[i]);
+			break;
+		case kSourceColors:
+			putBits(0, 1);
+			for (uint32 i = 0; i < count; i++) {
+				// The trees of the high nibbles are all the first one
+				putBits(values[i] >> 4, 4);
+				putSymbol(source, values[i] & 0xF);
+			}
+			break;
+		case kSourcePattern:
+			for (uint32 i = 0; i < count; i++) {
+				putSymbol(source, values[i] & 0xF);
+				putSymbol(source, values[i] >> 4);
+			}
+			break;
+		case kSourceXOff:
+		case kSourceYOff:
+			putBits(0, 1);
+			for (uint32 i = 0; i < count; i++) {
+				putSymbol(source, ABS(values[i]));
+				if (values[i])
+					putBits(values[i] < 0, 1);
+			}
+			break;
+		case kSourceIntraDC: {
+			// The first value, then the differences by groups of 8
+			putBits(values[0], 11);
+			int last = values[0];
+			for (uint32 i = 1; i < count; i += 8) {
+				uint32 groupEnd = MIN(i + 8, count);
+
+				int maxDelta = 0;
+				for (uint32 j = i; j < groupEnd; j++)
+					maxDelta = MAX(maxDelta, ABS(values[j] - values[j - 1]));
+				int size = maxDelta ? Common::intLog2(maxDelta) + 1 : 0;
+
+				putBits(size, 4);
+				for (uint32 j = i; j < groupEnd && size; j++) {
+					int delta = values[j] - last;
+					putBits(ABS(delta), size);
+					if (delta)
+						putBits(delta < 0, 1);
+					last = values[j];
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	void putPlane(bool keyFrame, bool isChroma) {
+		int blockWidth  = isChroma ? (kWidth + 15) >> 4 : (kWidth + 7) >> 3;
+		int blockHeight = isChroma ? (kHeight + 15) >> 4 : (kHeight + 7) >> 3;
+		int width  = isChroma ? kWidth >> 1 : kWidth;
+		int height = isChroma ? kHeight >> 1 : kHeight;
+
+		// The lengths of the element counts, as computed by the decoder
+		int countWidth = MAX(width, 8);
+		int colorBlocks = isChroma ? (kWidth + 15) >> 4 : (kWidth + 7) >> 3;
+		int countLengths[kSourceMAX];
+		countLengths[kSourceBlockTypes] = Common::intLog2((countWidth >> 3) + 511) + 1;
+		countLengths[kSourceSubBlockTypes] = Common::intLog2(((countWidth + 7) >> 4) + 511) + 1;
+		countLengths[kSourceColors] = Common::intLog2(colorBlocks * 64 + 511) + 1;
+		countLengths[kSourcePattern] = Common::intLog2((colorBlocks << 3) + 511) + 1;
+		countLengths[kSourceXOff] = Common::intLog2((countWidth >> 3) + 511) + 1;
+		countLengths[kSourceYOff] = countLengths[kSourceXOff];
+		countLengths[kSourceIntraDC] = countLengths[kSourceXOff];
+		countLengths[kSourceInterDC] = countLengths[kSourceXOff];
+		countLengths[kSourceRun] = Common::intLog2(colorBlocks * 48 + 511) + 1;
+
+		for (int i = 0; i < kSourceMAX; i++) {
+			_values[i].clear();
+			_valueRows[i].clear();
+		}
+		_inlineBits.clear();
+		_inlineBits.resize(blockHeight);
+
+		for (int y = 0; y < blockHeight; y++)
+			for (int x = 0; x < blockWidth; x++)
+				addBlock(y, x * 8, y * 8, width, height, keyFrame);
+
+		for (int i = 0; i < kSourceMAX; i++) {
+			if (i == kSourceColors) {
+				for (int j = 0; j < 16; j++)
+					putHuffman(0);
+			}
+			if (i != kSourceIntraDC && i != kSourceInterDC)
+				putHuffman(getTree(i));
+		}
+
+		// The decoder reads a bundle again when it used all the values it
+		// has, and stops reading it after an empty one
+		uint32 decoded[kSourceMAX], used[kSourceMAX];
+		bool ended[kSourceMAX];
+		for (int i = 0; i < kSourceMAX; i++) {
+			decoded[i] = used[i] = 0;
+			ended[i] = false;
+		}
+
+		for (int y = 0; y < blockHeight; y++) {
+			for (int i = 0; i < kSourceMAX; i++) {
+				if (ended[i] || decoded[i] > used[i])
+					continue;
+
+				// Whole rows only, as the values of a row are read at once
+				uint32 end = decoded[i];
+				while (end < _values[i].size()) {
+					uint32 rowEnd = end;
+					while (rowEnd < _values[i].size() && _valueRows[i][rowEnd] == _valueRows[i][end])
+						rowEnd++;
+					if (rowEnd - decoded[i] > (1u << countLengths[i]) - 1)
+						break;
+					end = rowEnd;
+				}
+
+				uint32 count = end - decoded[i];
+				putBits(count, countLengths[i]);
+				if (count) {
+					putValues((Source)i, decoded[i], count);
+					decoded[i] += count;
+				} else {
+					ended[i] = true;
+				}
+			}
+
+			for (int i = 0; i < kSourceMAX; i++)
+				while (used[i] < _valueRows[i].size() && _valueRows[i][used[i]] == y)
+					used[i]++;
+
+			const BitList &bits = _inlineBits[y];
+			for (uint i = 0; i < bits.values.size(); i++)
+				putBits(bits.values[i], bits.counts[i]);
+		}
+
+		// The next plane starts at a 32-bit boundary
+		putBits(0, (32 - (_bitPos & 31)) & 31);
+	}
+
+	static void putLE32(Common::Array<byte> &data, uint32 value) {
+		for (int i = 0; i < 4; i++)
+			data.push_back((value >> (i * 8)) & 0xFF);
+	}
+
+	void buildBink(Common::Array<byte> &bink) {
+		Common::Array<Common::Array<byte> > frames;
+		uint32 largestFrame = 0;
+		for (int i = 0; i < kFrames; i++) {
+			_data.clear();
+			_bitPos = 0;
+			for (int plane = 0; plane < 3; plane++)
+				putPlane(i == 0, plane != 0);
+			frames.push_back(_data);
+			largestFrame = MAX<uint32>(largestFrame, _data.size());
+		}
+
+		uint32 offset = 11 * 4 + kFrames * 4;
+		uint32 size = offset;
+		for (int i = 0; i < kFrames; i++)
+			size += frames[i].size();
+
+		bink.clear();
+		bink.push_back('B');
+		bink.push_back('I');
+		bink.push_back('K');
+		bink.push_back('f');
+		putLE32(bink, size - 8);
+		putLE32(bink, kFrames);
+		putLE32(bink, largestFrame);
+		putLE32(bink, 0);
+		putLE32(bink, kWidth);
+		putLE32(bink, kHeight);
+		// 25 fps, without alpha nor audio
+		putLE32(bink, 25);
+		putLE32(bink, 1);
+		putLE32(bink, 0);
+		putLE32(bink, 0);
+
+		for (int i = 0; i < kFrames; i++) {
+			putLE32(bink, offset | (i == 0 ? 1 : 0));
+			offset += frames[i].size();
+		}
+		for (int i = 0; i < kFrames; i++)
+			for (uint j = 0; j < frames[i].size(); j++)
+				bink.push_back(frames[i][j]);
+	}
+
+public:
+	void test_bink_decode() {
+		const int rounds = 4;
+
+		// For the mutex and the screen format of the decoder
+		BenchmarkSystem system;
+
+		Common::Array<byte> bink;
+		_random.setSeed(1);
+		buildBink(bink);
+
+		Video::BinkDecoder decoder;
+		double millis = 0.0;
+		int frames = 0;
+		for (int i = 0; i < rounds; i++) {
+			TS_ASSERT(decoder.loadStream(new Common::MemoryReadStream(&bink[0], bink.size())));
+
+			BenchmarkTimer timer;
+			while (!decoder.endOfVideo() && decoder.decodeNextFrame())
+				frames++;
+			millis += timer.elapsedMillis();
+		}
+		TS_TRACE(BenchmarkTimer::report("Bink frame decode", millis, frames * kWidth * kHeight).c_str());
+
+		TS_ASSERT_EQUALS(frames, rounds * kFrames);
+		decoder.close();
+	}
+};
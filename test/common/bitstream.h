@@ -3,6 +3,8 @@
 #include "common/bitstream.h"
 #include "common/memstream.h"
 
+#include "test/random.h"
+
 class BitStreamTestSuite : public CxxTest::TestSuite
 {
 	public:
@@ -149,4 +151,71 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(bs.peekBits(5), 12u);
 		TS_ASSERT(!bs.eos());
 	}
+
+	void test_memory_get_bits() {
+		byte contents[] = { 'a', 'b' };
+
+		Common::BitStreamMemory8MSB bs(contents, sizeof(contents));
+		TS_ASSERT_EQUALS(bs.pos(), 0u);
+		TS_ASSERT_EQUALS(bs.getBit(), 0u);
+		TS_ASSERT_EQUALS(bs.getBits(2), 3u);
+		TS_ASSERT_EQUALS(bs.pos(), 3u);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 11u);
+		TS_ASSERT_EQUALS(bs.pos(), 3u);
+		TS_ASSERT_EQUALS(bs.getBits(8), 11u);
+		TS_ASSERT_EQUALS(bs.pos(), 11u);
+		TS_ASSERT(!bs.eos());
+		TS_ASSERT_EQUALS(bs.getBits(5), 2u);
+		TS_ASSERT(bs.eos());
+
+		bs.rewind();
+		TS_ASSERT_EQUALS(bs.pos(), 0u);
+		TS_ASSERT_EQUALS(bs.size(), 16u);
+		bs.skip(11);
+		TS_ASSERT_EQUALS(bs.peekBits(5), 2u);
+	}
+
+	void test_memory_get_bits_lsb() {
+		byte contents[] = { 'a', 'b' };
+
+		Common::BitStreamMemory8LSB bs(contents, sizeof(contents));
+		TS_ASSERT_EQUALS(bs.getBits(3), 1u);
+		TS_ASSERT_EQUALS(bs.pos(), 3u);
+		TS_ASSERT_EQUALS(bs.peekBits(8), 76u);
+		TS_ASSERT_EQUALS(bs.getBits(8), 76u);
+		TS_ASSERT_EQUALS(bs.pos(), 11u);
+		TS_ASSERT_EQUALS(bs.getBits(5), 12u);
+		TS_ASSERT(bs.eos());
+	}
+
+	template<class BITSTREAM, class MEMORYSTREAM>
+	void checkMemoryStream() {
+		byte contents[256];
+		TestRandom rnd;
+		for (uint i = 0; i < sizeof(contents); i++)
+			contents[i] = rnd.nextByte();
+
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		BITSTREAM bs(ms);
+		MEMORYSTREAM mbs(contents, sizeof(contents));
+
+		// Mix reads of all widths with skips across the buffered bits
+		for (uint32 n = 0; bs.pos() + 32 + 40 <= bs.size(); n = (n + 7) % 33) {
+			TS_ASSERT_EQUALS(mbs.getBits(n), bs.getBits(n));
+			if (n == 5) {
+				bs.skip(40);
+				mbs.skip(40);
+			}
+			TS_ASSERT_EQUALS(mbs.pos(), bs.pos());
+		}
+
+		TS_ASSERT_EQUALS(mbs.size(), bs.size());
+	}
+
+	void test_memory_matches_stream() {
+		checkMemoryStream<Common::BitStream8MSB, Common::BitStreamMemory8MSB>();
+		checkMemoryStream<Common::BitStream8LSB, Common::BitStreamMemory8LSB>();
+		checkMemoryStream<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>();
+		checkMemoryStream<Common::BitStream32BEMSB, Common::BitStreamMemory32BEMSB>();
+	}
 };
@@ -0,0 +1,149 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitstream.h"
+#include "common/huffman.h"
+#include "common/memstream.h"
+
+#include "test/random.h"
+
+class HuffmanTestSuite : public CxxTest::TestSuite {
+	// Canonical codes for the given ascending lengths, as read MSB first
+	static void makeCodes(uint32 count, const uint8 *lengths, uint32 *codes, bool msb2lsb) {
+		uint32 code = 0;
+		for (uint32 i = 0; i < count; i++) {
+			if (i > 0)
+				code = (code + 1) << (lengths[i] - lengths[i - 1]);
+
+			codes[i] = code;
+
+			// In LSB first streams, the first bit read is the code's bit 0
+			if (!msb2lsb) {
+				codes[i] = 0;
+				for (uint32 j = 0; j < lengths[i]; j++)
+					if (code & (1 << (lengths[i] - 1 - j)))
+						codes[i] |= 1 << j;
+			}
+		}
+	}
+
+	// Write the codes of the symbols into data, in the stream's bit order
+	static uint32 encode(Common::Array<byte> &data, const Common::Array<uint32> &symbols,
+	                     const uint32 *codes, const uint8 *lengths, bool msb2lsb) {
+		uint32 bit = 0;
+		data.clear();
+
+		for (uint32 i = 0; i < symbols.size(); i++) {
+			uint32 s = symbols[i];
+
+			for (uint32 j = 0; j < lengths[s]; j++, bit++) {
+				if ((bit >> 3) >= data.size()) {
+					// Keep the size a multiple of 32 bits
+					for (int k = 0; k < 4; k++)
+						data.push_back(0);
+				}
+
+				uint32 b = msb2lsb ? (codes[s] >> (lengths[s] - 1 - j)) & 1 : (codes[s] >> j) & 1;
+				if (b)
+					data[bit >> 3] |= msb2lsb ? (0x80 >> (bit & 7)) : (1 << (bit & 7));
+			}
+		}
+
+		return bit;
+	}
+
+	static Common::Array<uint32> randomSymbols(uint32 count, uint32 codeCount, uint32 seed) {
+		TestRandom rnd(seed);
+		Common::Array<uint32> symbols;
+		for (uint32 i = 0; i < count; i++) {
+			uint32 value = rnd.next();
+			// Favour the short codes, as a real stream would
+			uint32 s = (value >> 16) % codeCount;
+			symbols.push_back((value & 0x100) ? s / 4 : s);
+		}
+		return symbols;
+	}
+
+	template<class BITSTREAM, class MEMORYSTREAM>
+	void checkDecode(uint32 codeCount, const uint8 *lengths, bool withSymbols) {
+		const bool msb2lsb = BITSTREAM::msb2lsb();
+
+		Common::Array<uint32> codes;
+		codes.resize(codeCount);
+		makeCodes(codeCount, lengths, codes.begin(), msb2lsb);
+
+		Common::Array<uint32> values;
+		for (uint32 i = 0; i < codeCount; i++)
+			values.push_back(1000 + i * 3);
+
+		Common::Huffman huffman(0, codeCount, codes.begin(), lengths, withSymbols ? values.begin() : 0);
+
+		Common::Array<uint32> symbols = randomSymbols(2000, codeCount, codeCount);
+		Common::Array<byte> data;
+		uint32 bits = encode(data, symbols, codes.begin(), lengths, msb2lsb);
+
+		Common::MemoryReadStream tableStream(data.begin(), data.size());
+		Common::MemoryReadStream listStream(data.begin(), data.size());
+		BITSTREAM tableBits(tableStream);
+		BITSTREAM listBits(listStream);
+		MEMORYSTREAM memoryBits(data.begin(), data.size());
+
+		for (uint32 i = 0; i < symbols.size(); i++) {
+			uint32 expected = withSymbols ? values[symbols[i]] : symbols[i];
+
+			TS_ASSERT_EQUALS(huffman.getSymbol(tableBits), expected);
+			TS_ASSERT_EQUALS(huffman.getSymbol(static_cast<Common::BitStream &>(listBits)), expected);
+			TS_ASSERT_EQUALS(huffman.getSymbol(memoryBits), expected);
+			TS_ASSERT_EQUALS(tableBits.pos(), listBits.pos());
+			TS_ASSERT_EQUALS(memoryBits.pos(), listBits.pos());
+		}
+
+		TS_ASSERT_EQUALS(tableBits.pos(), bits);
+	}
+
+public:
+	void test_short_codes() {
+		const uint8 lengths[] = { 2, 2, 3, 3, 3, 4, 5, 5 };
+
+		checkDecode<Common::BitStream8MSB, Common::BitStreamMemory8MSB>(ARRAYSIZE(lengths), lengths, false);
+		checkDecode<Common::BitStream8LSB, Common::BitStreamMemory8LSB>(ARRAYSIZE(lengths), lengths, true);
+		checkDecode<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>(ARRAYSIZE(lengths), lengths, true);
+		checkDecode<Common::BitStream16BEMSB, Common::BitStreamMemory16BEMSB>(ARRAYSIZE(lengths), lengths, false);
+	}
+
+	void test_secondary_tables() {
+		const uint8 lengths[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 15 };
+
+		checkDecode<Common::BitStream32BEMSB, Common::BitStreamMemory32BEMSB>(ARRAYSIZE(lengths), lengths, true);
+		checkDecode<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>(ARRAYSIZE(lengths), lengths, false);
+	}
+
+	void test_overlong_codes() {
+		// The longest codes do not fit in a secondary table and are searched
+		const uint8 lengths[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+		                          17, 18, 19, 20, 21, 22, 23, 24, 24 };
+
+		checkDecode<Common::BitStream8MSB, Common::BitStreamMemory8MSB>(ARRAYSIZE(lengths), lengths, false);
+		checkDecode<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>(ARRAYSIZE(lengths), lengths, true);
+	}
+
+	void test_set_symbols() {
+		const uint8 lengths[] = { 1, 2, 3, 3 };
+		const uint32 symbols[] = { 7, 6, 5, 4 };
+		uint32 codes[ARRAYSIZE(lengths)];
+		makeCodes(ARRAYSIZE(lengths), lengths, codes, true);
+
+		Common::Huffman huffman(0, ARRAYSIZE(lengths), codes, lengths);
+
+		// 0 10 110 111
+		const byte data[] = { 0x5B, 0x80 };
+		Common::MemoryReadStream ms(data, sizeof(data));
+		Common::BitStream8MSB bs(ms);
+
+		TS_ASSERT_EQUALS(huffman.getSymbol(bs), 0u);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bs), 1u);
+
+		huffman.setSymbols(symbols);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bs), 5u);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bs), 4u);
+	}
+};
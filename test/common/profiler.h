@@ -0,0 +1,81 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/profiler.h"
+
+// Only the storage is tested, since the profiler itself needs a backend for
+// its clock and its mutex.
+class ProfilerTestSuite : public CxxTest::TestSuite {
+public:
+	void test_zones() {
+		Common::ProfileLog log(16);
+
+		TS_ASSERT_EQUALS(log.addZone("luaUpdate"), 0u);
+		TS_ASSERT_EQUALS(log.addZone("flipBuffer"), 1u);
+		// The same name from another call site is the same zone
+		TS_ASSERT_EQUALS(log.addZone("luaUpdate"), 0u);
+		TS_ASSERT_EQUALS(log.getZoneCount(), 2u);
+		TS_ASSERT_EQUALS(log.getZoneStats(1).name, "flipBuffer");
+		TS_ASSERT_EQUALS(log.getZoneStats(1).count, 0u);
+		TS_ASSERT_EQUALS(log.getZoneStats(1).getAverage(), 0u);
+	}
+
+	void test_stats() {
+		Common::ProfileLog log(16);
+		log.addZone("a");
+		log.addZone("b");
+
+		log.record(0, 0, 100, 30);
+		log.record(0, 0, 200, 10);
+		log.record(0, 1, 300, 50);
+		log.record(1, 0, 400, 7);
+
+		const Common::ProfileZoneStats &a = log.getZoneStats(0);
+		TS_ASSERT_EQUALS(a.count, 3u);
+		TS_ASSERT_EQUALS(a.min, 10u);
+		TS_ASSERT_EQUALS(a.max, 50u);
+		TS_ASSERT_EQUALS(a.getAverage(), 30u);
+		TS_ASSERT_EQUALS(log.getZoneStats(1).count, 1u);
+
+		log.reset();
+		TS_ASSERT_EQUALS(log.getZoneCount(), 2u);
+		TS_ASSERT_EQUALS(log.getZoneStats(0).count, 0u);
+		TS_ASSERT_EQUALS(log.getEventCount(), 0u);
+	}
+
+	void test_ring_buffer() {
+		Common::ProfileLog log(4);
+		log.addZone("a");
+
+		for (uint32 i = 0; i < 3; i++)
+			log.record(0, 0, i * 10, 1);
+		TS_ASSERT_EQUALS(log.getEventCount(), 3u);
+		TS_ASSERT_EQUALS(log.getEvent(0).start, 0u);
+
+		// The oldest events are overwritten, but still count in the statistics
+		for (uint32 i = 3; i < 10; i++)
+			log.record(0, 0, i * 10, 1);
+		TS_ASSERT_EQUALS(log.getEventCount(), 4u);
+		for (uint32 i = 0; i < 4; i++)
+			TS_ASSERT_EQUALS(log.getEvent(i).start, (6 + i) * 10);
+		TS_ASSERT_EQUALS(log.getZoneStats(0).count, 10u);
+	}
+
+	void test_chrome_trace() {
+		Common::ProfileLog log(4);
+		log.addZone("Actor::draw");
+		log.addZone("say \"hi\"");
+		log.record(0, 3, 1000, 250);
+		log.record(1, 0, 1300, 5);
+
+		Common::MemoryWriteStreamDynamic stream(DisposeAfterUse::YES);
+		log.writeChromeTrace(stream);
+		Common::String json((const char *)stream.getData(), stream.size());
+
+		TS_ASSERT_EQUALS(json,
+			"{\"traceEvents\":[\n"
+			"{\"name\":\"Actor::draw\",\"ph\":\"X\",\"pid\":1,\"tid\":3,\"ts\":1000,\"dur\":250},\n"
+			"{\"name\":\"say \\\"hi\\\"\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":1300,\"dur\":5}\n"
+			"],\"displayTimeUnit\":\"ms\"}\n");
+	}
+};
@@ -0,0 +1,113 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/timer.h"
+
+// The schedules are driven by a fake clock, in milliseconds, so that the
+// tests do not depend on the speed of the machine running them.
+class TimerTestSuite : public CxxTest::TestSuite {
+	// Run a timer the way a worker does, sleeping until it is due
+	static void runIsolated(Common::TimerSchedule &schedule, uint32 cost, uint32 endTime) {
+		uint32 now = 0;
+
+		while (now < endTime) {
+			now += schedule.getDelay(now);
+			if (schedule.isDue(now)) {
+				schedule.fire(now);
+				now += cost;
+			}
+		}
+	}
+
+public:
+	void test_fire_times() {
+		Common::TimerSchedule schedule(10000, 5);
+
+		TS_ASSERT_EQUALS(schedule.getInterval(), 10000u);
+		TS_ASSERT_EQUALS(schedule.getNextFireTime(), 15u);
+		TS_ASSERT(!schedule.isDue(15));
+		TS_ASSERT(schedule.isDue(16));
+		TS_ASSERT_EQUALS(schedule.getDelay(5), 11u);
+		TS_ASSERT_EQUALS(schedule.getDelay(16), 0u);
+
+		schedule.fire(16);
+		TS_ASSERT_EQUALS(schedule.getNextFireTime(), 25u);
+
+		// A late invocation moves on from the due time, not from now
+		schedule.fire(40);
+		TS_ASSERT_EQUALS(schedule.getNextFireTime(), 35u);
+		TS_ASSERT(schedule.isDue(40));
+	}
+
+	void test_no_drift() {
+		// 12.5ms is not a whole number of clock ticks
+		Common::TimerSchedule schedule(12500, 0);
+
+		for (int i = 0; i < 79; i++)
+			schedule.fire(schedule.getNextFireTime() + 1);
+
+		TS_ASSERT_EQUALS(schedule.getNextFireTime(), 1000u);
+	}
+
+	void test_stats() {
+		Common::TimerSchedule schedule(10000, 0);
+
+		// Due at 10ms, fired 1ms later
+		schedule.fire(11);
+		// Due at 20ms, fired a whole interval later
+		schedule.fire(30);
+		// Due at 30ms, fired early
+		schedule.fire(25);
+
+		const Common::TimerStats &stats = schedule.getStats();
+		TS_ASSERT_EQUALS(stats.fired, 3u);
+		TS_ASSERT_EQUALS(stats.late, 1u);
+		TS_ASSERT_EQUALS(stats.maxLateness, 10000u);
+		TS_ASSERT_EQUALS(stats.totalLateness, 11000u);
+
+		// The lateness is measured from the exact due time
+		Common::TimerSchedule fraction(16666, 0);
+		fraction.fire(17);
+		TS_ASSERT_EQUALS(fraction.getStats().maxLateness, 334u);
+	}
+
+	void test_isolation() {
+		const uint32 endTime = 2000;
+		const uint32 audioInterval = 16666, audioCost = 1;
+		const uint32 videoInterval = 10000, videoCost = 30;
+
+		// Both timers run by a shared handler, invoked every 10ms: the slow
+		// video callback delays the audio one
+		Common::TimerSchedule sharedAudio(audioInterval, 0);
+		Common::TimerSchedule sharedVideo(videoInterval, 0);
+		uint32 now = 0;
+		while (now < endTime) {
+			now += 10 - now % 10;
+
+			while (sharedAudio.isDue(now) || sharedVideo.isDue(now)) {
+				if (sharedAudio.isDue(now) && sharedAudio.getNextFireTime() <= sharedVideo.getNextFireTime()) {
+					sharedAudio.fire(now);
+					now += audioCost;
+				} else {
+					sharedVideo.fire(now);
+					now += videoCost;
+				}
+			}
+		}
+
+		TS_ASSERT_LESS_THAN(0u, sharedAudio.getStats().late);
+		TS_ASSERT_LESS_THAN_EQUALS(audioInterval, sharedAudio.getStats().maxLateness);
+
+		// Each timer on its own worker: the audio timer is only delayed by
+		// the resolution of the clock
+		Common::TimerSchedule isolatedAudio(audioInterval, 0);
+		Common::TimerSchedule isolatedVideo(videoInterval, 0);
+		runIsolated(isolatedAudio, audioCost, endTime);
+		runIsolated(isolatedVideo, videoCost, endTime);
+
+		TS_ASSERT_EQUALS(isolatedAudio.getStats().late, 0u);
+		TS_ASSERT_LESS_THAN_EQUALS(isolatedAudio.getStats().maxLateness, 1000u);
+
+		// The video timer cannot keep up either way, and is reported late
+		TS_ASSERT_LESS_THAN(0u, isolatedVideo.getStats().late);
+	}
+};
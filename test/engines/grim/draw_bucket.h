@@ -0,0 +1,41 @@
+#include <cxxtest/TestSuite.h>
+
+#include "engines/grim/draw_bucket.h"
+
+/*
+ * Checks the order in which a DrawBucket gives back the faces of a model:
+ * opaque ones grouped by state, then blended ones as they were added.
+ */
+class DrawBucketTestSuite : public CxxTest::TestSuite {
+public:
+	void test_opaque_grouped_by_state() {
+		Grim::DrawBucket bucket;
+		const uint32 states[] = { 3, 1, 3, 2, 1, 3 };
+		for (uint32 i = 0; i < ARRAYSIZE(states); i++)
+			bucket.add(Grim::DrawBucket::kPassOpaque, states[i], i);
+		bucket.sort();
+
+		const uint32 expected[] = { 1, 4, 3, 0, 2, 5 };
+		TS_ASSERT_EQUALS(bucket.size(), (uint)ARRAYSIZE(expected));
+		for (uint i = 0; i < ARRAYSIZE(expected); i++)
+			TS_ASSERT_EQUALS(bucket.getIndex(i), expected[i]);
+	}
+
+	void test_blended_last_in_order() {
+		Grim::DrawBucket bucket;
+		bucket.add(Grim::DrawBucket::kPassBlended, 7, 0);
+		bucket.add(Grim::DrawBucket::kPassOpaque, 9, 1);
+		bucket.add(Grim::DrawBucket::kPassBlended, 2, 2);
+		bucket.add(Grim::DrawBucket::kPassOpaque, 4, 3);
+		bucket.add(Grim::DrawBucket::kPassBlended, 5, 4);
+		bucket.sort();
+
+		const uint32 expected[] = { 3, 1, 0, 2, 4 };
+		TS_ASSERT_EQUALS(bucket.size(), (uint)ARRAYSIZE(expected));
+		for (uint i = 0; i < ARRAYSIZE(expected); i++)
+			TS_ASSERT_EQUALS(bucket.getIndex(i), expected[i]);
+
+		bucket.clear();
+		TS_ASSERT_EQUALS(bucket.size(), 0u);
+	}
+};
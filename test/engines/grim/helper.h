@@ -0,0 +1,133 @@
+#ifndef TEST_ENGINES_GRIM_HELPER_H
+#define TEST_ENGINES_GRIM_HELPER_H
+
+#include "common/array.h"
+#include "common/endian.h"
+#include "common/util.h"
+
+#include "test/random.h"
+
+/*
+ * Builds a deterministic stream of Blocky16 frames using every block
+ * code, with random colors and motion vectors that stay in the frame.
+ */
+class Blocky16StreamBuilder {
+public:
+	Blocky16StreamBuilder(int width, int height, uint32 seed) : _width(width), _height(height), _random(seed) { }
+
+	const byte *buildFrame(int seqNb) {
+		_frame.clear();
+		for (int i = 0; i < kHeaderSize; i++)
+			put8(0);
+		WRITE_LE_UINT16(&_frame[16], seqNb);
+		_frame[18] = 2;
+		_frame[19] = seqNb % 3;
+		for (int i = 24; i < 34; i++)
+			_frame[i] = _random.nextNumber(256);
+		for (int i = 40; i < 40 + 512; i++)
+			_frame[i] = _random.nextNumber(256);
+
+		for (int y = 0; y < _height; y += 8)
+			for (int x = 0; x < _width; x += 8)
+				putBlock(x, y, 8);
+		// Slack for the decoder reading past the last code
+		putRandom(16);
+
+		return &_frame[0];
+	}
+
+	uint32 getFrameSize() const { return _frame.size(); }
+
+private:
+	enum {
+		kHeaderSize = 560
+	};
+
+	// Motion table entries with small vectors: code, dx, dy
+	struct MotionVector {
+		int code, dx, dy;
+	};
+
+	int _width, _height;
+	TestRandom _random;
+	Common::Array<byte> _frame;
+
+	void put8(int value) {
+		_frame.push_back((byte)value);
+	}
+
+	void put16(int value) {
+		put8(value & 0xFF);
+		put8((value >> 8) & 0xFF);
+	}
+
+	void putRandom(int count) {
+		while (count--)
+			put8(_random.nextNumber(256));
+	}
+
+	// Checks that a block of the given size read from the given position
+	// stays inside the reference frame.
+	bool isValidMotion(int x, int y, int size, int dx, int dy) {
+		int start = (y + dy) * _width + x + dx;
+		int end = start + (size - 1) * _width + size;
+		return start >= 0 && end <= _width * _height;
+	}
+
+	void putMotion(int x, int y, int size) {
+		static const MotionVector vectors[] = {
+			{   0,   0,  0 }, {  87,  -7, -3 }, {  91,   0, -3 }, {  97, -14, -2 },
+			{ 109,  14, -2 }, { 117,   0, -1 }, { 122,  -5,  0 }, { 130,   7,  0 },
+			{ 136,   0,  1 }, { 143, -14,  2 }, { 155,  14,  2 }, { 164,   4,  3 }
+		};
+
+		if (_random.nextNumber(4) == 0) {
+			int dx = (int)_random.nextNumber(41) - 20;
+			int dy = (int)_random.nextNumber(9) - 4;
+			if (isValidMotion(x, y, size, dx, dy)) {
+				put8(0xF5);
+				put16(dy * _width + dx);
+				return;
+			}
+		} else {
+			const MotionVector &v = vectors[_random.nextNumber(ARRAYSIZE(vectors))];
+			if (isValidMotion(x, y, size, v.dx, v.dy)) {
+				put8(v.code);
+				return;
+			}
+		}
+		put8(0xF6);
+	}
+
+	void putBlock(int x, int y, int size) {
+		int code = 0xF5 + _random.nextNumber(11);
+
+		if (code == 0xF5) {
+			putMotion(x, y, size);
+		} else if (code == 0xFF) {
+			put8(code);
+			if (size == 2) {
+				putRandom(8);
+			} else {
+				int half = size / 2;
+				putBlock(x, y, half);
+				putBlock(x + half, y, half);
+				putBlock(x, y + half, half);
+				putBlock(x + half, y + half, half);
+			}
+		} else {
+			put8(code);
+			if (code == 0xF7) {
+				putRandom(size == 2 ? 4 : 3);
+			} else if (code == 0xF8) {
+				putRandom(size == 2 ? 8 : 5);
+			} else if (code == 0xFD) {
+				putRandom(1);
+			} else if (code == 0xFE) {
+				putRandom(2);
+			}
+		}
+	}
+};
+
+#endif
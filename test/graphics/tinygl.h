@@ -0,0 +1,428 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+
+#include "graphics/pixelbuffer.h"
+#include "graphics/tinygl/zgl.h"
+
+#include "test/random.h"
+
+/*
+ * Checks that the batched vertex pipeline of TinyGL transforms, clip codes
+ * and lights vertices like the per-vertex one, and that the texture
+ * filters and mip chains draw what they should.
+ */
+class TinyGLTestSuite : public CxxTest::TestSuite {
+	enum {
+		kSize = 64,
+		// not a multiple of the batch size nor of 4
+		kVertices = 2 * VERTEX_BATCH_SIZE + 7,
+		kTextureSize = 256
+	};
+
+	TestRandom _random;
+
+	void assertClose(float expected, float actual) {
+		TS_ASSERT_DELTA(expected, actual, 1E-4 * MAX(1.0f, fabs(expected)));
+	}
+
+	void setupLights() {
+		float ambient[] = { 0.2f, 0.2f, 0.2f, 1.0f };
+		float diffuse[] = { 0.8f, 0.6f, 0.4f, 1.0f };
+		float specular[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		float direction[] = { 0.3f, 0.5f, 1.0f, 0.0f };
+		float position[] = { 1.0f, 2.0f, -2.0f, 1.0f };
+		float spotDirection[] = { -0.2f, -0.5f, -1.0f };
+
+		tglEnable(TGL_LIGHTING);
+		tglEnable(TGL_NORMALIZE);
+		tglLightModelfv(TGL_LIGHT_MODEL_AMBIENT, ambient);
+
+		tglEnable(TGL_LIGHT0);
+		tglLightfv(TGL_LIGHT0, TGL_DIFFUSE, diffuse);
+		tglLightfv(TGL_LIGHT0, TGL_POSITION, direction);
+
+		tglEnable(TGL_LIGHT1);
+		tglLightfv(TGL_LIGHT1, TGL_DIFFUSE, diffuse);
+		tglLightfv(TGL_LIGHT1, TGL_SPECULAR, specular);
+		tglLightfv(TGL_LIGHT1, TGL_POSITION, position);
+		tglLightfv(TGL_LIGHT1, TGL_SPOT_DIRECTION, spotDirection);
+		tglLightf(TGL_LIGHT1, TGL_SPOT_CUTOFF, 60.0f);
+		tglLightf(TGL_LIGHT1, TGL_SPOT_EXPONENT, 2.0f);
+		tglLightf(TGL_LIGHT1, TGL_LINEAR_ATTENUATION, 0.1f);
+
+		tglMaterialfv(TGL_FRONT, TGL_SPECULAR, specular);
+		tglMaterialf(TGL_FRONT, TGL_SHININESS, 20.0f);
+	}
+
+	void compare(bool lighting) {
+		TinyGL::GLVertex expected[kVertices], actual[kVertices];
+		TinyGL::GLVertex *batch[kVertices];
+		Graphics::PixelBuffer buffer(screenFormat(), kSize * kSize, DisposeAfterUse::YES);
+		TinyGL::ZBuffer *zb = TinyGL::ZB_open(kSize, kSize, buffer);
+		TinyGL::glInit(zb);
+		TinyGL::GLContext *c = TinyGL::gl_get_context();
+
+		tglViewport(0, 0, kSize, kSize);
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 100.0f);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglTranslatef(0.5f, -0.25f, -4.0f);
+		tglRotatef(30.0f, 0.0f, 1.0f, 0.0f);
+		tglScalef(1.5f, 1.0f, 0.75f);
+		tglEnable(TGL_TEXTURE_2D);
+
+		if (lighting)
+			setupLights();
+
+		_random.setSeed(1234);
+		for (int i = 0; i < kVertices; i++) {
+			TinyGL::GLVertex &v = expected[i];
+			memset(&v, 0, sizeof(v));
+			// some vertices end up outside of the view volume
+			v.coord.X = _random.nextFloat(-4.0f, 4.0f);
+			v.coord.Y = _random.nextFloat(-4.0f, 4.0f);
+			v.coord.Z = _random.nextFloat(-4.0f, 4.0f);
+			v.coord.W = 1.0f;
+			v.normal.X = _random.nextFloat(-1.0f, 1.0f);
+			v.normal.Y = _random.nextFloat(-1.0f, 1.0f);
+			v.normal.Z = _random.nextFloat(-1.0f, 1.0f);
+			v.color.X = _random.nextFloat(0.0f, 1.0f);
+			v.color.Y = _random.nextFloat(0.0f, 1.0f);
+			v.color.Z = _random.nextFloat(0.0f, 1.0f);
+			v.color.W = 1.0f;
+			v.tex_coord.X = _random.nextFloat(0.0f, 1.0f);
+			v.tex_coord.Y = _random.nextFloat(0.0f, 1.0f);
+			v.tex_coord.W = 1.0f;
+			actual[i] = v;
+			batch[i] = &actual[i];
+		}
+
+		// glBegin() updates the matrices used to process the vertices
+		tglBegin(TGL_POINTS);
+		for (int i = 0; i < kVertices; i++)
+			TinyGL::gl_process_vertex(c, &expected[i]);
+		TinyGL::gl_process_vertices(c, batch, kVertices);
+		tglEnd();
+
+		for (int i = 0; i < kVertices; i++) {
+			const TinyGL::GLVertex &e = expected[i];
+			const TinyGL::GLVertex &a = actual[i];
+
+			TS_ASSERT_EQUALS(e.clip_code, a.clip_code);
+			for (int j = 0; j < 4; j++) {
+				assertClose(e.pc.v[j], a.pc.v[j]);
+				assertClose(e.color.v[j], a.color.v[j]);
+			}
+			if (lighting) {
+				for (int j = 0; j < 4; j++)
+					assertClose(e.ec.v[j], a.ec.v[j]);
+				assertClose(e.normal.X, a.normal.X);
+				assertClose(e.normal.Y, a.normal.Y);
+				assertClose(e.normal.Z, a.normal.Z);
+			}
+			if (e.clip_code == 0) {
+				TS_ASSERT_LESS_THAN_EQUALS(ABS(e.zp.x - a.zp.x), 1);
+				TS_ASSERT_LESS_THAN_EQUALS(ABS(e.zp.y - a.zp.y), 1);
+				TS_ASSERT_LESS_THAN_EQUALS(ABS(e.zp.r - a.zp.r), 1);
+				TS_ASSERT_EQUALS(e.zp.s, a.zp.s);
+			}
+		}
+
+		TinyGL::glClose();
+		TinyGL::ZB_close(zb);
+	}
+
+	static Graphics::PixelFormat screenFormat() {
+		return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+	}
+
+	// Random texels, with some transparent ones when holes is set
+	unsigned int createTexture(bool constant, bool holes) {
+		Common::Array<byte> texels;
+		unsigned int texture;
+
+		texels.resize(kTextureSize * kTextureSize * 4);
+		for (uint i = 0; i < texels.size(); i += 4) {
+			for (int j = 0; j < 3; j++)
+				texels[i + j] = constant ? 0x80 + j * 0x20 : (byte)_random.nextFloat(0.0f, 255.0f);
+			texels[i + 3] = holes && _random.nextFloat(0.0f, 1.0f) < 0.2f ? 0 : 0xFF;
+		}
+
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, 3, kTextureSize, kTextureSize, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, &texels[0]);
+		return texture;
+	}
+
+	void setFiltering(const Common::Array<unsigned int> &textures, int minFilter, int magFilter) {
+		for (uint i = 0; i < textures.size(); i++) {
+			tglBindTexture(TGL_TEXTURE_2D, textures[i]);
+			tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, minFilter);
+			tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, magFilter);
+		}
+	}
+
+	// Covers the screen with squares of quadSize pixels, each showing a
+	// whole texture turned by 90 degrees.
+	void drawQuads(const Common::Array<unsigned int> &textures, int screenSize, int quadSize) {
+		int n = screenSize / quadSize;
+		float step = 2.0f / n;
+
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		for (int y = 0; y < n; y++) {
+			for (int x = 0; x < n; x++) {
+				float x0 = -1.0f + x * step, y0 = -1.0f + y * step;
+
+				tglBindTexture(TGL_TEXTURE_2D, textures[(y * n + x) % textures.size()]);
+				tglBegin(TGL_QUADS);
+				tglTexCoord2f(0.0f, 1.0f);
+				tglVertex3f(x0, y0, 0.0f);
+				tglTexCoord2f(0.0f, 0.0f);
+				tglVertex3f(x0 + step, y0, 0.0f);
+				tglTexCoord2f(1.0f, 0.0f);
+				tglVertex3f(x0 + step, y0 + step, 0.0f);
+				tglTexCoord2f(1.0f, 1.0f);
+				tglVertex3f(x0, y0 + step, 0.0f);
+				tglEnd();
+			}
+		}
+	}
+
+	// Draws the same textured scene with two settings and checks that the
+	// results are the same
+	void compareDrawing(bool constant, int minFilter1, int minFilter2, int magFilter) {
+		Graphics::PixelBuffer buffer(screenFormat(), kSize * kSize, DisposeAfterUse::YES);
+		Common::Array<byte> expected;
+		Common::Array<unsigned int> textures;
+		TinyGL::ZBuffer *zb = TinyGL::ZB_open(kSize, kSize, buffer);
+		TinyGL::glInit(zb);
+		tglViewport(0, 0, kSize, kSize);
+		tglEnable(TGL_TEXTURE_2D);
+		expected.resize(kSize * kSize * 2);
+
+		_random.setSeed(42);
+		for (int i = 0; i < 3; i++)
+			textures.push_back(createTexture(constant, !constant));
+
+		// squares of 64, 16 and 4 pixels: 4x, 16x and 64x minification
+		for (int quadSize = kSize; quadSize >= 4; quadSize /= 4) {
+			setFiltering(textures, minFilter1, magFilter);
+			drawQuads(textures, kSize, quadSize);
+			memcpy(&expected[0], buffer.getRawBuffer(), expected.size());
+
+			setFiltering(textures, minFilter2, magFilter);
+			drawQuads(textures, kSize, quadSize);
+			TS_ASSERT(memcmp(&expected[0], buffer.getRawBuffer(), expected.size()) == 0);
+		}
+
+		TinyGL::glClose();
+		TinyGL::ZB_close(zb);
+	}
+
+	// Triangles and a polygon; the color of the first triangles is left to
+	// the current state
+	void drawShapes() {
+		tglBegin(TGL_TRIANGLES);
+		for (int i = 0; i < 8; i++) {
+			float a0 = i * (float)M_PI / 4, a1 = (i + 1) * (float)M_PI / 4;
+
+			if (i == 3)
+				tglColor3f(0.2f, 0.9f, 0.4f);
+			tglVertex3f(0.0f, 0.0f, 0.0f);
+			tglVertex3f(0.9f * cos(a0), 0.9f * sin(a0), 0.5f);
+			tglVertex3f(0.9f * cos(a1), 0.9f * sin(a1), -0.5f);
+		}
+		tglEnd();
+
+		tglColor3f(0.7f, 0.1f, 0.8f);
+		tglBegin(TGL_POLYGON);
+		tglVertex3f(-0.3f, -0.3f, 0.0f);
+		tglVertex3f(0.3f, -0.2f, 0.0f);
+		tglVertex3f(0.2f, 0.4f, 0.0f);
+		tglVertex3f(-0.3f, 0.3f, 0.0f);
+		tglEnd();
+	}
+
+	// Checks that calling the list draws what drawShapes() draws, in
+	// several states
+	void compareList(bool compiled) {
+		Graphics::PixelBuffer buffer(screenFormat(), kSize * kSize, DisposeAfterUse::YES);
+		Common::Array<byte> expected;
+		TinyGL::ZBuffer *zb = TinyGL::ZB_open(kSize, kSize, buffer);
+		TinyGL::glInit(zb);
+		TinyGL::GLContext *c = TinyGL::gl_get_context();
+		tglViewport(0, 0, kSize, kSize);
+		expected.resize(kSize * kSize * 2);
+
+		unsigned int list = tglGenLists(1);
+		TS_ASSERT_DIFFERS(list, 0u);
+		tglNewList(list, TGL_COMPILE);
+		if (!compiled)
+			tglRotatef(10.0f, 0.0f, 0.0f, 1.0f);
+		drawShapes();
+		tglEndList();
+		TS_ASSERT_EQUALS(c->shared_state.lists[list]->compiled != NULL, compiled);
+
+		// the second call takes the vertices processed by the first one
+		const float angles[] = { 0.0f, 0.0f, 30.0f, 30.0f };
+		const float reds[] = { 1.0f, 1.0f, 1.0f, 0.3f };
+		for (uint i = 0; i < ARRAYSIZE(angles); i++) {
+			tglMatrixMode(TGL_MODELVIEW);
+			tglLoadIdentity();
+			tglRotatef(angles[i], 0.0f, 0.0f, 1.0f);
+
+			tglPushMatrix();
+			if (!compiled)
+				tglRotatef(10.0f, 0.0f, 0.0f, 1.0f);
+			tglColor3f(reds[i], 0.5f, 0.0f);
+			tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+			drawShapes();
+			tglPopMatrix();
+			memcpy(&expected[0], buffer.getRawBuffer(), expected.size());
+
+			tglColor3f(reds[i], 0.5f, 0.0f);
+			tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+			tglPushMatrix();
+			tglCallList(list);
+			tglPopMatrix();
+			TS_ASSERT(memcmp(&expected[0], buffer.getRawBuffer(), expected.size()) == 0);
+			TS_ASSERT_EQUALS(c->current_color.X, 0.7f);
+		}
+
+		tglDeleteLists(list, 1);
+		TS_ASSERT(!tglIsList(list));
+
+		TinyGL::glClose();
+		TinyGL::ZB_close(zb);
+	}
+
+public:
+	void test_batch_unlit() {
+		compare(false);
+	}
+
+	void test_batch_lit() {
+		compare(true);
+	}
+
+	void test_display_list_compiled() {
+		compareList(true);
+	}
+
+	void test_display_list_ops() {
+		compareList(false);
+	}
+
+	void test_texture_filters_constant() {
+		// a plain texture looks the same whatever the level and filter
+		compareDrawing(true, TGL_NEAREST, TGL_NEAREST_MIPMAP_NEAREST, TGL_NEAREST);
+		compareDrawing(true, TGL_NEAREST, TGL_LINEAR_MIPMAP_LINEAR, TGL_LINEAR);
+	}
+
+	void test_texture_level_selection() {
+		Graphics::PixelBuffer buffer(screenFormat(), kSize * kSize, DisposeAfterUse::YES);
+		TinyGL::ZBuffer *zb = TinyGL::ZB_open(kSize, kSize, buffer);
+		TinyGL::glInit(zb);
+		TinyGL::GLContext *c = TinyGL::gl_get_context();
+		Common::Array<unsigned int> textures;
+
+		_random.setSeed(3);
+		textures.push_back(createTexture(false, false));
+
+		// texels per pixel along each side, and the expected level
+		static const struct {
+			int scale;
+			int level;
+		} cases[] = {
+			{ 1, 0 }, { 2, 1 }, { 3, 2 }, { 4, 2 }, { 8, 3 }, { 16, 4 }, { 256, 8 }, { 1024, 8 }
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(cases); i++) {
+			TinyGL::ZBufferPoint p[3];
+			memset(p, 0, sizeof(p));
+			p[1].x = 16;
+			p[2].y = 16;
+			// s and t have 14 fractional bits
+			p[1].s = (16 * cases[i].scale) << 14;
+			p[2].t = (16 * cases[i].scale) << 14;
+
+			setFiltering(textures, TGL_NEAREST_MIPMAP_NEAREST, TGL_NEAREST);
+			TinyGL::gl_select_texture_level(c, &p[0], &p[1], &p[2]);
+			TS_ASSERT_EQUALS(zb->current_texture_level, cases[i].level);
+			TS_ASSERT_EQUALS(zb->current_texture.getRawBuffer(), c->current_texture->images[cases[i].level].pixmap.getRawBuffer());
+			TS_ASSERT(!zb->current_texture_bilinear);
+
+			// without mipmaps, only the filter changes
+			setFiltering(textures, TGL_LINEAR, TGL_NEAREST);
+			TinyGL::gl_select_texture_level(c, &p[0], &p[1], &p[2]);
+			TS_ASSERT_EQUALS(zb->current_texture_level, 0);
+			TS_ASSERT_EQUALS(zb->current_texture_bilinear, cases[i].scale > 1);
+		}
+
+		TinyGL::glClose();
+		TinyGL::ZB_close(zb);
+	}
+
+	void test_texture_mipmap_alpha_coverage() {
+		Graphics::PixelBuffer buffer(screenFormat(), kSize * kSize, DisposeAfterUse::YES);
+		TinyGL::ZBuffer *zb = TinyGL::ZB_open(kSize, kSize, buffer);
+		TinyGL::glInit(zb);
+		TinyGL::GLContext *c = TinyGL::gl_get_context();
+		Common::Array<byte> texels;
+		unsigned int texture;
+
+		// a white disc on transparent black, as the cutouts of the games
+		const float radius = kTextureSize * 0.35f, center = kTextureSize / 2.0f;
+		texels.resize(kTextureSize * kTextureSize * 4);
+		for (int v = 0; v < kTextureSize; v++) {
+			for (int u = 0; u < kTextureSize; u++) {
+				float du = u + 0.5f - center, dv = v + 0.5f - center;
+				memset(&texels[(v * kTextureSize + u) * 4], du * du + dv * dv < radius * radius ? 0xFF : 0, 4);
+			}
+		}
+
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST_MIPMAP_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, 3, kTextureSize, kTextureSize, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, &texels[0]);
+
+		// a huge minification builds the whole chain
+		TinyGL::ZBufferPoint p[3];
+		memset(p, 0, sizeof(p));
+		p[1].x = 1;
+		p[2].y = 1;
+		p[1].s = kTextureSize << 14;
+		p[2].t = kTextureSize << 14;
+		TinyGL::gl_select_texture_level(c, &p[0], &p[1], &p[2]);
+		TS_ASSERT_EQUALS(c->current_texture->levels, ZB_TEXTURE_SIZE_SHIFT + 1);
+
+		float coverage = (float)M_PI * 0.35f * 0.35f;
+		for (int level = 0; level <= ZB_TEXTURE_SIZE_SHIFT - 4; level++) {
+			const Graphics::PixelBuffer &pixmap = c->current_texture->images[level].pixmap;
+			int size = kTextureSize >> level, opaque = 0;
+
+			for (int i = 0; i < size * size; i++) {
+				uint8 a, r, g, b;
+				pixmap.getARGBAt(i, a, r, g, b);
+				if (a == 0xFF) {
+					opaque++;
+					// no dark fringe from the transparent texels
+					TS_ASSERT_EQUALS(r, 0xFF);
+					TS_ASSERT_EQUALS(g, 0xFF);
+					TS_ASSERT_EQUALS(b, 0xFF);
+				} else {
+					TS_ASSERT_EQUALS(a, 0);
+				}
+			}
+			// the disc neither shrinks nor grows down the chain
+			TS_ASSERT_DELTA((float)opaque / (size * size), coverage, 0.03f);
+		}
+
+		tglDeleteTextures(1, &texture);
+		TinyGL::glClose();
+		TinyGL::ZB_close(zb);
+	}
+};
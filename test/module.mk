@@ -1,16 +1,40 @@
 ######################################################################
 # Unit/regression tests, based on CxxTest.
-# Use the 'test' target to run them.
-# Edit TESTS and TESTLIBS to add more tests.
+# Use the 'test' target to run them, and the 'benchmark' target to
+# time the hot kernels on synthetic inputs.
+# Edit TESTS and TESTLIBS to add more tests, BENCHMARKS and BENCHMARK_LIBS
+# to add more benchmarks.
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h
+TEST_LIBS    := audio/libaudio.a graphics/libgraphics.a common/libcommon.a
+
+ifeq ($(ENABLE_GRIM), STATIC_PLUGIN)
+TESTS        += $(srcdir)/test/engines/grim/*.h
+TEST_LIBS    := engines/grim/libgrim.a $(TEST_LIBS)
+endif
+
+BENCHMARKS      := $(srcdir)/test/benchmark/common.h $(srcdir)/test/benchmark/audio.h \
+                   $(srcdir)/test/benchmark/graphics.h $(srcdir)/test/benchmark/video.h
+BENCHMARK_LIBS  := video/libvideo.a audio/libaudio.a graphics/libgraphics.a common/libcommon.a
+
+ifeq ($(ENABLE_GRIM), STATIC_PLUGIN)
+BENCHMARKS      += $(srcdir)/test/benchmark/grim.h
+BENCHMARK_LIBS  := engines/grim/libgrim.a $(BENCHMARK_LIBS)
+endif
+
+# Each run of the benchmark target overwrites this file with its results,
+# as "name,ops,ms,ns_per_op" lines
+BENCHMARK_OUTPUT ?= benchmark.csv
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
-TEST_CFLAGS  := -I$(srcdir)/test/cxxtest
+TEST_CFLAGS  := -I$(srcdir)/test/cxxtest -DFORBIDDEN_SYMBOL_EXCEPTION_time_h \
+                -DFORBIDDEN_SYMBOL_EXCEPTION_getenv -DFORBIDDEN_SYMBOL_EXCEPTION_FILE \
+                -DFORBIDDEN_SYMBOL_EXCEPTION_fopen -DFORBIDDEN_SYMBOL_EXCEPTION_fclose \
+                -DFORBIDDEN_SYMBOL_EXCEPTION_fprintf -DFORBIDDEN_SYMBOL_EXCEPTION_fputs \
+                -DFORBIDDEN_SYMBOL_EXCEPTION_stderr
 TEST_LDFLAGS := $(LIBS)
 TEST_CXXFLAGS := $(filter-out -Wglobal-constructors,$(CXXFLAGS))
 
@@ -34,9 +58,17 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+benchmark: test/benchmark/runner
+	@echo "name,ops,ms,ns_per_op" > $(BENCHMARK_OUTPUT)
+	BENCHMARK_OUTPUT=$(BENCHMARK_OUTPUT) ./test/benchmark/runner
+test/benchmark/runner: test/benchmark/runner.cpp $(BENCHMARK_LIBS)
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+test/benchmark/runner.cpp: $(BENCHMARKS)
+	@mkdir -p test/benchmark
+	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark/runner.cpp test/benchmark/runner
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
@@ -0,0 +1,43 @@
+#ifndef TEST_RANDOM_H
+#define TEST_RANDOM_H
+
+#include "common/scummsys.h"
+
+/*
+ * Deterministic random numbers for the synthetic inputs of the tests and
+ * benchmarks, so that they are the same on every run and every platform.
+ * Common::RandomSource cannot be used here, since it needs g_system.
+ */
+class TestRandom {
+public:
+	TestRandom(uint32 seed = 1) : _seed(seed) { }
+
+	void setSeed(uint32 seed) {
+		_seed = seed;
+	}
+
+	/** Advances the generator and returns its whole state. */
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed;
+	}
+
+	byte nextByte() {
+		return next() >> 16;
+	}
+
+	/** Returns a number in [0, limit). Only 15 bits are random. */
+	uint32 nextNumber(uint32 limit) {
+		return ((next() >> 16) & 0x7FFF) % limit;
+	}
+
+	/** Returns a number in [min, max]. */
+	float nextFloat(float min, float max) {
+		return min + (max - min) * ((next() >> 16) & 0x7FFF) / 32767.0f;
+	}
+
+private:
+	uint32 _seed;
+};
+
+#endif
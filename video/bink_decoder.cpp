@@ -31,7 +31,6 @@
 #include "common/textconsole.h"
 #include "common/math.h"
 #include "common/stream.h"
-#include "common/substream.h"
 #include "common/file.h"
 #include "common/str.h"
 #include "common/bitstream.h"
@@ -191,8 +190,7 @@ void BinkDecoder::readNextPacket() {
 				//                  Number of samples in bytes
 				audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
 
-				audio.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-						audioPacketStart + 4, audioPacketEnd), true);
+				audio.bits = readBitStream(audioPacketEnd - audioPacketStart - 4);
 
 				audioTrack->decodePacket();
 
@@ -209,8 +207,7 @@ void BinkDecoder::readNextPacket() {
 	uint32 videoPacketStart = _bink->pos();
 	uint32 videoPacketEnd   = _bink->pos() + frameSize;
 
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), true);
+	frame.bits = readBitStream(videoPacketEnd - videoPacketStart);
 
 	videoTrack->decodePacket(frame);
 
@@ -218,6 +215,18 @@ void BinkDecoder::readNextPacket() {
 	frame.bits = 0;
 }
 
+Common::BitStreamMemory32LELSB *BinkDecoder::readBitStream(uint32 size) {
+	byte *data = new byte[size];
+
+	uint32 read = _bink->read(data, size);
+	if (read != size) {
+		warning("Bink packet truncated");
+		memset(data + read, 0, size - read);
+	}
+
+	return new Common::BitStreamMemory32LELSB(data, size, true);
+}
+
 BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
 }
 
@@ -333,6 +342,9 @@ void BinkDecoder::setAudioTrack(uint32 track) {
 
 // ResidualVM-specific function
 bool BinkDecoder::seek(const Audio::Timestamp &time) {
+	// Keep the decode-ahead from running until the target frame is reached
+	Common::StackLock lock(_decodeAheadMutex);
+
 	VideoDecoder::seek(time);
 	uint32 frame = getCurFrame();
 
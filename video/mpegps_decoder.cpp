@@ -23,6 +23,7 @@
 #include "audio/audiostream.h"
 #include "audio/decoders/raw.h"
 #include "common/endian.h"
+#include "common/memstream.h"
 #include "common/stream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -43,8 +44,7 @@ namespace Video {
 #define PRIVATE_STREAM_2         0x1BF
 
 MPEGPSDecoder::MPEGPSDecoder() {
-	_stream = 0;
-	memset(_psmESType, 0, 256);
+	_videoStartCode = -1;
 }
 
 MPEGPSDecoder::~MPEGPSDecoder() {
@@ -54,38 +54,54 @@ MPEGPSDecoder::~MPEGPSDecoder() {
 bool MPEGPSDecoder::loadStream(Common::SeekableReadStream *stream) {
 	close();
 
-	_stream = stream;
+	_demuxer.loadStream(stream);
 
 	if (!addFirstVideoTrack()) {
 		close();
 		return false;
 	}
 
-	_stream->seek(0);
+	_demuxer.rewind();
+
+	// Create the tracks for the streams interleaved with the first video
+	// packets now, instead of when their first packet gets decoded.
+	_demuxer.queuePackets(_videoStartCode, kVideoPacketReadAhead);
+
+	Common::Array<int32> startCodes;
+	_demuxer.getQueuedStreams(startCodes);
+
+	for (uint i = 0; i < startCodes.size(); i++) {
+		MPEGPSDemuxer::Packet *packet = _demuxer.peekPacket(startCodes[i]);
+		Common::MemoryReadStream packetStream(packet->data, packet->size);
+		getStream(startCodes[i], &packetStream);
+	}
+
 	return true;
 }
 
 void MPEGPSDecoder::close() {
 	VideoDecoder::close();
 
-	delete _stream;
-	_stream = 0;
-
+	_demuxer.close();
 	_streamMap.clear();
-
-	memset(_psmESType, 0, 256);
+	_videoStartCode = -1;
 }
 
 void MPEGPSDecoder::readNextPacket() {
-	if (_stream->eos())
-		return;
-
 	for (;;) {
-		int32 startCode;
-		uint32 pts, dts;
-		int size = readNextPacketHeader(startCode, pts, dts);
+		// Keep the demuxer a few video packets ahead, so that the audio
+		// interleaved with them reaches its tracks before it is needed.
+		_demuxer.queuePackets(_videoStartCode, kVideoPacketReadAhead);
+		sendQueuedPackets();
+
+		MPEGPSDemuxer::Packet *packet = _demuxer.getPacket(_videoStartCode);
+
+		if (!packet) {
+			// The read-ahead stopped in a run of packets of the other
+			// streams, which were sent above. Read on.
+			if (!_demuxer.endOfStream())
+				continue;
 
-		if (size < 0) {
 			// End of stream
 			for (TrackListIterator it = getTrackListBegin(); it != getTrackListEnd(); it++)
 				if ((*it)->getTrackType() == Track::kTrackTypeVideo)
@@ -93,107 +109,357 @@ void MPEGPSDecoder::readNextPacket() {
 			return;
 		}
 
-		MPEGStream *stream = 0;
-		Common::SeekableReadStream *packet = _stream->readStream(size);
+		if (sendPacket(packet))
+			return;
+	}
+}
 
-		if (_streamMap.contains(startCode)) {
-			// We already found the stream
-			stream = _streamMap[startCode];
-		} else {
-			// We haven't seen this before
+MPEGPSDecoder::MPEGStream *MPEGPSDecoder::getStream(int32 startCode, Common::SeekableReadStream *packet) {
+	if (_streamMap.contains(startCode)) {
+		// We already found the stream
+		return _streamMap[startCode];
+	}
 
-			if (startCode == 0x1BD) {
-				// Private stream 1
-				PrivateStreamType streamType = detectPrivateStreamType(packet);
+	// We haven't seen this before
+	MPEGStream *stream = 0;
 
-				packet->seek(0);
+	if (startCode == 0x1BD) {
+		// Private stream 1
+		PrivateStreamType streamType = detectPrivateStreamType(packet);
 
-				switch (streamType) {
-				case kPrivateStreamPS2Audio: {
-					// PS2 Audio stream
-					PS2AudioTrack *audioTrack = new PS2AudioTrack(packet);
-					stream = audioTrack;
-					_streamMap[startCode] = audioTrack;
-					addTrack(audioTrack);
-					break;
-				}
-				default:
-					// Unknown (silently ignore)
-					break;
-				}
-			} if (startCode >= 0x1E0 && startCode <= 0x1EF) {
-				// Video stream
-				// TODO: Multiple video streams
-			} else if (startCode >= 0x1C0 && startCode <= 0x1DF) {
+		packet->seek(0);
+
+		switch (streamType) {
+		case kPrivateStreamPS2Audio: {
+			// PS2 Audio stream
+			PS2AudioTrack *audioTrack = new PS2AudioTrack(packet);
+			stream = audioTrack;
+			_streamMap[startCode] = audioTrack;
+			addTrack(audioTrack);
+			break;
+		}
+		default:
+			// Unknown (silently ignore)
+			break;
+		}
+	} else if (startCode >= 0x1E0 && startCode <= 0x1EF) {
+		// Video stream
+		// TODO: Multiple video streams
+	} else if (startCode >= 0x1C0 && startCode <= 0x1DF) {
 #ifdef USE_MAD
-				// MPEG Audio stream
-				MPEGAudioTrack *audioTrack = new MPEGAudioTrack(packet);
-				stream = audioTrack;
-				_streamMap[startCode] = audioTrack;
-				addTrack(audioTrack);
+		// MPEG Audio stream
+		MPEGAudioTrack *audioTrack = new MPEGAudioTrack(packet);
+		stream = audioTrack;
+		_streamMap[startCode] = audioTrack;
+		addTrack(audioTrack);
 #endif
-			}
+	}
+
+	return stream;
+}
+
+bool MPEGPSDecoder::sendPacket(MPEGPSDemuxer::Packet *packet) {
+	Common::MemoryReadStream packetStream(packet->data, packet->size);
+	MPEGStream *stream = getStream(packet->startCode, &packetStream);
+	bool done = false;
+
+	if (stream)
+		done = stream->sendPacket(&packetStream, packet->pts, packet->dts) && stream->getStreamType() == MPEGStream::kStreamTypeVideo;
+
+	_demuxer.releasePacket(packet);
+	return done;
+}
+
+void MPEGPSDecoder::sendQueuedPackets() {
+	Common::Array<int32> startCodes;
+	_demuxer.getQueuedStreams(startCodes);
+
+	for (uint i = 0; i < startCodes.size(); i++) {
+		if (startCodes[i] == _videoStartCode)
+			continue;
+
+		while (MPEGPSDemuxer::Packet *packet = _demuxer.getPacket(startCodes[i]))
+			sendPacket(packet);
+	}
+}
+
+bool MPEGPSDecoder::addFirstVideoTrack() {
+	for (;;) {
+		MPEGPSDemuxer::Packet *packet = _demuxer.readNextPacket();
+
+		// End of stream? We failed
+		if (!packet)
+			return false;
+
+		if (packet->startCode >= 0x1E0 && packet->startCode <= 0x1EF) {
+			// Video stream
+			// Can be MPEG-1/2 or MPEG-4/h.264. We'll assume the former and
+			// I hope we never need the latter.
+			Common::MemoryReadStream firstPacket(packet->data, packet->size);
+			MPEGVideoTrack *track = new MPEGVideoTrack(&firstPacket, getDefaultHighColorFormat());
+			addTrack(track);
+			_streamMap[packet->startCode] = track;
+			_videoStartCode = packet->startCode;
+			_demuxer.releasePacket(packet);
+			break;
 		}
 
-		if (stream) {
-			bool done = stream->sendPacket(packet, pts, dts);
+		_demuxer.releasePacket(packet);
+	}
+
+	return true;
+}
+
+MPEGPSDecoder::PrivateStreamType MPEGPSDecoder::detectPrivateStreamType(Common::SeekableReadStream *packet) {
+	packet->seek(4);
+
+	if (packet->readUint32BE() == MKTAG('S', 'S', 'h', 'd'))
+		return kPrivateStreamPS2Audio;
+
+	return kPrivateStreamUnknown;
+}
+
+MPEGPSDecoder::MPEGPSDemuxer::MPEGPSDemuxer() {
+	_stream = 0;
+	_endOfStream = true;
+	_queuedBytes = 0;
+	_buffer = new byte[kBufferSize];
+	_bufferPos = _bufferEnd = 0;
+	memset(_psmESType, 0, 256);
+}
+
+MPEGPSDecoder::MPEGPSDemuxer::~MPEGPSDemuxer() {
+	close();
+
+	for (uint i = 0; i < _packetPool.size(); i++) {
+		delete[] _packetPool[i]->data;
+		delete _packetPool[i];
+	}
+
+	delete[] _buffer;
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::loadStream(Common::SeekableReadStream *stream) {
+	close();
+
+	_stream = stream;
+	_endOfStream = false;
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::close() {
+	flushQueues();
+
+	delete _stream;
+	_stream = 0;
+	_endOfStream = true;
+	_bufferPos = _bufferEnd = 0;
+
+	memset(_psmESType, 0, 256);
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::rewind() {
+	flushQueues();
 
-			if (done && stream->getStreamType() == MPEGStream::kStreamTypeVideo)
-				return;
-		} else {
-			delete packet;
+	_stream->seek(0);
+	_endOfStream = false;
+	_bufferPos = _bufferEnd = 0;
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::flushQueues() {
+	for (PacketQueueMap::iterator it = _packetQueues.begin(); it != _packetQueues.end(); it++)
+		while (!it->_value.empty())
+			releasePacket(it->_value.pop());
+
+	_packetQueues.clear();
+	_queuedBytes = 0;
+}
+
+MPEGPSDecoder::MPEGPSDemuxer::Packet *MPEGPSDecoder::MPEGPSDemuxer::readNextPacket() {
+	if (_endOfStream)
+		return 0;
+
+	int32 startCode;
+	uint32 pts, dts;
+	int size = readNextPacketHeader(startCode, pts, dts);
+
+	if (size < 0) {
+		_endOfStream = true;
+		return 0;
+	}
+
+	Packet *packet = allocatePacket(size);
+	packet->startCode = startCode;
+	packet->pts = pts;
+	packet->dts = dts;
+	memcpy(packet->data, _buffer + _bufferPos, size);
+	_bufferPos += size;
+
+	return packet;
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::queuePackets(int32 startCode, int count) {
+	while (!_endOfStream && _queuedBytes < kMaxQueuedBytes &&
+	       (!_packetQueues.contains(startCode) || _packetQueues[startCode].size() < count)) {
+		Packet *packet = readNextPacket();
+
+		if (packet) {
+			_packetQueues[packet->startCode].push(packet);
+			_queuedBytes += packet->size;
 		}
 	}
 }
 
-#define MAX_SYNC_SIZE 100000
+MPEGPSDecoder::MPEGPSDemuxer::Packet *MPEGPSDecoder::MPEGPSDemuxer::getPacket(int32 startCode) {
+	PacketQueueMap::iterator it = _packetQueues.find(startCode);
 
-int MPEGPSDecoder::findNextStartCode(uint32 &size) {
-	size = MAX_SYNC_SIZE;
-	int32 state = 0xFF;
+	if (it == _packetQueues.end() || it->_value.empty())
+		return 0;
 
-	while (size > 0) {
-		byte v = _stream->readByte();
+	_queuedBytes -= it->_value.front()->size;
+	return it->_value.pop();
+}
 
-		if (_stream->eos())
-			return -1;
+MPEGPSDecoder::MPEGPSDemuxer::Packet *MPEGPSDecoder::MPEGPSDemuxer::peekPacket(int32 startCode) {
+	PacketQueueMap::iterator it = _packetQueues.find(startCode);
+
+	if (it == _packetQueues.end() || it->_value.empty())
+		return 0;
+
+	return it->_value.front();
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::getQueuedStreams(Common::Array<int32> &startCodes) const {
+	startCodes.clear();
+
+	for (PacketQueueMap::const_iterator it = _packetQueues.begin(); it != _packetQueues.end(); it++)
+		if (!it->_value.empty())
+			startCodes.push_back(it->_key);
+}
+
+MPEGPSDecoder::MPEGPSDemuxer::Packet *MPEGPSDecoder::MPEGPSDemuxer::allocatePacket(uint32 size) {
+	Packet *packet;
+
+	if (_packetPool.empty()) {
+		packet = new Packet();
+		packet->capacity = 0;
+		packet->data = 0;
+	} else {
+		packet = _packetPool.back();
+		_packetPool.pop_back();
+	}
+
+	if (packet->capacity < size) {
+		delete[] packet->data;
+		packet->capacity = MAX<uint32>(size, kMinPacketCapacity);
+		packet->data = new byte[packet->capacity];
+	}
+
+	packet->size = size;
+	return packet;
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::releasePacket(Packet *packet) {
+	_packetPool.push_back(packet);
+}
+
+bool MPEGPSDecoder::MPEGPSDemuxer::fillBuffer(uint32 size) {
+	if (bytesLeft() >= size)
+		return true;
+
+	// Move what is left to the front and read as much as fits behind it
+	if (_bufferPos > 0) {
+		memmove(_buffer, _buffer + _bufferPos, bytesLeft());
+		_bufferEnd -= _bufferPos;
+		_bufferPos = 0;
+	}
 
-		size--;
+	while (_bufferEnd < kBufferSize && !_stream->eos()) {
+		uint32 bytesRead = _stream->read(_buffer + _bufferEnd, kBufferSize - _bufferEnd);
 
-		if (state == 0x1)
-			return ((state << 8) | v) & 0xFFFFFF;
+		if (bytesRead == 0)
+			break;
 
-		state = ((state << 8) | v) & 0xFFFFFF;
+		_bufferEnd += bytesRead;
 	}
 
-	return -1;
+	return bytesLeft() >= size;
+}
+
+byte MPEGPSDecoder::MPEGPSDemuxer::readByte() {
+	if (_bufferPos >= _bufferEnd)
+		return 0;
+
+	return _buffer[_bufferPos++];
+}
+
+uint16 MPEGPSDecoder::MPEGPSDemuxer::readUint16BE() {
+	uint16 value = readByte() << 8;
+	return value | readByte();
+}
+
+void MPEGPSDecoder::MPEGPSDemuxer::skip(uint32 size) {
+	_bufferPos = MIN(_bufferPos + size, _bufferEnd);
 }
 
-int MPEGPSDecoder::readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &dts) {
+int32 MPEGPSDecoder::MPEGPSDemuxer::findNextStartCode() {
 	for (;;) {
-		uint32 size;
-		startCode = findNextStartCode(size);
+		if (!fillBuffer(4))
+			return -1;
+
+		// Look for the 0x01 of a 0x000001 prefix with memchr and check
+		// the two bytes in front of it
+		const byte *start = _buffer + _bufferPos;
+		const byte *end = _buffer + _bufferEnd - 1;
+		const byte *ptr = start + 2;
+
+		while (ptr < end && (ptr = (const byte *)memchr(ptr, 1, end - ptr)) != 0) {
+			if (ptr[-1] == 0 && ptr[-2] == 0) {
+				_bufferPos = ptr + 2 - _buffer;
+				return 0x100 | ptr[1];
+			}
+
+			ptr++;
+		}
+
+		// Keep the last bytes, they may start a prefix completed by the
+		// next block
+		_bufferPos = _bufferEnd - 3;
 
 		if (_stream->eos())
 			return -1;
+	}
+}
 
-		if (startCode < 0)
-			continue;
+int MPEGPSDecoder::MPEGPSDemuxer::readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &dts) {
+	for (;;) {
+		startCode = findNextStartCode();
 
-		uint32 lastSync = _stream->pos();
+		if (startCode < 0)
+			return -1;
 
 		if (startCode == PACK_START_CODE || startCode == SYSTEM_HEADER_START_CODE)
 			continue;
 
-		int length = _stream->readUint16BE();
+		if (!fillBuffer(2))
+			return -1;
+
+		int length = readUint16BE();
+
+		// Make sure the whole packet is in the buffer; from here on
+		// everything is parsed in memory.
+		fillBuffer(length);
+		length = MIN<int>(length, bytesLeft());
+
+		uint32 lastSync = _bufferPos;
 
 		if (startCode == PADDING_STREAM || startCode == PRIVATE_STREAM_2) {
-			_stream->skip(length);
+			skip(length);
 			continue;
 		}
 
 		if (startCode == PROGRAM_STREAM_MAP) {
 			parseProgramStreamMap(length);
+			_bufferPos = lastSync + length;
 			continue;
 		}
 
@@ -204,14 +470,9 @@ int MPEGPSDecoder::readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &d
 			continue;
 
 		// Stuffing
-		byte c;
-		for (;;) {
-			if (length < 1) {
-				_stream->seek(lastSync);
-				continue;
-			}
-
-			c = _stream->readByte();
+		byte c = 0xFF;
+		while (length >= 1) {
+			c = readByte();
 			length--;
 
 			// XXX: for mpeg1, should test only bit 7
@@ -219,10 +480,15 @@ int MPEGPSDecoder::readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &d
 				break;
 		}
 
+		if (c == 0xFF) {
+			_bufferPos = lastSync;
+			continue;
+		}
+
 		if ((c & 0xC0) == 0x40) {
 			// Buffer scale and size
-			_stream->readByte();
-			c = _stream->readByte();
+			readByte();
+			c = readByte();
 			length -= 2;
 		}
 
@@ -239,12 +505,12 @@ int MPEGPSDecoder::readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &d
 			}
 		} else if ((c & 0xC0) == 0x80) {
 			// MPEG-2 PES
-			byte flags = _stream->readByte();
-			int headerLength = _stream->readByte();
+			byte flags = readByte();
+			int headerLength = readByte();
 			length -= 2;
 
 			if (headerLength > length) {
-				_stream->seek(lastSync);
+				_bufferPos = lastSync;
 				continue;
 			}
 
@@ -266,27 +532,27 @@ int MPEGPSDecoder::readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &d
 			}
 
 			if (flags & 0x01) { // PES extension
-				byte pesExt =_stream->readByte();
+				byte pesExt = readByte();
 				headerLength--;
 
 				// Skip PES private data, program packet sequence
-				int skip = (pesExt >> 4) & 0xB;
-				skip += skip & 0x9;
+				int skipSize = (pesExt >> 4) & 0xB;
+				skipSize += skipSize & 0x9;
 
-				if (pesExt & 0x40 || skip > headerLength) {
+				if (pesExt & 0x40 || skipSize > headerLength) {
 					warning("pesExt %x is invalid", pesExt);
-					pesExt = skip = 0;
+					pesExt = skipSize = 0;
 				} else {
-					_stream->skip(skip);
-					headerLength -= skip;
+					skip(skipSize);
+					headerLength -= skipSize;
 				}
 
 				if (pesExt & 0x01) { // PES extension 2
-					byte ext2Length = _stream->readByte();
+					byte ext2Length = readByte();
 					headerLength--;
 
 					if ((ext2Length & 0x7F) != 0) {
-						byte idExt = _stream->readByte();
+						byte idExt = readByte();
 
 						if ((idExt & 0x80) == 0)
 							startCode = (startCode & 0xFF) << 8;
@@ -297,94 +563,59 @@ int MPEGPSDecoder::readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &d
 			}
 
 			if (headerLength < 0) {
-				_stream->seek(lastSync);
+				_bufferPos = lastSync;
 				continue;
 			}
 
-			_stream->skip(headerLength);
+			skip(headerLength);
 		} else if (c != 0xF) {
 			continue;
 		}
 
 		if (length < 0) {
-			_stream->seek(lastSync);
+			_bufferPos = lastSync;
 			continue;
 		}
 
-		return length;
+		return MIN<int>(length, bytesLeft());
 	}
 }
 
-uint32 MPEGPSDecoder::readPTS(int c) {
+uint32 MPEGPSDecoder::MPEGPSDemuxer::readPTS(int c) {
 	byte buf[5];
 
-	buf[0] = (c < 0) ? _stream->readByte() : c;
-	_stream->read(buf + 1, 4);
+	buf[0] = (c < 0) ? readByte() : c;
+
+	for (int i = 1; i < 5; i++)
+		buf[i] = readByte();
 
 	return ((buf[0] & 0x0E) << 29) | ((READ_BE_UINT16(buf + 1) >> 1) << 15) | (READ_BE_UINT16(buf + 3) >> 1);
 }
 
-void MPEGPSDecoder::parseProgramStreamMap(int length) {
-	_stream->readByte();
-	_stream->readByte();
+void MPEGPSDecoder::MPEGPSDemuxer::parseProgramStreamMap(int length) {
+	readByte();
+	readByte();
 
 	// skip program stream info
-	_stream->skip(_stream->readUint16BE());
+	skip(readUint16BE());
 
-	int esMapLength = _stream->readUint16BE();
+	int esMapLength = readUint16BE();
 
-	while (esMapLength >= 4) {
-		byte type = _stream->readByte();
-		byte esID = _stream->readByte();
-		uint16 esInfoLength = _stream->readUint16BE();
+	while (esMapLength >= 4 && bytesLeft() >= 4) {
+		byte type = readByte();
+		byte esID = readByte();
+		uint16 esInfoLength = readUint16BE();
 
 		// Remember mapping from stream id to stream type
 		_psmESType[esID] = type;
 
 		// Skip program stream info
-        _stream->skip(esInfoLength);
+		skip(esInfoLength);
 
 		esMapLength -= 4 + esInfoLength;
 	}
 
-	_stream->readUint32BE(); // CRC32
-}
-
-bool MPEGPSDecoder::addFirstVideoTrack() {
-	for (;;) {
-		int32 startCode;
-		uint32 pts, dts;
-		int size = readNextPacketHeader(startCode, pts, dts);
-
-		// End of stream? We failed
-		if (size < 0)
-			return false;
-
-		if (startCode >= 0x1E0 && startCode <= 0x1EF) {
-			// Video stream
-			// Can be MPEG-1/2 or MPEG-4/h.264. We'll assume the former and
-			// I hope we never need the latter.
-			Common::SeekableReadStream *firstPacket = _stream->readStream(size);
-			MPEGVideoTrack *track = new MPEGVideoTrack(firstPacket, getDefaultHighColorFormat());
-			addTrack(track);
-			_streamMap[startCode] = track;
-			delete firstPacket;
-			break;
-		}
-
-		_stream->skip(size);
-	}
-
-	return true;
-}
-
-MPEGPSDecoder::PrivateStreamType MPEGPSDecoder::detectPrivateStreamType(Common::SeekableReadStream *packet) {
-	packet->seek(4);
-
-	if (packet->readUint32BE() == MKTAG('S', 'S', 'h', 'd'))
-		return kPrivateStreamPS2Audio;
-
-	return kPrivateStreamUnknown;
+	// CRC32 follows
 }
 
 MPEGPSDecoder::MPEGVideoTrack::MPEGVideoTrack(Common::SeekableReadStream *firstPacket, const Graphics::PixelFormat &format) {
@@ -464,8 +695,6 @@ bool MPEGPSDecoder::MPEGVideoTrack::sendPacket(Common::SeekableReadStream *packe
 	} while (size != 0);
 #endif
 
-	delete packet;
-
 #ifdef USE_MPEG2
 	return foundFrame;
 #else
@@ -545,7 +774,6 @@ bool MPEGPSDecoder::MPEGAudioTrack::sendPacket(Common::SeekableReadStream *packe
 		decodeMP3Data(packet);
 
 	_state = MP3_STATE_READY;
-	delete packet;
 	return true;
 }
 
@@ -800,7 +1028,6 @@ bool MPEGPSDecoder::PS2AudioTrack::sendPacket(Common::SeekableReadStream *packet
 
 	_audStream->queueBuffer((byte *)buffer, sampleCount * 2, DisposeAfterUse::YES, flags);
 
-	delete packet;
 	return true;
 }
 
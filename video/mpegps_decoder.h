@@ -23,7 +23,9 @@
 #ifndef VIDEO_MPEG_DECODER_H
 #define VIDEO_MPEG_DECODER_H
 
+#include "common/array.h"
 #include "common/hashmap.h"
+#include "common/queue.h"
 #include "common/rational.h"
 #include "common/rect.h"
 #include "common/str.h"
@@ -93,6 +95,96 @@ protected:
 	bool useAudioSync() const { return false; }
 
 private:
+	/**
+	 * Splits the program stream into packets. The stream is read in large
+	 * blocks and the packets are copied into pooled buffers, which are
+	 * queued per elementary stream until the decoder asks for them.
+	 */
+	class MPEGPSDemuxer {
+	public:
+		MPEGPSDemuxer();
+		~MPEGPSDemuxer();
+
+		struct Packet {
+			int32 startCode;
+			uint32 pts, dts;
+			uint32 size;
+			uint32 capacity;
+			byte *data;
+		};
+
+		void loadStream(Common::SeekableReadStream *stream);
+		void close();
+
+		/** Seek back to the start of the stream and drop all queued packets. */
+		void rewind();
+
+		/** Demux the next packet without queuing it, or return 0 at the end of the stream. */
+		Packet *readNextPacket();
+
+		/**
+		 * Demux packets until the given stream has count packets queued or
+		 * the end of the stream is reached. Packets of other streams are
+		 * queued along the way. It also stops once the queued packets hold
+		 * kMaxQueuedBytes, so that a long run without packets of the given
+		 * stream is not read in at once.
+		 */
+		void queuePackets(int32 startCode, int count);
+
+		/** Return whether all the packets of the stream were demuxed. */
+		bool endOfStream() const { return _endOfStream; }
+
+		/** Remove the next queued packet of the given stream, or return 0. */
+		Packet *getPacket(int32 startCode);
+
+		/** Return the next queued packet of the given stream without removing it. */
+		Packet *peekPacket(int32 startCode);
+
+		/** Fill the array with the start codes of all streams with queued packets. */
+		void getQueuedStreams(Common::Array<int32> &startCodes) const;
+
+		/** Give a packet back to the pool. */
+		void releasePacket(Packet *packet);
+
+	private:
+		enum {
+			// Largest packet the 16 bit length field allows, plus that field
+			kMaxPacketSize = 0xFFFF + 2,
+			kReadBlockSize = 64 * 1024,
+			kBufferSize = kMaxPacketSize + kReadBlockSize,
+			kMinPacketCapacity = 4096,
+			kMaxQueuedBytes = 1024 * 1024
+		};
+
+		Common::SeekableReadStream *_stream;
+		bool _endOfStream;
+
+		byte *_buffer;
+		uint32 _bufferPos, _bufferEnd;
+
+		typedef Common::Queue<Packet *> PacketQueue;
+		typedef Common::HashMap<int32, PacketQueue> PacketQueueMap;
+		PacketQueueMap _packetQueues;
+		uint32 _queuedBytes;
+		Common::Array<Packet *> _packetPool;
+
+		byte _psmESType[256];
+
+		bool fillBuffer(uint32 size);
+		uint32 bytesLeft() const { return _bufferEnd - _bufferPos; }
+		byte readByte();
+		uint16 readUint16BE();
+		void skip(uint32 size);
+
+		int32 findNextStartCode();
+		int readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &dts);
+		uint32 readPTS(int c);
+		void parseProgramStreamMap(int length);
+
+		Packet *allocatePacket(uint32 size);
+		void flushQueues();
+	};
+
 	class MPEGStream {
 	public:
 		virtual ~MPEGStream() {}
@@ -221,21 +313,23 @@ private:
 		kPrivateStreamPS2Audio
 	};
 
-	bool addFirstVideoTrack();
-
-	int readNextPacketHeader(int32 &startCode, uint32 &pts, uint32 &dts);
-	int findNextStartCode(uint32 &size);
-	uint32 readPTS(int c);
+	enum {
+		// Number of video packets demuxed ahead of the one being decoded
+		kVideoPacketReadAhead = 8
+	};
 
-	void parseProgramStreamMap(int length);
-	byte _psmESType[256];
+	bool addFirstVideoTrack();
+	MPEGStream *getStream(int32 startCode, Common::SeekableReadStream *packet);
+	bool sendPacket(MPEGPSDemuxer::Packet *packet);
+	void sendQueuedPackets();
 
 	PrivateStreamType detectPrivateStreamType(Common::SeekableReadStream *packet);
 
 	typedef Common::HashMap<int, MPEGStream *> StreamMap;
 	StreamMap _streamMap;
 
-	Common::SeekableReadStream *_stream;
+	MPEGPSDemuxer _demuxer;
+	int32 _videoStartCode;
 };
 
 } // End of namespace Video
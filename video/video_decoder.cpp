@@ -27,12 +27,93 @@
 
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/profiler.h"
+#include "common/singleton.h"
 #include "common/system.h"
+#include "common/timer.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+/**
+ * Runs the decode-ahead of all VideoDecoders which enabled it and are
+ * playing from a single timer callback. The timer is only installed
+ * while there is such a decoder.
+ */
+class DecodeAheadManager : public Common::Singleton<DecodeAheadManager> {
+public:
+	void addDecoder(VideoDecoder *decoder);
+	void removeDecoder(VideoDecoder *decoder);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DecodeAheadManager() : _timerInstalled(false) {}
+
+	static void timerCallback(void *refCon);
+
+	// Guards _timerInstalled, and orders the installing and removing of the
+	// timer. It is never taken by the timer callback, unlike _mutex.
+	Common::Mutex _timerMutex;
+	Common::Mutex _mutex;
+	Common::Array<VideoDecoder *> _decoders;
+	bool _timerInstalled;
+};
+
+void DecodeAheadManager::addDecoder(VideoDecoder *decoder) {
+	Common::StackLock timerLock(_timerMutex);
+
+	{
+		Common::StackLock lock(_mutex);
+
+		for (uint i = 0; i < _decoders.size(); i++)
+			if (_decoders[i] == decoder)
+				return;
+
+		_decoders.push_back(decoder);
+	}
+
+	if (!_timerInstalled) {
+		g_system->getTimerManager()->installIsolatedTimerProc(&timerCallback, 10000, this, "videoDecodeAhead");
+		_timerInstalled = true;
+	}
+}
+
+void DecodeAheadManager::removeDecoder(VideoDecoder *decoder) {
+	Common::StackLock timerLock(_timerMutex);
+	bool empty;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		for (uint i = 0; i < _decoders.size(); i++) {
+			if (_decoders[i] == decoder) {
+				_decoders.remove_at(i);
+				break;
+			}
+		}
+
+		empty = _decoders.empty();
+	}
+
+	// Removing the timer waits for a running callback to finish, so this
+	// must not be done while holding _mutex.
+	if (empty && _timerInstalled) {
+		g_system->getTimerManager()->removeTimerProc(&timerCallback);
+		_timerInstalled = false;
+	}
+}
+
+void DecodeAheadManager::timerCallback(void *refCon) {
+	PROFILE_SCOPE("videoDecodeAhead");
+	DecodeAheadManager *manager = (DecodeAheadManager *)refCon;
+	Common::StackLock lock(manager->_mutex);
+
+	for (uint i = 0; i < manager->_decoders.size(); i++)
+		manager->_decoders[i]->fillDecodeAheadQueue();
+}
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -46,6 +127,8 @@ VideoDecoder::VideoDecoder() {
 	_endTime = 0;
 	_endTimeSet = false;
 	_nextVideoTrack = 0;
+	_decodeAheadCount = 0;
+	_shownFrame = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -54,10 +137,25 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	if (_decodeAheadCount != 0)
+		DecodeAheadManager::instance().removeDecoder(this);
+
+	freeFramePool();
+}
+
 void VideoDecoder::close() {
+	// Unregister first, so the timer can not run concurrently anymore
+	if (_decodeAheadCount != 0)
+		DecodeAheadManager::instance().removeDecoder(this);
+
+	Common::StackLock lock(_decodeAheadMutex);
+
 	if (isPlaying())
 		stop();
 
+	freeFramePool();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -166,8 +264,25 @@ Graphics::PixelFormat VideoDecoder::getPixelFormat() const {
 }
 
 const Graphics::Surface *VideoDecoder::decodeNextFrame() {
+	Common::StackLock lock(_decodeAheadMutex);
 	_needsUpdate = false;
 
+	// The previously shown frame is not needed anymore
+	if (_shownFrame) {
+		_framePool.push_back(_shownFrame);
+		_shownFrame = 0;
+	}
+
+	// Hand out a frame decoded ahead of time, if there is one
+	if (!_decodedFrames.empty()) {
+		_shownFrame = _decodedFrames.pop().surface;
+		return _shownFrame;
+	}
+
+	return decodeFrameIntern();
+}
+
+const Graphics::Surface *VideoDecoder::decodeFrameIntern() {
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -193,6 +308,12 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	Common::StackLock lock(_decodeAheadMutex);
+
+	// Frames decoded ahead are only valid for the current direction
+	if (reverse)
+		flushDecodeAheadQueue();
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -212,7 +333,137 @@ const byte *VideoDecoder::getPalette() {
 	return _palette;
 }
 
+void VideoDecoder::setDecodeAhead(uint frameCount) {
+	if (frameCount == _decodeAheadCount)
+		return;
+
+	if (frameCount == 0) {
+		// Unregister first, so the timer can not run concurrently anymore
+		DecodeAheadManager::instance().removeDecoder(this);
+
+		Common::StackLock lock(_decodeAheadMutex);
+		_decodeAheadCount = 0;
+		flushDecodeAheadQueue();
+		return;
+	}
+
+	{
+		Common::StackLock lock(_decodeAheadMutex);
+		_decodeAheadCount = frameCount;
+
+		while (_decodedFrames.size() > (int)_decodeAheadCount)
+			_framePool.push_back(_decodedFrames.pop().surface);
+	}
+
+	// Otherwise, this is done when the playback starts
+	if (isPlaying())
+		DecodeAheadManager::instance().addDecoder(this);
+}
+
+Graphics::Surface *VideoDecoder::holdFrame(const Graphics::Surface *frame) {
+	Common::StackLock lock(_decodeAheadMutex);
+
+	if (!frame || frame != _shownFrame)
+		return 0;
+
+	Graphics::Surface *surface = _shownFrame;
+	_shownFrame = 0;
+	return surface;
+}
+
+void VideoDecoder::releaseFrame(Graphics::Surface *frame) {
+	Common::StackLock lock(_decodeAheadMutex);
+	_framePool.push_back(frame);
+}
+
+bool VideoDecoder::decodeAheadFrame() {
+	if (!_nextVideoTrack || _nextVideoTrack->isReversed() || _nextVideoTrack->endOfTrack())
+		return false;
+
+	// Palettes are applied when a frame is decoded, so they can't be queued
+	if (_nextVideoTrack->getPixelFormat().bytesPerPixel == 1)
+		return false;
+
+	uint32 startTime = _nextVideoTrack->getNextFrameStartTime();
+
+	if (_endTimeSet && startTime >= (uint)_endTime.msecs())
+		return false;
+
+	const Graphics::Surface *frame = decodeFrameIntern();
+	if (!frame)
+		return false;
+
+	Graphics::Surface *surface;
+	if (_framePool.empty()) {
+		surface = new Graphics::Surface();
+	} else {
+		surface = _framePool.back();
+		_framePool.pop_back();
+	}
+
+	// Only reallocate the pooled surface when the frame layout changed
+	if (surface->w != frame->w || surface->h != frame->h || surface->format != frame->format) {
+		surface->free();
+		surface->create(frame->w, frame->h, frame->format);
+	}
+
+	if (surface->pitch == frame->pitch) {
+		memcpy(surface->pixels, frame->pixels, frame->h * frame->pitch);
+	} else {
+		for (int y = 0; y < frame->h; y++)
+			memcpy(surface->getBasePtr(0, y), frame->getBasePtr(0, y), frame->w * frame->format.bytesPerPixel);
+	}
+
+	DecodedFrame decodedFrame;
+	decodedFrame.surface = surface;
+	decodedFrame.frame = getTrackCurFrame();
+	decodedFrame.startTime = startTime;
+	_decodedFrames.push(decodedFrame);
+	return true;
+}
+
+void VideoDecoder::fillDecodeAheadQueue() {
+	Common::StackLock lock(_decodeAheadMutex);
+
+	if (!isVideoLoaded() || !isPlaying())
+		return;
+
+	while (_decodedFrames.size() < (int)_decodeAheadCount && decodeAheadFrame())
+		;
+}
+
+void VideoDecoder::flushDecodeAheadQueue() {
+	while (!_decodedFrames.empty())
+		_framePool.push_back(_decodedFrames.pop().surface);
+}
+
+void VideoDecoder::freeFramePool() {
+	flushDecodeAheadQueue();
+
+	if (_shownFrame) {
+		_framePool.push_back(_shownFrame);
+		_shownFrame = 0;
+	}
+
+	for (uint i = 0; i < _framePool.size(); i++) {
+		_framePool[i]->free();
+		delete _framePool[i];
+	}
+
+	_framePool.clear();
+}
+
 int VideoDecoder::getCurFrame() const {
+	Common::StackLock lock(_decodeAheadMutex);
+
+	// The tracks are ahead of what has been handed out
+	if (!_decodedFrames.empty())
+		return _decodedFrames.front().frame - 1;
+
+	return getTrackCurFrame();
+}
+
+int VideoDecoder::getTrackCurFrame() const {
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -254,10 +505,26 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	Common::StackLock lock(_decodeAheadMutex);
+
+	if (endOfVideo() || _needsUpdate)
 		return 0;
 
 	uint32 currentTime = getTime();
+
+	// Frames decoded ahead are always played forward
+	if (!_decodedFrames.empty()) {
+		uint32 nextFrameStartTime = _decodedFrames.front().startTime;
+
+		if (nextFrameStartTime <= currentTime)
+			return 0;
+
+		return nextFrameStartTime - currentTime;
+	}
+
+	if (!_nextVideoTrack)
+		return 0;
+
 	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
 
 	if (_nextVideoTrack->isReversed()) {
@@ -276,6 +543,11 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
+	Common::StackLock lock(_decodeAheadMutex);
+
+	if (!_decodedFrames.empty())
+		return false;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if (!(*it)->endOfTrack() && (!isPlaying() || (*it)->getTrackType() != Track::kTrackTypeVideo || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
 			return false;
@@ -298,6 +570,9 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	Common::StackLock lock(_decodeAheadMutex);
+	flushDecodeAheadQueue();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -332,6 +607,9 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	Common::StackLock lock(_decodeAheadMutex);
+	flushDecodeAheadQueue();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -452,6 +730,9 @@ void VideoDecoder::setRate(const Common::Rational &rate) {
 		_startTime -= (_lastTimeChange.msecs() / _playbackRate).toInt();
 
 	startAudio();
+
+	if (_decodeAheadCount != 0)
+		DecodeAheadManager::instance().addDecoder(this);
 }
 
 bool VideoDecoder::isPlaying() const {
@@ -773,6 +1054,11 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is similar to endOfVideo(), except it doesn't take Audio into account (and returns true if not the end of the video)
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
+	Common::StackLock lock(_decodeAheadMutex);
+
+	if (!_decodedFrames.empty())
+		return true;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack() && (!isPlaying() || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
 			return true;
@@ -789,3 +1075,7 @@ bool VideoDecoder::hasAudio() const {
 }
 
 } // End of namespace Video
+
+namespace Common {
+DECLARE_SINGLETON(Video::DecodeAheadManager);
+}
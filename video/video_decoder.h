@@ -26,6 +26,8 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/mutex.h"
+#include "common/queue.h"
 #include "common/rational.h"
 #include "common/str.h"
 #include "graphics/pixelformat.h"
@@ -46,13 +48,15 @@ struct Surface;
 
 namespace Video {
 
+class DecodeAheadManager;
+
 /**
  * Generic interface for video decoder classes.
  */
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -365,6 +369,51 @@ public:
 	 */
 	bool setReverse(bool reverse);
 
+	/**
+	 * Set the number of frames to decode ahead of time.
+	 *
+	 * When non-zero, frames are decoded in the background from a timer
+	 * callback into a bounded queue of surfaces taken from a pool, and
+	 * decodeNextFrame() hands out the frames which are already decoded.
+	 * If the queue ran dry, the next frame is decoded synchronously.
+	 * Seeking and rewinding flush the queue.
+	 *
+	 * The setting is kept across close() and loadStream(). The background
+	 * decoding only runs from the start of the playback until close(). By
+	 * default, decoding ahead is disabled.
+	 *
+	 * @note Only forward playback of true color videos is decoded ahead,
+	 *       other videos are always decoded synchronously.
+	 * @param frameCount the maximum number of queued frames, or 0 to disable
+	 */
+	void setDecodeAhead(uint frameCount);
+
+	/**
+	 * Get the maximum number of frames decoded ahead of time.
+	 */
+	uint getDecodeAhead() const { return _decodeAheadCount; }
+
+	/**
+	 * Take over the frame last returned by decodeNextFrame(), if it was
+	 * decoded ahead of time.
+	 *
+	 * The surface is then not reused for another frame until it is given
+	 * back with releaseFrame(), so it can be kept around without copying
+	 * it. The frames decoded synchronously are owned by their track and
+	 * can not be taken over.
+	 *
+	 * @param frame the frame returned by decodeNextFrame()
+	 * @return the surface of the frame, or 0 if it can not be taken over
+	 * @note All the frames taken over must be released before the
+	 *       VideoDecoder is destroyed.
+	 */
+	Graphics::Surface *holdFrame(const Graphics::Surface *frame);
+
+	/**
+	 * Give back a frame taken over with holdFrame().
+	 */
+	void releaseFrame(Graphics::Surface *frame);
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -820,7 +869,38 @@ protected:
 	 */
 	TrackListIterator getTrackListEnd() { return _tracks.end(); }
 
+	/**
+	 * Mutex held while frames are decoded ahead of time.
+	 *
+	 * Subclasses which drive their tracks directly outside of the
+	 * functions of this class, e.g. in seek(), must hold it while doing so.
+	 */
+	Common::Mutex _decodeAheadMutex;
+
 private:
+	friend class DecodeAheadManager;
+
+	/**
+	 * A frame decoded ahead of time, waiting to be handed out.
+	 */
+	struct DecodedFrame {
+		Graphics::Surface *surface;
+		int frame;
+		uint32 startTime;
+	};
+
+	// Decode-ahead settings and state
+	uint _decodeAheadCount;
+	Common::Queue<DecodedFrame> _decodedFrames;
+	Common::Array<Graphics::Surface *> _framePool;
+	Graphics::Surface *_shownFrame;
+
+	const Graphics::Surface *decodeFrameIntern();
+	bool decodeAheadFrame();
+	void fillDecodeAheadQueue();
+	void flushDecodeAheadQueue();
+	void freeFramePool();
+
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
 
@@ -839,6 +919,7 @@ private:
 	Graphics::PixelFormat _defaultHighColorFormat;
 
 	// Internal helper functions
+	int getTrackCurFrame() const;
 	void stopAudio();
 	void startAudio();
 	void startAudioLimit(const Audio::Timestamp &limit);